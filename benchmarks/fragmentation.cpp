@@ -0,0 +1,266 @@
+/**
+ * @file fragmentation.cpp
+ * @brief Heap footprint of the Block free index policies on replayed traces
+ *
+ * Replays allocation traces against one large Block per free index policy and
+ * reports how far into the block the heap had to reach (the footprint) compared
+ * to the peak number of live bytes. A policy that reuses low addresses keeps the
+ * footprint close to the live peak; the rest of the block is never touched.
+ *
+ * Built only with -DBUILD_BENCHMARKS=ON. Without arguments three synthetic traces
+ * are replayed; a trace file can be given instead, one operation per line:
+ *
+ *     a <id> <bytes>    allocate bytes and remember the pointer as id
+ *     f <id>            free the pointer remembered as id
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "halloc/includes/Block.hpp"
+#include "halloc/includes/FreeIndex.hpp"
+
+using namespace hh::halloc;
+
+namespace {
+
+/// Address space given to every replay; only the pages a policy touches are committed
+constexpr std::size_t ARENA_SIZE = std::size_t{1} << 30;
+
+struct Op {
+    bool allocate;
+    std::uint32_t id;
+    std::size_t bytes;
+};
+
+using Trace = std::vector<Op>;
+
+struct Result {
+    std::size_t peak_live = 0;
+    std::size_t footprint = 0;
+    double seconds = 0;
+    bool exhausted = false;
+};
+
+/**
+ * @brief Sizes spread evenly over log2, allocation/free with random lifetimes
+ */
+Trace mixed_trace(std::size_t ops, std::size_t target_live, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> log_size(4.0, 13.0);
+    Trace trace;
+    std::vector<std::uint32_t> live;
+    std::uint32_t next_id = 0;
+
+    for (std::size_t i = 0; i < ops; i++) {
+        bool grow = live.size() < target_live / 2 ||
+                    (live.size() < 2 * target_live && rng() % 2 == 0);
+        if (grow) {
+            auto bytes = static_cast<std::size_t>(std::exp2(log_size(rng)));
+            trace.push_back({true, next_id, bytes});
+            live.push_back(next_id++);
+        } else {
+            std::size_t index = rng() % live.size();
+            trace.push_back({false, live[index], 0});
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+    for (std::uint32_t id : live) {
+        trace.push_back({false, id, 0});
+    }
+    return trace;
+}
+
+/**
+ * @brief Waves of small objects, most freed at random, followed by larger ones
+ *
+ * Each wave leaves a sparse set of survivors behind, so the holes between them
+ * only help if later requests are placed into them rather than past them.
+ */
+Trace phased_trace(std::size_t waves, std::size_t per_wave, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    Trace trace;
+    std::vector<std::uint32_t> survivors;
+    std::uint32_t next_id = 0;
+
+    for (std::size_t wave = 0; wave < waves; wave++) {
+        std::size_t bytes = 32 << (wave % 4);
+        std::vector<std::uint32_t> batch;
+        for (std::size_t i = 0; i < per_wave; i++) {
+            trace.push_back({true, next_id, bytes + rng() % bytes});
+            batch.push_back(next_id++);
+        }
+        std::shuffle(batch.begin(), batch.end(), rng);
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            if (i % 8 == 0) {
+                survivors.push_back(batch[i]);
+            } else {
+                trace.push_back({false, batch[i], 0});
+            }
+        }
+        if (survivors.size() > 4 * per_wave) {
+            std::shuffle(survivors.begin(), survivors.end(), rng);
+            for (std::size_t i = 0; i < survivors.size() / 2; i++) {
+                trace.push_back({false, survivors[i], 0});
+            }
+            survivors.erase(survivors.begin(),
+                            survivors.begin() + static_cast<std::ptrdiff_t>(survivors.size() / 2));
+        }
+    }
+    for (std::uint32_t id : survivors) {
+        trace.push_back({false, id, 0});
+    }
+    return trace;
+}
+
+/**
+ * @brief Many objects of a handful of equal sizes, freed and reallocated in bursts
+ *
+ * Exercises the tie-break between equal-sized holes directly.
+ */
+Trace equal_sizes_trace(std::size_t ops, std::size_t target_live, std::uint32_t seed) {
+    static constexpr std::size_t SIZES[] = {48, 64, 96, 128, 256};
+    std::mt19937 rng(seed);
+    Trace trace;
+    std::vector<std::uint32_t> live;
+    std::uint32_t next_id = 0;
+
+    while (trace.size() < ops) {
+        std::size_t burst = 1 + rng() % 256;
+        bool grow = live.size() < target_live / 2 ||
+                    (live.size() < 2 * target_live && rng() % 2 == 0);
+        for (std::size_t i = 0; i < burst; i++) {
+            if (grow) {
+                trace.push_back({true, next_id, SIZES[rng() % std::size(SIZES)]});
+                live.push_back(next_id++);
+            } else if (!live.empty()) {
+                std::size_t index = rng() % live.size();
+                trace.push_back({false, live[index], 0});
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+    }
+    for (std::uint32_t id : live) {
+        trace.push_back({false, id, 0});
+    }
+    return trace;
+}
+
+/**
+ * @brief Reads a trace file in the format described at the top of this file
+ */
+Trace read_trace(const char* path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "cannot open " << path << "\n";
+        std::exit(1);
+    }
+
+    Trace trace;
+    std::string kind;
+    std::uint32_t id = 0;
+    while (in >> kind >> id) {
+        std::size_t bytes = 0;
+        if (kind == "a") {
+            in >> bytes;
+        }
+        trace.push_back({kind == "a", id, bytes});
+    }
+    return trace;
+}
+
+template <typename BlockType>
+Result replay(const Trace& trace) {
+    BlockType block(ARENA_SIZE, 0);
+    auto head = reinterpret_cast<std::uintptr_t>(block.get_head());
+    std::unordered_map<std::uint32_t, std::pair<void*, std::size_t>> live;
+    live.reserve(trace.size() / 2);
+
+    Result result;
+    std::size_t live_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const Op& op : trace) {
+        if (op.allocate) {
+            MemoryNode* node = block.best_fit(op.bytes);
+            if (node == nullptr) {
+                result.exhausted = true;
+                break;
+            }
+            void* ptr = block.allocate(op.bytes, node);
+            live[op.id] = {ptr, op.bytes};
+            live_bytes += op.bytes;
+            result.peak_live = std::max(result.peak_live, live_bytes);
+            result.footprint = std::max(
+                result.footprint, reinterpret_cast<std::uintptr_t>(ptr) + op.bytes - head);
+        } else {
+            auto it = live.find(op.id);
+            if (it == live.end()) {
+                continue;
+            }
+            block.deallocate(it->second.first, it->second.second);
+            live_bytes -= it->second.second;
+            live.erase(it);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+
+    for (auto& [id, entry] : live) {
+        block.deallocate(entry.first, entry.second);
+    }
+    return result;
+}
+
+void print_row(const char* policy, const Result& result, std::size_t ops) {
+    if (result.exhausted) {
+        std::printf("  %-16s  block exhausted\n", policy);
+        return;
+    }
+    double overhead = 100.0 * (static_cast<double>(result.footprint) /
+                                   static_cast<double>(result.peak_live) -
+                               1.0);
+    std::printf("  %-16s  peak live %9.2f KiB  footprint %9.2f KiB  overhead %7.2f%%",
+                policy, static_cast<double>(result.peak_live) / 1024.0,
+                static_cast<double>(result.footprint) / 1024.0, overhead);
+    std::printf("  %6.1f ns/op\n", 1e9 * result.seconds / static_cast<double>(ops));
+}
+
+void run(const char* name, const Trace& trace) {
+    std::printf("%s (%zu ops)\n", name, trace.size());
+    print_row("rb-tree", replay<BasicBlock<RBTreeIndex<MemoryNode>>>(trace), trace.size());
+    print_row("address-ordered", replay<BasicBlock<AddressOrderedIndex<MemoryNode>>>(trace),
+              trace.size());
+    print_row("tlsf", replay<BasicBlock<TlsfIndex<MemoryNode>>>(trace), trace.size());
+    print_row("segregated", replay<BasicBlock<SegregatedFitIndex<MemoryNode>>>(trace),
+              trace.size());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            run(argv[i], read_trace(argv[i]));
+        }
+        return 0;
+    }
+
+    run("mixed", mixed_trace(1'000'000, 20'000, 1));
+    run("phased", phased_trace(64, 20'000, 2));
+    run("equal sizes", equal_sizes_trace(1'000'000, 20'000, 3));
+    return 0;
+}
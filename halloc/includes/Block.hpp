@@ -1,19 +1,24 @@
 /**
  * @file Block.hpp
- * @brief Memory block management with Red-Black tree based allocator
+ * @brief Memory block management with a pluggable free chunk index
  *
- * This file implements a memory block that uses a Red-Black tree to track
- * free memory regions and provides efficient allocation/deallocation.
+ * This file implements a memory block that uses a free index (a Red-Black tree by
+ * default) to track free memory regions and provides efficient allocation/deallocation.
  */
 
 #pragma once
 #include <sys/mman.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <bit>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <new>
 
-#include "RBTreeDriver.hpp"
+#include "FreeIndex.hpp"
 
 /**
  * @def REQUEST_MEMORY_VIA_MMAP
@@ -33,23 +38,154 @@
 #define RELEASE_MEMORY_VIA_MUNMAP(ptr, size) munmap(ptr, size)
 
 namespace hh::halloc {
+/**
+ * @brief Alignment guaranteed for every pointer returned by Block::allocate.
+ *
+ * Chunks are split only at multiples of MIN_ALIGNMENT, so every MemoryNode (and
+ * therefore every payload) stays aligned to it.
+ */
+constexpr std::size_t MIN_ALIGNMENT = alignof(std::max_align_t);
+
+/**
+ * @brief Rounds a size up to a multiple of a power-of-two alignment.
+ */
+constexpr std::size_t align_up(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief Maps anonymous memory aligned to `alignment`.
+ *
+ * Alignments up to the page size come for free with mmap. Larger alignments map
+ * bytes + alignment and unmap the unaligned head and the unused tail, so the
+ * result can later be released with RELEASE_MEMORY_VIA_MUNMAP(ptr, bytes).
+ *
+ * @param bytes Size in bytes to map
+ * @param alignment Power-of-two alignment
+ * @param prot Protection of the mapping
+ * @param flags mmap flags (MAP_PRIVATE | MAP_ANONYMOUS plus any extra flags)
+ * @return Pointer to aligned memory or MAP_FAILED on error
+ */
+inline void* map_aligned(std::size_t bytes, std::size_t alignment, int prot, int flags) {
+    std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    if (alignment <= page_size) {
+        return mmap(nullptr, bytes, prot, flags, -1, 0);
+    }
+
+    std::size_t mapped = align_up(bytes, page_size) + alignment;
+    void* raw = mmap(nullptr, mapped, prot, flags, -1, 0);
+    if (raw == MAP_FAILED) {
+        return MAP_FAILED;
+    }
+
+    auto start = reinterpret_cast<std::uintptr_t>(raw);
+    std::uintptr_t aligned = align_up(start, alignment);
+    std::uintptr_t end = aligned + align_up(bytes, page_size);
+
+    if (aligned > start) {
+        RELEASE_MEMORY_VIA_MUNMAP(raw, aligned - start);
+    }
+    if (start + mapped > end) {
+        RELEASE_MEMORY_VIA_MUNMAP(reinterpret_cast<void*>(end), start + mapped - end);
+    }
+    return reinterpret_cast<void*>(aligned);
+}
+
+/**
+ * @brief Allocates memory from the operating system aligned to `alignment`.
+ *
+ * @param bytes Size in bytes to allocate
+ * @param alignment Power-of-two alignment
+ * @return Pointer to aligned memory or MAP_FAILED on error; release it with
+ *         RELEASE_MEMORY_VIA_MUNMAP(ptr, bytes)
+ */
+inline void* request_aligned_memory_via_mmap(std::size_t bytes, std::size_t alignment) {
+    return map_aligned(bytes, alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS);
+}
+
+/**
+ * @brief Reserves address space aligned to `alignment` without committing memory.
+ *
+ * The range is mapped PROT_NONE with MAP_NORESERVE, so it is neither writable nor
+ * charged against memory or swap until parts of it are committed with mprotect.
+ *
+ * @param bytes Size in bytes to reserve
+ * @param alignment Power-of-two alignment
+ * @return Pointer to the reservation or MAP_FAILED on error; release it with
+ *         RELEASE_MEMORY_VIA_MUNMAP(ptr, bytes)
+ */
+inline void* reserve_address_space(std::size_t bytes, std::size_t alignment) {
+    return map_aligned(bytes, alignment, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE);
+}
+
+/**
+ * @brief Huge page size that huge-page-backed blocks are aligned and sized to.
+ */
+constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/**
+ * @brief How the OS backs the memory of a Block.
+ */
+enum class PageBacking {
+    Regular,          ///< Plain anonymous pages
+    TransparentHuge,  ///< HUGE_PAGE_SIZE-aligned mapping advised with MADV_HUGEPAGE
+    HugeTlb,          ///< MAP_HUGETLB from the reserved pool, else TransparentHuge
+};
+
+/**
+ * @brief Maps memory for a block with the requested page backing.
+ *
+ * TransparentHuge aligns the mapping to HUGE_PAGE_SIZE so that the kernel can back
+ * it with whole huge pages, and asks for them with MADV_HUGEPAGE (ignored where THP
+ * is unavailable). HugeTlb takes pages from the hugetlbfs pool; when none are
+ * reserved the mapping fails and TransparentHuge is used instead.
+ *
+ * @param bytes Size in bytes (a multiple of HUGE_PAGE_SIZE unless backing is Regular)
+ * @param backing Requested page backing
+ * @return Pointer to the mapping or MAP_FAILED on error; release it with
+ *         RELEASE_MEMORY_VIA_MUNMAP(ptr, bytes)
+ */
+inline void* request_block_memory(std::size_t bytes, PageBacking backing) {
+    if (backing == PageBacking::Regular) {
+        return REQUEST_MEMORY_VIA_MMAP(bytes);
+    }
+
+    if (backing == PageBacking::HugeTlb) {
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            return memory;
+        }
+    }
+
+    void* memory = request_aligned_memory_via_mmap(bytes, HUGE_PAGE_SIZE);
+    if (memory != MAP_FAILED) {
+        madvise(memory, bytes, MADV_HUGEPAGE);
+    }
+    return memory;
+}
+
 /**
  * @struct MemoryNode
- * @brief Node structure for both Red-Black tree and doubly-linked list
+ * @brief Boundary-tagged chunk header whose Red-Black tree links live in the payload
+ *
+ * Each node represents a memory region (either free or allocated). Only the first
+ * MEMORY_NODE_SIZE bytes (prev_size and value) are a header that every chunk carries:
+ * - value gives the chunk's size, so the next chunk starts right after the payload
+ * - prev_size gives the previous chunk's size, so the previous chunk can be found
+ *   in O(1) for coalescing without storing list pointers
  *
- * Each node represents a memory region (either free or allocated).
- * The node serves dual purposes:
- * - Part of a Red-Black tree (via left, right, parent) for efficient searching
- * - Part of a doubly-linked list (via next, prev) for sequential memory management
+ * The tree links (left, right, parent), the purged flag and the twins link are only
+ * meaningful while the chunk is free and overlap the first bytes of its payload; an
+ * allocated chunk hands those bytes to the user. This is why every chunk's payload
+ * is at least MIN_CHUNK_PAYLOAD bytes.
  *
  * @note Bit 63 of value: Red-Black tree color (1=Red, 0=Black)
  * @note Bit 62 of value: Allocation status (1=Used, 0=Free)
  * @note Bits 0-61 of value: Size of the memory region in bytes
  */
 struct MemoryNode {
-    MemoryNode* left;    ///< Left child in Red-Black tree
-    MemoryNode* right;   ///< Right child in Red-Black tree
-    MemoryNode* parent;  ///< Parent node in Red-Black tree
+    std::size_t prev_size;  ///< Payload size of the previous chunk (0 for the first chunk)
 
     /**
      * @brief Encoded value containing size, status, and color
@@ -61,32 +197,138 @@ struct MemoryNode {
      */
     std::size_t value;
 
-    MemoryNode* next;  ///< Next node in memory sequence (doubly-linked list)
-    MemoryNode* prev;  ///< Previous node in memory sequence (doubly-linked list)
+    MemoryNode* left;    ///< Left child in RB-tree / previous in free list (payload, free only)
+    MemoryNode* right;   ///< Right child in RB-tree / next in free list (payload, free only)
+    MemoryNode* parent;  ///< Parent node in Red-Black tree (payload, free chunks only)
+    std::uintptr_t purged : 1;  ///< Pages past this node were returned to the OS (payload, free)
+
+    /**
+     * @brief Address of the first free chunk of the same size chained behind this
+     *        RB-tree node, or 0 (payload, free chunks only; see RBTreeIndex)
+     *
+     * Shares a word with purged: user-space addresses fit in 63 bits.
+     */
+    std::uintptr_t twins : 63;
 };
 
 /**
  * @def MEMORY_NODE_SIZE
- * @brief Size of the MemoryNode metadata structure
+ * @brief Size of the per-chunk header (prev_size and value), i.e. the overhead of
+ *        every allocation
+ */
+#define MEMORY_NODE_SIZE offsetof(MemoryNode, left)
+
+/**
+ * @brief Smallest payload a chunk may have: a freed chunk must hold its tree links.
+ */
+constexpr std::size_t MIN_CHUNK_PAYLOAD =
+    align_up(sizeof(MemoryNode) - MEMORY_NODE_SIZE, MIN_ALIGNMENT);
+
+/**
+ * @brief Default size from which a free chunk's pages are returned to the OS.
+ */
+constexpr std::size_t DEFAULT_PURGE_THRESHOLD = 64 * 1024;
+
+/**
+ * @brief Default delay between a large free chunk forming and its pages being purged.
+ *
+ * Purging at once would make a tight alloc/free loop next to a large free chunk
+ * (such as the free tail of a block) pay a madvise and page faults per iteration.
+ * Deferring it by a decay, like LargeMappingCache::DEFAULT_DECAY, purges such a
+ * chunk at most once per decay while resident memory still follows live memory.
+ */
+constexpr std::chrono::milliseconds DEFAULT_PURGE_DECAY{10000};  ///< 10 s
+
+/**
+ * @brief When a Block returns the pages of its free chunks to the OS.
+ *
+ * Free chunks of at least threshold bytes are purged once they have been dirty (or
+ * re-dirtied by a merge) for decay; a decay of 0 purges them as soon as they form.
+ */
+struct PurgeConfig {
+    std::size_t threshold = DEFAULT_PURGE_THRESHOLD;  ///< Smallest purged chunk (0 = never)
+    std::chrono::milliseconds decay = DEFAULT_PURGE_DECAY;  ///< Delay before purging
+};
+
+/**
+ * @brief How a Block rounds requests into chunk sizes and when it splits chunks.
+ *
+ * Every request is rounded up to a multiple of granule, and to at least
+ * MIN_CHUNK_PAYLOAD. Requests above geometric_threshold are further rounded up to
+ * one of classes_per_doubling evenly spaced sizes between consecutive powers of two
+ * (at most 1 / classes_per_doubling of internal fragmentation), so a freed chunk of
+ * a class fits the next request of that class exactly and the free index sees few
+ * distinct sizes. A chunk is split only if the tail would hold at least
+ * min_remainder bytes; a smaller tail stays with the allocation.
+ *
+ * The defaults round to MIN_ALIGNMENT only and split off any tail that can hold a
+ * free chunk.
  */
-#define MEMORY_NODE_SIZE sizeof(MemoryNode)
+struct SizeClasses {
+    std::size_t granule = MIN_ALIGNMENT;  ///< Rounding step (power of two >= MIN_ALIGNMENT)
+    std::size_t geometric_threshold = 0;  ///< Larger sizes use geometric classes (0 = never)
+    std::size_t classes_per_doubling = 4;  ///< Classes per power of two (a power of two)
+    std::size_t min_remainder = MIN_CHUNK_PAYLOAD;  ///< Smallest payload split off as free
+
+    /**
+     * @brief Checks the constraints documented on each field.
+     * @return true if a Block can use these size classes
+     */
+    constexpr bool is_valid() const {
+        return std::has_single_bit(granule) && granule >= MIN_ALIGNMENT &&
+               std::has_single_bit(classes_per_doubling) && min_remainder >= MIN_CHUNK_PAYLOAD;
+    }
+
+    /**
+     * @brief Rounds a request up to its chunk size.
+     * @param bytes Requested payload size
+     * @return Payload size of the chunk serving the request (a multiple of granule)
+     */
+    constexpr std::size_t round(std::size_t bytes) const {
+        std::size_t size = std::max(align_up(bytes, granule), MIN_CHUNK_PAYLOAD);
+        if (geometric_threshold && size > geometric_threshold) {
+            std::size_t step = std::bit_floor(size) / classes_per_doubling;
+            size = align_up(size, std::max(step, granule));
+        }
+        return size;
+    }
+};
 
 /**
- * @class Block
- * @brief Manages a contiguous memory block with RB-tree based allocation
+ * @class BasicBlock
+ * @brief Manages a contiguous memory block whose free chunks are kept in a FreeIndex
  *
- * The Block class provides memory allocation and deallocation within a fixed
+ * The BasicBlock class provides memory allocation and deallocation within a fixed
  * memory region. It uses:
- * - Red-Black tree for O(log n) best-fit searches among free blocks
- * - Doubly-linked list for O(1) merging of adjacent free blocks
+ * - A free index (see FreeIndex.hpp) to find a free chunk for each request; the
+ *   default RBTreeIndex gives O(log n) best fit, TlsfIndex O(1) good fit
+ * - Boundary tags (chunk sizes) for O(1) merging of adjacent free blocks
  *
  * Memory is obtained from the OS via mmap and released via munmap.
  * Internal fragmentation is minimized through block splitting and coalescing.
+ * Every returned pointer is aligned to MIN_ALIGNMENT; larger alignments are
+ * available through best_fit_aligned()/allocate_aligned().
+ *
+ * @tparam FreeIndex Free chunk index policy: RBTreeIndex, AddressOrderedIndex,
+ *                   TlsfIndex or SegregatedFitIndex over MemoryNode (instantiated
+ *                   in Block.cpp)
  */
-class Block {
+template <typename FreeIndex = RBTreeIndex<MemoryNode>>
+class BasicBlock {
     std::size_t size;                  ///< Total block size including metadata
     MemoryNode* head;                  ///< First node in the memory block
-    RBTreeDriver<MemoryNode> rb_tree;  ///< Red-Black tree of free nodes
+    FreeIndex free_chunks;             ///< Index of the free nodes
+    std::size_t free_bytes;            ///< Payload bytes held by the free nodes
+    std::size_t purge_threshold;       ///< Free chunks this large are purged (0 = never)
+    std::size_t purge_granule;         ///< Page size at which free chunks are purged
+    std::size_t reserved;              ///< Bytes of address space reserved (>= size)
+    SizeClasses size_classes;          ///< Request rounding and minimum split remainder
+    MemoryNode* tail;                  ///< Last chunk of the block
+
+    std::chrono::milliseconds purge_decay;                 ///< Delay before dirty chunks are purged
+    std::chrono::steady_clock::time_point purge_deadline;  ///< When the pending purge runs
+    bool purge_pending;                                    ///< A large free chunk is dirty
+
     /**
      * @brief Extracts actual size from encoded value
      * @param value Encoded value with color and status bits
@@ -115,20 +357,114 @@ class Block {
      */
     bool is_free(const std::size_t& value) const;
 
+    /**
+     * @brief Returns the chunk that follows a node in memory
+     * @return Next node, or nullptr if node is the last chunk of the block
+     */
+    MemoryNode* next_node(const MemoryNode* node) const;
+
+    /**
+     * @brief Returns the chunk that precedes a node in memory (via prev_size)
+     * @return Previous node, or nullptr if node is the first chunk of the block
+     */
+    MemoryNode* prev_node(const MemoryNode* node) const;
+
+    /**
+     * @brief Writes a node's size into the boundary tag of the chunk after it
+     * @post next_node(node)->prev_size == size of node (if a next chunk exists)
+     */
+    void update_next_prev_size(MemoryNode* node) const;
+
+    /**
+     * @brief Computes the bytes to skip at the start of a node's payload so that
+     *        the payload becomes aligned.
+     *
+     * The skipped bytes become a separate free node, so a non-zero padding is always
+     * large enough for a header plus MIN_CHUNK_PAYLOAD bytes of payload.
+     *
+     * @param node Candidate free node
+     * @param alignment Power-of-two alignment (> MIN_ALIGNMENT)
+     * @return 0 if the payload is already aligned, otherwise the padding in bytes
+     */
+    std::size_t aligned_padding(const MemoryNode* node, std::size_t alignment) const;
+
+    /**
+     * @brief Adds a free node to the free index and to the free byte count
+     * @param node Free node not in the free index
+     */
+    void insert_free(MemoryNode* node);
+
+    /**
+     * @brief Takes a free node out of the free index and the free byte count
+     * @param node Free node in the free index
+     * @pre node's size has not changed since insert_free()
+     */
+    void remove_free(MemoryNode* node);
+
+    /**
+     * @brief Hands a free node's free index entry to a node with a new header and/or size
+     *
+     * The tree-based indexes keep the entry in place when the new size does not
+     * change its order; see FreeIndex.hpp.
+     *
+     * @param node Free node in the free index
+     * @param new_node node itself, or a free node not in the free index
+     * @param new_size Payload size of new_node
+     * @post new_node->value holds new_size as a free node and new_node is in the free index
+     */
+    void rekey_free(MemoryNode* node, MemoryNode* new_node, std::size_t new_size);
+
+    /**
+     * @brief Gets the payload size a node keeps when it serves a request
+     * @param bytes Requested size, at most node_size
+     * @param node_size Payload size of the serving node
+     * @return size_classes.round(bytes), capped at node_size
+     */
+    std::size_t chunk_size(std::size_t bytes, std::size_t node_size) const {
+        return std::min(size_classes.round(bytes), node_size);
+    }
+
     /**
      * @brief Splits a node and creates remainder as new free node
      *
      * If the node is larger than needed, splits it into two:
-     * - First part: allocated to user (size = bytes)
-     * - Second part: new free node inserted into RB-tree
+     * - First part: allocated to user (size = bytes rounded by size_classes, capped
+     *   at the node size)
+     * - Second part: new free node inserted into the free index, if it holds at
+     *   least size_classes.min_remainder bytes
      *
      * @param node The node to potentially split
      * @param bytes Size requested by user
      * @post node is marked as used
-     * @post If large enough, remainder is added to RB-tree as free node
+     * @post If large enough, remainder is added to the free index as free node
      */
     void shrink_then_align(MemoryNode* node, std::size_t bytes);
 
+    /**
+     * @brief Cuts the part of a chunk past its first `bytes` bytes into a new free chunk
+     *
+     * The new chunk gets its header and boundary tag but is neither inserted into the
+     * free index nor given a purged flag; the caller does both.
+     *
+     * @param node Chunk to cut (not in the free index)
+     * @param bytes Payload size to keep, a multiple of MIN_ALIGNMENT >= MIN_CHUNK_PAYLOAD
+     * @return The new free chunk, or nullptr if the rest would hold less than
+     *         size_classes.min_remainder bytes
+     * @post On success node's size is bytes and its status bit is cleared
+     */
+    MemoryNode* split_off(MemoryNode* node, std::size_t bytes);
+
+    /**
+     * @brief Carves `count` consecutive chunks of the same size out of one free node
+     *
+     * @param node Free node in the free index, large enough for count chunks
+     * @param bytes Payload size of each chunk (already rounded like shrink_then_align)
+     * @param count Number of chunks to carve (>= 1)
+     * @param out Receives the payload pointers, in address order
+     * @post The unused end of node (if large enough) is back in the free index
+     */
+    void carve(MemoryNode* node, std::size_t bytes, std::size_t count, void** out);
+
     /**
      * @brief Merges adjacent free blocks
      *
@@ -138,17 +474,42 @@ class Block {
      *
      * @param node The node to merge with adjacent free blocks
      * @post Adjacent free blocks are coalesced
-     * @post Merged node is inserted into RB-tree
-     * @post Doubly-linked list is updated
+     * @post Merged node is inserted into the free index
+     * @post Boundary tags (prev_size) are updated
      */
     void coalesce_nodes(MemoryNode* node);
 
+    /**
+     * @brief Returns the whole pages inside a free node's payload to the OS.
+     *
+     * Pages past the node's tree links are released with MADV_DONTNEED, except
+     * those in [begin, end) known to be purged already. Nodes smaller than
+     * purge_threshold are left resident and marked as not purged.
+     *
+     * @param node Free node (already merged with its free neighbours)
+     * @param clean_until Pages below this address are already purged (0 if none)
+     * @param clean_from Pages from this address on are already purged (0 if none)
+     * @post node->purged is true iff the node's interior pages are not resident
+     */
+    void purge_free_pages(MemoryNode* node, std::uintptr_t clean_until,
+                          std::uintptr_t clean_from);
+
+    /**
+     * @brief Marks a merged free node as dirty and runs the purges that are due.
+     *
+     * A node that reaches purge_threshold arms the block's purge deadline (if it is
+     * not armed yet); once the deadline has passed, purge() runs.
+     *
+     * @param node Free node (already merged with its free neighbours)
+     */
+    void defer_purge(MemoryNode* node);
+
 public:
     /**
      * @brief Default constructor - creates invalid block
      * @post size = 0, head = nullptr
      */
-    Block();
+    BasicBlock();
 
     /**
      * @brief Constructs a memory block of specified size
@@ -157,17 +518,47 @@ public:
      * with a single large free node.
      *
      * @param bytes Total block size in bytes
+     * @param purge_threshold Free chunks at least this large return their pages to the
+     *                        OS (0 disables purging)
+     * @param backing Page backing; huge page backings round bytes up to a multiple of
+     *                HUGE_PAGE_SIZE and purge whole huge pages only
+     * @param reserve_bytes If larger than bytes, reserve this much address space and
+     *                      commit only the first bytes (rounded up to whole pages);
+     *                      the block can then grow() in place up to the reservation.
+     *                      HugeTlb backing uses transparent huge pages in this mode
+     * @param size_classes Request rounding and minimum split remainder
+     * @param purge_decay How long a large free chunk stays dirty before it is purged
+     *                    (0 purges it as soon as it forms)
      * @throws std::bad_alloc if mmap fails
-     * @post Block is initialized with one free node of size (bytes - MEMORY_NODE_SIZE)
+     * @throws std::invalid_argument if size_classes is not valid
+     * @post Block is initialized with one free node of size (get_size() - MEMORY_NODE_SIZE)
      */
-    explicit Block(std::size_t bytes);
+    explicit BasicBlock(std::size_t bytes, std::size_t purge_threshold = DEFAULT_PURGE_THRESHOLD,
+                        PageBacking backing = PageBacking::Regular, std::size_t reserve_bytes = 0,
+                        const SizeClasses& size_classes = SizeClasses{},
+                        std::chrono::milliseconds purge_decay = DEFAULT_PURGE_DECAY);
+
+    /**
+     * @brief Constructs a memory block, reporting failure instead of throwing
+     *
+     * Same as the throwing constructor, for callers that must not throw, e.g.
+     * while holding a lock that allocating the exception could need again.
+     *
+     * @post get_head() is nullptr if mmap fails or size_classes is not valid; the
+     *       block is then invalid like a default-constructed one
+     */
+    BasicBlock(std::nothrow_t, std::size_t bytes,
+               std::size_t purge_threshold = DEFAULT_PURGE_THRESHOLD,
+               PageBacking backing = PageBacking::Regular, std::size_t reserve_bytes = 0,
+               const SizeClasses& size_classes = SizeClasses{},
+               std::chrono::milliseconds purge_decay = DEFAULT_PURGE_DECAY);
 
     /**
      * @brief Move constructor
      * @param other Block to move from
      * @post other is left in valid but empty state
      */
-    Block(Block&& other);
+    BasicBlock(BasicBlock&& other);
 
     /**
      * @brief Move assignment operator
@@ -175,32 +566,94 @@ public:
      * @return Reference to this block
      * @post other is left in valid but empty state
      */
-    Block& operator=(Block&& other);
+    BasicBlock& operator=(BasicBlock&& other);
 
     /**
      * @brief Finds best-fit free node for allocation
      *
-     * Searches the RB-tree for the smallest free node that can fit
-     * the requested size.
+     * Asks the free index for a free node that can fit the requested size: the
+     * smallest one with RBTreeIndex, a good fit with the list-based policies.
      *
      * @param bytes Size in bytes to allocate
-     * @return Pointer to best-fit node, or nullptr if no suitable node exists
-     * @note Uses RB-tree's lower_bound for O(log n) search
+     * @return Pointer to a fitting node, or nullptr if no suitable node exists
+     * @note O(log n) with RBTreeIndex, O(1) with TlsfIndex in the common case
      */
     MemoryNode* best_fit(std::size_t bytes);
 
+    /**
+     * @brief Finds a free node that can hold `bytes` at the given alignment.
+     *
+     * Tries the plain best fit first and accepts it if it can be aligned in place;
+     * otherwise searches for a node large enough for the worst-case padding.
+     *
+     * @param bytes Size in bytes to allocate
+     * @param alignment Power-of-two alignment
+     * @return Pointer to a suitable node, or nullptr if no suitable node exists
+     */
+    MemoryNode* best_fit_aligned(std::size_t bytes, std::size_t alignment);
+
+    /**
+     * @brief Gets the size of the largest free node.
+     * @return Largest free payload in bytes, or 0 if the block is full
+     * @note O(1) with the tree-based indexes, which keep their maximum up to date
+     */
+    std::size_t largest_free_size() const;
+
     /**
      * @brief Destructor - releases memory back to OS
      * @post Memory is returned via munmap
      */
-    ~Block();
+    ~BasicBlock();
 
     /**
      * @brief Gets total block size
-     * @return Size in bytes including all metadata
+     * @return Committed size in bytes including all metadata
      */
     std::size_t get_size() const { return size; }
 
+    /**
+     * @brief Gets the payload bytes held by free nodes
+     *
+     * Maintained on every free index insertion and removal, so reading it is O(1).
+     * The free bytes may be split across many nodes; see largest_free_size().
+     *
+     * @return Sum of the free nodes' sizes (headers excluded)
+     */
+    std::size_t get_free_size() const { return free_bytes; }
+
+    /**
+     * @brief Gets the request rounding and split policy of the block
+     */
+    const SizeClasses& get_size_classes() const { return size_classes; }
+
+    /**
+     * @brief Gets the address space reserved for the block
+     * @return Reserved size in bytes (equal to get_size() unless created with a reservation)
+     */
+    std::size_t get_reserved_size() const { return reserved; }
+
+    /**
+     * @brief Commits more of the reservation, growing the block in place
+     *
+     * The committed pages extend the last chunk if it is free, or become a new free
+     * chunk after it otherwise.
+     *
+     * @param bytes Number of bytes to add (rounded up to whole pages)
+     * @return false if the reservation has no room left or mprotect fails
+     * @post On success get_size() grew by bytes rounded up to whole pages
+     */
+    bool grow(std::size_t bytes);
+
+    /**
+     * @brief Returns the pages of every dirty free chunk of at least purge_threshold
+     *        bytes to the OS now, without waiting for the purge decay
+     *
+     * Walks every chunk of the block, so deallocations run it at most once per decay.
+     *
+     * @post Every free chunk >= purge_threshold is purged (none if purging is disabled)
+     */
+    void purge();
+
     /**
      * @brief Gets pointer to the head node
      * @return Pointer to first memory node
@@ -210,7 +663,7 @@ public:
     /**
      * @brief Allocates memory from a specific node
      *
-     * Removes node from RB-tree, potentially splits it if too large,
+     * Removes node from the free index, potentially splits it if too large,
      * and returns pointer to usable memory (after metadata).
      *
      * @param bytes Size in bytes requested
@@ -222,21 +675,78 @@ public:
      */
     void* allocate(std::size_t bytes, MemoryNode* node);
 
+    /**
+     * @brief Allocates aligned memory from a specific node
+     *
+     * If the node's payload is not aligned, its leading part is split off and kept
+     * as a free node, and the allocation starts at the next aligned address.
+     *
+     * @param bytes Size in bytes requested
+     * @param alignment Power-of-two alignment
+     * @param node The node to allocate from (from best_fit_aligned with the same arguments)
+     * @return Pointer to usable memory aligned to `alignment`
+     * @pre node must be a valid free node returned by best_fit_aligned(bytes, alignment)
+     */
+    void* allocate_aligned(std::size_t bytes, std::size_t alignment, MemoryNode* node);
+
     /**
      * @brief Deallocates previously allocated memory
      *
      * Marks the region as free and attempts to merge with adjacent
-     * free blocks to reduce fragmentation.
+     * free blocks to reduce fragmentation. If the merged chunk reaches the purge
+     * threshold, its pages are returned to the OS once the purge decay has passed
+     * (by this or a later deallocation; at once if the decay is 0).
      *
      * @param ptr Pointer returned from allocate()
      * @param bytes Size parameter (currently unused)
      * @pre ptr must have been returned from allocate() on this block
      * @post Memory is marked as free
      * @post Adjacent free blocks are merged if possible
-     * @post Merged block is inserted into RB-tree
+     * @post Merged block is inserted into the free index
      */
     void deallocate(void* ptr, std::size_t bytes);
 
+    /**
+     * @brief Resizes an allocation without moving it
+     *
+     * Growing takes the missing bytes from the next chunk when it is free; whatever
+     * is left of that chunk stays free. Shrinking splits the unused tail off as a
+     * free chunk and merges it with a free next chunk. A shrink always succeeds,
+     * although the chunk keeps its size when the tail is too small to be split off.
+     *
+     * @param ptr Pointer returned from allocate() on this block
+     * @param bytes New size in bytes
+     * @return true if the allocation now holds at least bytes bytes at ptr,
+     *         false (and nothing changed) if the next chunk cannot supply them
+     */
+    bool try_expand(void* ptr, std::size_t bytes);
+
+    /**
+     * @brief Allocates up to `count` chunks of `bytes` bytes with few tree searches
+     *
+     * Chunks are carved back to back from a single free node when one is large
+     * enough for all of them; otherwise the largest free nodes are carved in turn.
+     * Each carved node costs one free index search, however many chunks it yields.
+     *
+     * @param bytes Size of each chunk in bytes
+     * @param count Number of chunks wanted
+     * @param out Receives the payload pointers (MIN_ALIGNMENT-aligned)
+     * @return Number of chunks allocated (less than count if the block ran out)
+     */
+    std::size_t allocate_batch(std::size_t bytes, std::size_t count, void** out);
+
+    /**
+     * @brief Deallocates several chunks, merging neighbouring ones in one pass
+     *
+     * Runs of chunks that are adjacent in memory are merged into one free chunk
+     * before it is coalesced with its free neighbours and inserted into the free index,
+     * so a run costs one tree insertion instead of one per chunk.
+     *
+     * @param ptrs Pointers returned by allocate() on this block, sorted by address
+     * @param count Number of pointers
+     */
+    void deallocate_batch(void* const* ptrs, std::size_t count);
+
     /**
      * @brief Logs the current state of the block to a file.
      *
@@ -281,7 +791,7 @@ public:
                 actual_used_space += node_size;
                 num_used_nodes++;
             }
-            current = current->next;
+            current = next_node(current);
         }
 
         logfile << "-------------------------------------------------------\n";
@@ -292,4 +802,14 @@ public:
         logfile << "Number of Used Nodes: " << num_used_nodes << "\n";
     }
 };
+
+/**
+ * @brief Block indexing its free chunks in a Red-Black tree (strict best fit).
+ */
+using Block = BasicBlock<>;
+
+extern template class BasicBlock<RBTreeIndex<MemoryNode>>;
+extern template class BasicBlock<AddressOrderedIndex<MemoryNode>>;
+extern template class BasicBlock<TlsfIndex<MemoryNode>>;
+extern template class BasicBlock<SegregatedFitIndex<MemoryNode>>;
 }  // namespace hh::halloc
\ No newline at end of file
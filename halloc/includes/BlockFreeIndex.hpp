@@ -0,0 +1,135 @@
+/**
+ * @file BlockFreeIndex.hpp
+ * @brief Max segment tree over the largest free chunk of each block.
+ *
+ * This file defines the container-level free index: it remembers, for every block,
+ * the size of its largest free node, so a container can find a block that can
+ * serve a request without querying every block's RB-tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <new>
+
+#include "Block.hpp"
+
+namespace hh::halloc {
+
+/**
+ * @brief Max segment tree indexed by block number.
+ *
+ * Leaf i holds the largest free node size of block i (0 for full or missing
+ * blocks); every inner node holds the maximum of its children. Updating one block
+ * and finding the first block that can hold a request are both O(log capacity).
+ * The tree lives in memory obtained from mmap and is rebuilt at twice the width
+ * when reserve() asks for more blocks than it covers.
+ *
+ * @note Thread-safety: This class is NOT thread-safe
+ */
+class BlockFreeIndex {
+    std::size_t* tree;   ///< tree[1] is the root; leaf i is tree[leaves + i]
+    std::size_t leaves;  ///< Leaf level width (a power of two, 0 before reserve())
+
+    static std::size_t bytes_for(std::size_t width) { return 2 * width * sizeof(std::size_t); }
+
+public:
+    /// Returned by find_first() when no block can hold the request
+    static constexpr std::size_t NOT_FOUND = std::numeric_limits<std::size_t>::max();
+
+    /**
+     * @brief Constructor - creates an index covering no blocks.
+     */
+    BlockFreeIndex() : tree(nullptr), leaves(0) {}
+
+    BlockFreeIndex(const BlockFreeIndex&) = delete;
+    BlockFreeIndex& operator=(const BlockFreeIndex&) = delete;
+
+    /**
+     * @brief Destructor - releases the tree storage.
+     */
+    ~BlockFreeIndex() {
+        if (tree) {
+            RELEASE_MEMORY_VIA_MUNMAP(tree, bytes_for(leaves));
+        }
+    }
+
+    /**
+     * @brief Makes the index cover at least `capacity` blocks, keeping every entry.
+     *
+     * @param capacity Number of blocks to cover
+     * @throws std::bad_alloc if the new tree cannot be mapped
+     */
+    void reserve(std::size_t capacity) {
+        std::size_t width = std::bit_ceil(std::max<std::size_t>(capacity, 1));
+        if (width <= leaves) {
+            return;
+        }
+
+        void* memory = REQUEST_MEMORY_VIA_MMAP(bytes_for(width));
+        if (memory == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        // Copy the old leaves, then rebuild every inner node bottom-up
+        auto* grown = static_cast<std::size_t*>(memory);
+        std::copy(tree + leaves, tree + 2 * leaves, grown + width);
+        for (std::size_t node = width - 1; node > 0; node--) {
+            grown[node] = std::max(grown[2 * node], grown[2 * node + 1]);
+        }
+
+        if (tree) {
+            RELEASE_MEMORY_VIA_MUNMAP(tree, bytes_for(leaves));
+        }
+        tree = grown;
+        leaves = width;
+    }
+
+    /**
+     * @brief Records the largest free node size of a block.
+     *
+     * @param index Block index, below the capacity given to reserve()
+     * @param largest_free Size of the block's largest free node (0 if full)
+     */
+    void update(std::size_t index, std::size_t largest_free) {
+        std::size_t node = leaves + index;
+        if (tree[node] == largest_free) {
+            return;
+        }
+        tree[node] = largest_free;
+        for (node /= 2; node > 0; node /= 2) {
+            std::size_t larger = std::max(tree[2 * node], tree[2 * node + 1]);
+            if (tree[node] == larger) {
+                break;  // ancestors already hold the right maximum
+            }
+            tree[node] = larger;
+        }
+    }
+
+    /**
+     * @brief Finds the lowest-numbered block whose largest free node is >= bytes.
+     *
+     * @param bytes Requested size
+     * @return Block index, or NOT_FOUND if no block can hold the request
+     */
+    std::size_t find_first(std::size_t bytes) const {
+        if (largest() < bytes) {
+            return NOT_FOUND;
+        }
+
+        std::size_t node = 1;
+        while (node < leaves) {
+            node = tree[2 * node] >= bytes ? 2 * node : 2 * node + 1;
+        }
+        return node - leaves;
+    }
+
+    /**
+     * @brief Gets the largest free node size over all blocks.
+     */
+    std::size_t largest() const { return tree ? tree[1] : 0; }
+};
+}  // namespace hh::halloc
@@ -2,95 +2,205 @@
  * @file BlocksContainer.hpp
  * @brief Container managing multiple memory blocks for large-scale allocations.
  *
- * This file defines a template class that manages multiple Block instances to support
- * allocations beyond a single block's capacity. It provides automatic block creation
- * and best-fit search across all blocks.
+ * This file defines DynamicBlocksContainer, which manages a growable set of Block
+ * instances sized from a runtime ContainerConfig, and BlocksContainer, a fixed
+ * configuration of it chosen at compile time. Both provide automatic block
+ * creation and a container-level free index across all blocks.
  */
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <fstream>
 #include <limits>
 #include <utility>
 
 #include "Block.hpp"
+#include "BlockFreeIndex.hpp"
+#include "LargeMappingCache.hpp"
+#include "PageMap.hpp"
 
 namespace hh::halloc {
 
 /**
- * @brief Manages multiple memory blocks for scalable allocation.
+ * @brief Runtime geometry of a DynamicBlocksContainer.
  *
- * This template class provides a higher-level allocator that can create and manage
- * multiple Block instances. When an allocation cannot be satisfied by existing blocks,
- * a new block is created automatically (up to MaxNumBlocks limit).
+ * Blocks grow geometrically: the first block has initial_block_size bytes and each
+ * new block is growth_factor times larger than the previous one, up to
+ * max_block_size. Requests that no block of max_block_size could hold are served
+ * by the shared LargeMappingCache. Free chunks of at least purge_threshold bytes give
+ * their pages back to the OS once they have been free for purge_decay, so resident
+ * memory follows live memory rather than the peak (see PurgeConfig).
+ * A huge page backing rounds every block up to a multiple of HUGE_PAGE_SIZE.
  *
- * The container performs best-fit search across ALL blocks to minimize fragmentation.
+ * With reserve_block_size set, every block reserves that much address space but
+ * commits only its own size; when the blocks are full, the last block grows in place
+ * (by the next size of the growth sequence) before a new block is created.
  *
- * @tparam BlockSize Size of each memory block in bytes
- * @tparam MaxNumBlocks Maximum number of blocks allowed
+ * size_classes sets how every block rounds requests and splits chunks (see
+ * SizeClasses); the defaults round to MIN_ALIGNMENT.
+ */
+struct ContainerConfig {
+    std::size_t initial_block_size = 2 * 1024 * 1024;  ///< Size of the first block (2 MiB)
+    std::size_t max_block_size = 64 * 1024 * 1024;     ///< Cap on a single block (64 MiB)
+    std::size_t growth_factor = 2;  ///< Size ratio between consecutive blocks (>= 1)
+    std::size_t max_blocks = 0;     ///< Maximum number of blocks (0 = unlimited)
+    std::size_t purge_threshold = DEFAULT_PURGE_THRESHOLD;  ///< See Block (0 = never purge)
+    std::chrono::milliseconds purge_decay = DEFAULT_PURGE_DECAY;  ///< See Block (0 = at once)
+    PageBacking backing = PageBacking::Regular;             ///< Page backing of every block
+    std::size_t reserve_block_size = 0;  ///< Address space reserved per block (0 = none)
+    SizeClasses size_classes = SizeClasses{};  ///< Request rounding of every block
+};
+
+/**
+ * @brief Manages a growable set of memory blocks configured at runtime.
+ *
+ * When an allocation cannot be satisfied by existing blocks, a new block is created
+ * automatically. Block sizes follow the ContainerConfig growth policy, and the block
+ * table itself grows on demand, so there is no hard limit on the number of blocks
+ * unless max_blocks is set.
+ *
+ * A container-level free index tracks each block's largest free node, so allocation
+ * goes straight to the first block that can hold the request and performs a
+ * best-fit search in that block only.
  *
  * @note Thread-safety: This class is NOT thread-safe
- * @note Memory overhead: Maintains an array of Block objects
+ * @note Memory overhead: The block table and free index live in mmap'd memory and
+ *       double in capacity when full
  */
-template <std::size_t BlockSize, int MaxNumBlocks>
-class BlocksContainer {
-    Block blocks[MaxNumBlocks];  ///< Array of memory blocks
-    int current_block_index;     ///< Index of the last created block (-1 if none)
+class DynamicBlocksContainer {
+    ContainerConfig config;       ///< Geometry chosen at construction
+    Block* blocks;                ///< Block table (mmap'd, `capacity` slots)
+    std::size_t num_blocks;       ///< Number of initialized blocks
+    std::size_t capacity;         ///< Number of slots in the block table
+    std::size_t next_block_size;  ///< Size of the next block to create
+    PageMap page_map;             ///< Page -> owning block index + 1 (0 = not a block)
+    BlockFreeIndex free_index;    ///< Largest free node of every block
+
+    /**
+     * @brief Doubles the block table, moving the existing blocks into it.
+     * @throws std::bad_alloc if the new table cannot be mapped
+     */
+    void grow_table();
+
+    /**
+     * @brief Creates the next block, large enough for a chunk of `needed` bytes.
+     *
+     * The block gets the next size of the growth sequence, or `needed` rounded up to
+     * the page size if that is larger (never more than max_block_size). Its pages are
+     * tagged in the page map and it is entered into the free index.
+     *
+     * @param needed Bytes (header included) that the new block must be able to hold
+     * @return false if max_blocks blocks already exist
+     * @throws std::bad_alloc if the block cannot be mapped or tagged in the page map;
+     *         a block that was mapped but not tagged is unmapped again
+     * @pre needed <= config.max_block_size
+     */
+    bool create_block(std::size_t needed);
 
     /**
-     * @brief Finds the best-fit free node across all initialized blocks.
+     * @brief Commits more of the last block's reservation to fit a chunk of `needed` bytes.
      *
-     * Searches all created blocks for the smallest free node that can satisfy
-     * the requested size. This minimizes fragmentation compared to first-fit.
+     * The block grows by the next size of the growth sequence (at least `needed`,
+     * at most what is left of its reservation).
+     *
+     * @param needed Bytes (header included) that the grown part must be able to hold
+     * @return false if the last block has no reservation left for `needed` bytes
+     */
+    bool grow_last_block(std::size_t needed);
+
+    /**
+     * @brief Advances next_block_size by one step of the growth sequence.
+     */
+    void advance_block_size();
+
+    /**
+     * @brief Finds a free node for the request through the container's free index.
+     *
+     * The free index (a max segment tree over each block's largest free node) yields
+     * the first block that can hold the request; the best-fit node is then searched
+     * in that block only, so the cost is one RB-tree walk whatever the block count.
      *
      * @param bytes Requested allocation size (excluding metadata)
+     * @param alignment Required payload alignment (power of two)
      * @return Pair of (block_index, node_pointer)
-     *         - block_index: Index in blocks array (or MaxNumBlocks if not found)
+     *         - block_index: Index in blocks array (or max(size_t) if not found)
      *         - node_pointer: Pointer to best-fit MemoryNode (or nullptr if not found)
      *
      * @pre bytes > 0
-     * @post If found, 0 <= block_index < current_block_index
+     * @post If found, block_index < num_blocks
      * @post If found, node != nullptr and get_actual_value(node->value) >= bytes
      *
-     * @note Time complexity: O(MaxNumBlocks * log(nodes_per_block))
+     * @note Time complexity: O(log(num_blocks) + log(nodes_per_block))
      */
-    std::pair<std::size_t, MemoryNode*> best_fit(std::size_t bytes);
+    std::pair<std::size_t, MemoryNode*> best_fit(std::size_t bytes, std::size_t alignment);
 
 public:
     /**
-     * @brief Default constructor - initializes container with no blocks.
-     * @post current_block_index == -1 (no blocks created yet)
+     * @brief Constructor - creates the first block from the configuration.
+     *
+     * @param config Block geometry (defaults: 2 MiB blocks doubling up to 64 MiB)
+     * @throws std::invalid_argument if initial_block_size cannot hold a chunk,
+     *         max_block_size < initial_block_size, growth_factor == 0 or
+     *         size_classes is not valid
+     * @post get_num_blocks() == 1
      */
-    BlocksContainer();
+    explicit DynamicBlocksContainer(const ContainerConfig& config = ContainerConfig{});
+
+    DynamicBlocksContainer(const DynamicBlocksContainer&) = delete;
+    DynamicBlocksContainer& operator=(const DynamicBlocksContainer&) = delete;
+
+    /**
+     * @brief Destructor - releases every block and the block table.
+     */
+    ~DynamicBlocksContainer();
 
     /**
      * @brief Allocates memory from the container.
      *
      * Algorithm:
-     * 1. Search all existing blocks for best-fit node
+     * 1. Find the first block that can hold the request, and its best-fit node
      * 2. If found, allocate from that block
-     * 3. If not found and space available, create new block and allocate
-     * 4. If no space for new block, return nullptr (allocation failure)
+     * 3. If not found, grow the last block in place if it has reserved space left
+     * 4. Otherwise, if max_blocks allows it, create a new block and allocate
+     * 5. Otherwise (or if the request exceeds max_block_size) allocate a dedicated
+     *    mapping from the shared LargeMappingCache
      *
      * @param bytes Number of bytes to allocate
-     * @return Pointer to allocated memory, or nullptr if allocation fails
+     * @return Pointer to allocated memory
+     * @throws std::invalid_argument if bytes == 0
      *
-     * @pre bytes > 0
      * @post If successful, returned pointer is valid and points to usable memory
-     * @post If unsuccessful (nullptr), no blocks were modified
-     *
-     * @note Fails if bytes > BlockSize or current_block_index >= MaxNumBlocks
      */
     void* allocate(std::size_t bytes);
 
+    /**
+     * @brief Allocates memory whose address is a multiple of `alignment`.
+     *
+     * Same algorithm as allocate(), but candidate nodes must be able to hold the
+     * request at an aligned address (see Block::best_fit_aligned). Requests served by
+     * the LargeMappingCache are aligned by over-mapping and trimming.
+     *
+     * @param bytes Number of bytes to allocate
+     * @param alignment Power-of-two alignment; values <= MIN_ALIGNMENT behave like allocate()
+     * @return Pointer to allocated memory aligned to `alignment`
+     * @throws std::invalid_argument if bytes == 0 or alignment is not a power of two
+     *
+     * @note Release with deallocate(ptr, bytes) like any other allocation
+     */
+    void* allocate_aligned(std::size_t bytes, std::size_t alignment);
+
     /**
      * @brief Deallocates previously allocated memory.
      *
-     * Determines which block owns the memory pointer and delegates deallocation
+     * Looks up the owning block in the page map (O(1)) and delegates deallocation
      * to that block. The block will merge adjacent free nodes automatically.
      *
      * @param ptr Pointer previously returned by allocate()
-     * @param bytes Size of the allocation (used to determine owning block)
+     * @param bytes Size of the allocation (unused for large mappings, whose size is
+     *              recorded by the LargeMappingCache)
      *
      * @pre ptr != nullptr
      * @pre ptr was returned by this container's allocate()
@@ -102,195 +212,152 @@ public:
     void deallocate(void* ptr, std::size_t bytes);
 
     /**
-     * @brief Logs the current state of the container to a file.
+     * @brief Allocates `count` chunks of `bytes` bytes each.
+     *
+     * Chunks are carved back to back from as few free nodes as possible (see
+     * Block::allocate_batch), starting with the first block that can hold the whole
+     * batch, so the cost per chunk is a split rather than a full best-fit search.
+     * When no block has room left, one chunk is allocated through allocate() (which
+     * grows the container) and carving resumes from there.
      *
-     * @param logfile_dir Directory to write the log file
+     * @param bytes Size of each chunk in bytes
+     * @param count Number of chunks
+     * @param out Receives the `count` pointers
+     * @throws std::invalid_argument if bytes == 0
+     *
+     * @note Release the chunks with deallocate() or deallocate_batch()
      */
-    void log_container_state(std::ofstream& logfile) const;
-};
-}  // namespace hh::halloc
-
-namespace hh::halloc {
-/**
- * @brief Helper function to extract actual size from encoded value.
- *
- * Removes the color and status bits (bits 62-63) from the encoded value
- * to get the actual size in bytes.
- *
- * @param value Encoded value with color and status bits
- * @return Actual size in bytes (bits 0-61)
- */
-inline std::size_t get_actual_value(std::size_t value) {
-    return value & ~(3ull << 62);
-}
+    void allocate_batch(std::size_t bytes, std::size_t count, void** out);
 
-/**
- * @brief Finds the best-fit free node across all initialized blocks.
- *
- * Iterates through all created blocks (0 to current_block_index) and finds
- * the smallest free node that can satisfy the requested size.
- *
- * Algorithm:
- * 1. Initialize best_size to maximum (worst fit)
- * 2. For each block:
- *    a. Call block's best_fit()
- *    b. If found and smaller than current best, update best node
- * 3. Return (block_index, node_pointer)
- *
- * @tparam BlockSize Size of each memory block
- * @tparam MaxNumBlocks Maximum number of blocks
- * @param bytes Requested allocation size
- * @return Pair (block_index, node_pointer)
- *         - If found: block_index in [0, current_block_index], node != nullptr
- *         - If not found: block_index == max(size_t), node == nullptr
- */
-template <std::size_t BlockSize, int MaxNumBlocks>
-std::pair<std::size_t, MemoryNode*> BlocksContainer<BlockSize, MaxNumBlocks>::best_fit(
-    std::size_t bytes) {
-    std::size_t best_block_index = std::numeric_limits<std::size_t>::max();
-    std::size_t best_size = std::numeric_limits<std::size_t>::max();
-    MemoryNode* best_node = nullptr;
+    /**
+     * @brief Deallocates `count` chunks of `bytes` bytes each.
+     *
+     * The pointers are sorted by address, which groups them by owning block; each
+     * block then frees its group in one pass, merging neighbouring chunks before
+     * they enter the RB-tree (see Block::deallocate_batch).
+     *
+     * @param ptrs Pointers returned by this container (reordered by the call)
+     * @param count Number of pointers
+     * @param bytes Size of each allocation
+     */
+    void deallocate_batch(void** ptrs, std::size_t count, std::size_t bytes);
 
-    // Search all initialized blocks
-    for (int i = 0; i <= current_block_index; i++) {
-        MemoryNode* node = blocks[i].best_fit(bytes);
-        if (node) {
-            std::size_t node_size = get_actual_value(node->value);
-            // Track smallest fit
-            if (node_size < best_size) {
-                best_node = node;
-                best_size = node_size;
-                best_block_index = i;
-            }
-        }
-    }
+    /**
+     * @brief Resizes an allocation without moving it.
+     *
+     * Block chunks grow into a free next chunk or shrink by splitting off their tail
+     * (see Block::try_expand); large mappings are resized with mremap.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_bytes Current size of the allocation
+     * @param new_bytes Requested size
+     * @return true if ptr now holds new_bytes bytes; false if nothing changed
+     * @throws std::invalid_argument if new_bytes == 0
+     *
+     * @post On success, release with deallocate(ptr, new_bytes)
+     */
+    bool try_expand(void* ptr, std::size_t old_bytes, std::size_t new_bytes);
 
-    return {best_block_index, best_node};
-}
+    /**
+     * @brief Resizes an allocation, moving it only when it cannot be resized in place.
+     *
+     * Algorithm:
+     * 1. try_expand()
+     * 2. Large mappings are moved by the kernel with mremap, without copying
+     * 3. Otherwise allocate new_bytes, copy min(old_bytes, new_bytes) bytes and
+     *    free the old allocation
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_bytes Current size of the allocation
+     * @param new_bytes Requested size
+     * @return Pointer to the resized allocation (MIN_ALIGNMENT-aligned, like allocate())
+     * @throws std::invalid_argument if new_bytes == 0
+     */
+    void* reallocate(void* ptr, std::size_t old_bytes, std::size_t new_bytes);
 
-/**
- * @brief Constructor - creates container with one initial block.
- *
- * Initializes the container by creating the first block of size BlockSize.
- * Additional blocks are created on-demand during allocation.
- *
- * @tparam BlockSize Size of each memory block
- * @tparam MaxNumBlocks Maximum number of blocks
- * @post current_block_index == 0
- * @post blocks[0] is initialized with BlockSize bytes
- */
-template <std::size_t BlockSize, int MaxNumBlocks>
-BlocksContainer<BlockSize, MaxNumBlocks>::BlocksContainer() {
-    current_block_index = 0;
-    blocks[current_block_index] = std::move(Block(BlockSize));
-}
+    /**
+     * @brief Gets the number of initialized blocks.
+     * @return Number of blocks created so far (at least 1)
+     */
+    std::size_t get_num_blocks() const { return num_blocks; }
 
-/**
- * @brief Allocates memory from the container.
- *
- * Algorithm:
- * 1. Search all blocks for best-fit node
- * 2. If found:
- *    a. Allocate from that block
- * 3. If not found:
- *    a. Check if we can create a new block (current_block_index + 1 < MaxNumBlocks)
- *    b. If yes: create new block, find best-fit in new block, allocate
- *    c. If no: We allocate via mmap, and return the pointer to the allocated memory
- *
- * @tparam BlockSize Size of each memory block
- * @tparam MaxNumBlocks Maximum number of blocks
- * @param bytes Number of bytes to allocate
- * @return Pointer to allocated memory, or nullptr if allocation fails
- *
- * @note Allocation fails if:
- *       - bytes > BlockSize (too large for any block)
- *       - All blocks full and current_block_index + 1 >= MaxNumBlocks
- */
-template <std::size_t BlockSize, int MaxNumBlocks>
-void* BlocksContainer<BlockSize, MaxNumBlocks>::allocate(std::size_t bytes) {
-    if (bytes < 1) {
-        throw std::invalid_argument("Bytes must be positive");
-    }
+    /**
+     * @brief Gets the first address of an initialized block.
+     * @param index Block index in [0, get_num_blocks())
+     * @return Pointer to the block's head node
+     */
+    void* get_block_head(std::size_t index) const { return blocks[index].get_head(); }
 
-    auto [index, node] = best_fit(bytes);
+    /**
+     * @brief Gets the size of an initialized block.
+     * @param index Block index in [0, get_num_blocks())
+     * @return Number of bytes the block spans from get_block_head(index)
+     */
+    std::size_t get_block_size(std::size_t index) const { return blocks[index].get_size(); }
 
-    // No suitable node found in existing blocks
-    if (index == std::numeric_limits<std::size_t>::max()) {
-        // Try to create a new block
-        if (current_block_index + 1 < MaxNumBlocks) {
-            current_block_index++;
-            blocks[current_block_index] = std::move(Block(BlockSize));
-            index = current_block_index;
-            node = blocks[index].best_fit(bytes);
-        }
+    /**
+     * @brief Gets the address space reserved for an initialized block.
+     * @param index Block index in [0, get_num_blocks())
+     * @return Number of bytes reserved from get_block_head(index) (>= get_block_size())
+     */
+    std::size_t get_block_reserved_size(std::size_t index) const {
+        return blocks[index].get_reserved_size();
     }
 
     /**
-     * @brief The updated allocation logic here:
-     * use mmap to allocate memory directly if no suitable block is found
-     * then when deallocate, if the address of the node needed for allocation not included in the
-     * block, we try to munmap it.
+     * @brief Gets the configuration the container was created with.
      */
-    if (!node) {
-        return REQUEST_MEMORY_VIA_MMAP(bytes);
-    }
+    const ContainerConfig& get_config() const { return config; }
 
-    // Allocate from the selected block
-    return blocks[index].allocate(bytes, node);
-}
+    /**
+     * @brief Logs the current state of the container to a file.
+     *
+     * @param logfile Output stream to write the log to
+     */
+    void log_container_state(std::ofstream& logfile) const;
+};
 
 /**
- * @brief Deallocates memory by finding the owning block.
+ * @brief DynamicBlocksContainer with a fixed geometry chosen at compile time.
  *
- * Searches through blocks to find which one owns the given pointer,
- * then delegates deallocation to that block.
+ * Every block has BlockSize bytes and at most MaxNumBlocks blocks are created;
+ * requests beyond that are served by the LargeMappingCache.
  *
- * Algorithm:
- * 1. For each block i in [0, current_block_index]:
- *    a. Check if blocks[i].head <= ptr < blocks[i+1].head
- *    b. If yes, call blocks[i].deallocate()
- *
- * @tparam BlockSize Size of each memory block
- * @tparam MaxNumBlocks Maximum number of blocks
- * @param ptr Pointer to deallocate
- * @param bytes Size of allocation (for block compatibility)
- *
- * @pre ptr was allocated by this container
- * @post Memory is freed and merged with adjacent free blocks
+ * @tparam BlockSize Size of each memory block in bytes
+ * @tparam MaxNumBlocks Maximum number of blocks allowed
  *
- * @warning Undefined behavior if ptr was not allocated by this container MAY CAUSE SEGFAULT
+ * @note Thread-safety: This class is NOT thread-safe
  */
 template <std::size_t BlockSize, int MaxNumBlocks>
-void BlocksContainer<BlockSize, MaxNumBlocks>::deallocate(void* ptr, std::size_t bytes) {
-    // Find which block owns this pointer
-    for (int i = 0; i <= current_block_index; i++) {
-        // Check if ptr is within block i's address range
-        void* block_start = blocks[i].get_head();
-        void* block_end = (char*)block_start + BlockSize;
-
-        if (block_start <= ptr && ptr < block_end) {
-            blocks[i].deallocate(ptr, bytes);
-            return;
-        }
-    }
+class BlocksContainer : public DynamicBlocksContainer {
+public:
+    /**
+     * @brief Default constructor - creates the first block of BlockSize bytes.
+     * @post get_num_blocks() == 1
+     */
+    BlocksContainer() : BlocksContainer(PurgeConfig{}) {}
 
     /**
-     * @brief updated deallocation logic here:
-     *  we try to munmap the memory directly if the address of the node needed for deallocation
+     * @brief Constructor - creates the first block, purging free pages as configured.
+     * @param purge When free chunks return their pages to the OS
+     * @post get_num_blocks() == 1
      */
-    RELEASE_MEMORY_VIA_MUNMAP(ptr, bytes);
-}
+    explicit BlocksContainer(const PurgeConfig& purge)
+        : DynamicBlocksContainer(ContainerConfig{BlockSize, BlockSize, 1,
+                                                 static_cast<std::size_t>(MaxNumBlocks),
+                                                 purge.threshold, purge.decay}) {}
+};
 
-template <std::size_t BlockSize, int MaxNumBlocks>
-void BlocksContainer<BlockSize, MaxNumBlocks>::log_container_state(std::ofstream& logfile) const {
-    logfile << "=================================================\n";
-    logfile << "BlocksContainer State:\n";
-    logfile << "Total Blocks: " << (current_block_index + 1) << "\n";
-    for (int i = 0; i <= current_block_index; i++) {
-        logfile << "---------------- Block " << i << " ----------------\n";
-        blocks[i].log_block_state(logfile);
-        logfile << "---------------- End Block " << i << " ----------------\n";
-    }
-    logfile << "=================================================\n\n";
+/**
+ * @brief Helper function to extract actual size from encoded value.
+ *
+ * Removes the color and status bits (bits 62-63) from the encoded value
+ * to get the actual size in bytes.
+ *
+ * @param value Encoded value with color and status bits
+ * @return Actual size in bytes (bits 0-61)
+ */
+inline std::size_t get_actual_value(std::size_t value) {
+    return value & ~(3ull << 62);
 }
-};  // namespace hh::halloc
\ No newline at end of file
+};  // namespace hh::halloc
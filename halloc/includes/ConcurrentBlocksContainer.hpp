@@ -0,0 +1,515 @@
+/**
+ * @file ConcurrentBlocksContainer.hpp
+ * @brief Thread-safe multi-block container with one lock per memory block.
+ *
+ * This file defines a concurrent variant of BlocksContainer. Every Block is guarded
+ * by its own mutex, so threads working on different blocks never wait on each other.
+ * Allocation probes blocks with try_lock and moves on to the next block instead of
+ * spinning on a busy one.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include "Block.hpp"
+#include "LargeMappingCache.hpp"
+#include "PageMap.hpp"
+
+namespace hh::halloc {
+
+/**
+ * @brief Thread-safe container managing multiple blocks with per-block locking.
+ *
+ * Blocks are created on demand (up to MaxNumBlocks) and published through an atomic
+ * block count; a published block's pages are tagged in a lock-free page map, so
+ * finding the owner of a pointer needs no lock and no scan. Only the owning block
+ * is locked while its RB-tree and boundary tags are modified.
+ *
+ * Allocation strategy:
+ * 1. Starting at the block that last served the calling thread, try_lock each
+ *    published block and allocate from the first one with a fitting free node
+ *    (best-fit within that block)
+ * 2. If some blocks were skipped because they were busy, wait for those only
+ * 3. Otherwise create a new block (serialized by a growth mutex)
+ * 4. If no block can be created, fall back to the LargeMappingCache like BlocksContainer
+ *
+ * Running out of memory is reported with nullptr rather than an exception, so that
+ * nothing is thrown while the growth mutex is held: when the container backs
+ * malloc, allocating the exception would re-enter it and wait on that mutex.
+ *
+ * @tparam BlockSize Size of each memory block in bytes
+ * @tparam MaxNumBlocks Maximum number of blocks allowed
+ *
+ * @note Thread-safety: allocate/deallocate may be called concurrently from any thread
+ * @note Unlike BlocksContainer, best-fit is applied per block, not across all blocks,
+ *       so that an allocation holds at most one block lock at a time
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+class ConcurrentBlocksContainer {
+    /**
+     * @brief A block and its lock, padded to a cache line to avoid false sharing.
+     */
+    struct alignas(64) LockedBlock {
+        std::mutex lock;  ///< Guards block
+        Block block;      ///< The memory block
+    };
+
+    LockedBlock slots[MaxNumBlocks];  ///< Blocks with their locks
+    std::atomic<int> num_blocks;      ///< Number of published (initialized) blocks
+    std::mutex growth_lock;           ///< Serializes block creation
+    PageMap page_map;                 ///< Page -> owning block index + 1 (0 = not a block)
+    PurgeConfig purge;                ///< Purge policy of every block
+
+    /**
+     * @brief Creates slots[index].block and tags its pages in the page map.
+     * @pre The block is not published yet (or the caller holds growth_lock)
+     * @return true on success; false if the block or its page map nodes cannot be
+     *         mapped, in which case nothing changes
+     */
+    bool create_block(int index) noexcept;
+
+    /**
+     * @brief Returns the calling thread's preferred starting block index.
+     *
+     * Spreads threads over blocks initially, then remembers the last block that
+     * served the thread.
+     */
+    static std::size_t& thread_hint();
+
+    /**
+     * @brief Allocates from a block whose lock is already held.
+     * @return Pointer to allocated memory, or nullptr if the block has no fitting node
+     */
+    static void* allocate_locked(Block& block, std::size_t bytes, std::size_t alignment);
+
+    /**
+     * @brief Creates a new block and allocates from it.
+     * @pre bytes fits in an empty block
+     * @return Pointer to allocated memory, or nullptr if the block count changed since
+     *         seen_blocks was read, MaxNumBlocks is reached or the block cannot be created
+     */
+    void* allocate_from_new_block(std::size_t bytes, std::size_t alignment, int seen_blocks);
+
+public:
+    /**
+     * @brief Default constructor - creates the first block.
+     * @throws std::bad_alloc if the first block cannot be mapped
+     * @post One block of size BlockSize is published
+     */
+    ConcurrentBlocksContainer() : ConcurrentBlocksContainer(PurgeConfig{}) {}
+
+    /**
+     * @brief Constructor - creates the first block, purging free pages as configured.
+     * @param purge When free chunks return their pages to the OS
+     * @throws std::bad_alloc if the first block cannot be mapped
+     * @post One block of size BlockSize is published
+     */
+    explicit ConcurrentBlocksContainer(const PurgeConfig& purge);
+
+    ConcurrentBlocksContainer(const ConcurrentBlocksContainer&) = delete;
+    ConcurrentBlocksContainer& operator=(const ConcurrentBlocksContainer&) = delete;
+
+    /**
+     * @brief Allocates memory, locking only the block that serves the request.
+     *
+     * @param bytes Number of bytes to allocate
+     * @return Pointer to allocated memory, or nullptr if no memory is left
+     * @throws std::invalid_argument if bytes == 0
+     */
+    void* allocate(std::size_t bytes);
+
+    /**
+     * @brief Allocates memory aligned to `alignment`, locking only the serving block.
+     *
+     * @param bytes Number of bytes to allocate
+     * @param alignment Power-of-two alignment; values <= MIN_ALIGNMENT behave like allocate()
+     * @return Pointer to allocated memory aligned to `alignment`, or nullptr if no
+     *         memory is left
+     * @throws std::invalid_argument if bytes == 0 or alignment is not a power of two
+     */
+    void* allocate_aligned(std::size_t bytes, std::size_t alignment);
+
+    /**
+     * @brief Deallocates memory, locking only the owning block.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param bytes Size of the allocation (unused for large mappings)
+     */
+    void deallocate(void* ptr, std::size_t bytes);
+
+    /**
+     * @brief Allocates `count` chunks of `bytes` bytes, locking each block once.
+     *
+     * Every free block is carved in turn (see Block::allocate_batch); chunks that no
+     * block can provide without waiting go through allocate().
+     *
+     * @param bytes Size of each chunk in bytes
+     * @param count Number of chunks
+     * @param out Receives the `count` pointers
+     * @throws std::invalid_argument if bytes == 0
+     * @throws std::bad_alloc if no memory is left (no lock is held when thrown)
+     */
+    void allocate_batch(std::size_t bytes, std::size_t count, void** out);
+
+    /**
+     * @brief Deallocates `count` chunks, locking each owning block once.
+     *
+     * @param ptrs Pointers returned by this container (reordered by the call)
+     * @param count Number of pointers
+     * @param bytes Size of each allocation
+     */
+    void deallocate_batch(void** ptrs, std::size_t count, std::size_t bytes);
+
+    /**
+     * @brief Resizes an allocation in place, locking only the owning block.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_bytes Current size of the allocation
+     * @param new_bytes Requested size
+     * @return true if ptr now holds new_bytes bytes; false if nothing changed
+     * @throws std::invalid_argument if new_bytes == 0
+     */
+    bool try_expand(void* ptr, std::size_t old_bytes, std::size_t new_bytes);
+
+    /**
+     * @brief Resizes an allocation, moving it only when it cannot be resized in place.
+     *
+     * Large mappings move with mremap; block chunks are copied into a new allocation.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_bytes Current size of the allocation
+     * @param new_bytes Requested size
+     * @return Pointer to the resized allocation, or nullptr if no memory is left for
+     *         a moved block chunk (ptr is then untouched)
+     * @throws std::invalid_argument if new_bytes == 0
+     * @throws std::bad_alloc if a large mapping cannot be moved
+     */
+    void* reallocate(void* ptr, std::size_t old_bytes, std::size_t new_bytes);
+
+    /**
+     * @brief Logs the current state of the container to a file.
+     *
+     * Each block is locked while it is logged.
+     *
+     * @param logfile Output stream to write the log to
+     */
+    void log_container_state(std::ofstream& logfile);
+};
+}  // namespace hh::halloc
+
+namespace hh::halloc {
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+std::size_t& ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::thread_hint() {
+    thread_local std::size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return hint;
+}
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+void* ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::allocate_locked(
+    Block& block, std::size_t bytes, std::size_t alignment) {
+    MemoryNode* node = block.best_fit_aligned(bytes, alignment);
+    if (!node) {
+        return nullptr;
+    }
+    return block.allocate_aligned(bytes, alignment, node);
+}
+
+/**
+ * @brief Creates and publishes a new block, serving the request from it.
+ *
+ * If another thread published blocks since the caller last looked (or the limit
+ * is reached), nothing is created and nullptr is returned so the caller retries.
+ * A block that cannot be mapped also yields nullptr, with the count unchanged.
+ * The new block is used before it is published, so no lock is needed on it.
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void* ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::allocate_from_new_block(
+    std::size_t bytes, std::size_t alignment, int seen_blocks) {
+    std::lock_guard<std::mutex> growth(growth_lock);
+
+    int count = num_blocks.load(std::memory_order_acquire);
+    if (count != seen_blocks || count >= MaxNumBlocks) {
+        return nullptr;
+    }
+
+    if (!create_block(count)) {
+        return nullptr;
+    }
+    void* ptr = allocate_locked(slots[count].block, bytes, alignment);
+    num_blocks.store(count + 1, std::memory_order_release);
+    thread_hint() = count;
+    return ptr;
+}
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+bool ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::create_block(int index) noexcept {
+    Block block(std::nothrow, BlockSize, purge.threshold, PageBacking::Regular, 0, SizeClasses{},
+                purge.decay);
+    if (!block.get_head() || !page_map.try_set_range(block.get_head(), BlockSize,
+                                                     static_cast<std::uintptr_t>(index) + 1)) {
+        return false;
+    }
+    slots[index].block = std::move(block);
+    return true;
+}
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::ConcurrentBlocksContainer(
+    const PurgeConfig& purge)
+    : num_blocks(0), purge(purge) {
+    if (!create_block(0)) {
+        throw std::bad_alloc();
+    }
+    num_blocks.store(1, std::memory_order_release);
+}
+
+/**
+ * @brief Allocates memory from the first block that can serve the request.
+ *
+ * Algorithm:
+ * 1. Requests larger than an empty block go straight to the LargeMappingCache
+ * 2. try_lock every published block, starting at the thread's hint; busy blocks
+ *    are skipped, not waited on
+ * 3. If busy blocks were skipped, lock them one at a time and retry
+ * 4. Create a new block if allowed (retrying step 2 if another thread grew first)
+ * 5. Fall back to the LargeMappingCache, or return nullptr if it cannot map either
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void* ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::allocate(std::size_t bytes) {
+    return allocate_aligned(bytes, MIN_ALIGNMENT);
+}
+
+/**
+ * @brief Allocates aligned memory; allocate() is this with MIN_ALIGNMENT.
+ *
+ * Over-aligned requests reserve room for the worst-case padding when deciding
+ * whether an empty block could hold them at all.
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void* ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::allocate_aligned(
+    std::size_t bytes, std::size_t alignment) {
+    if (bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        throw std::invalid_argument("Alignment must be a power of two");
+    }
+
+    // Requests that not even an empty block can hold get a dedicated mapping
+    std::size_t worst_padding =
+        alignment > MIN_ALIGNMENT ? alignment + MEMORY_NODE_SIZE + MIN_CHUNK_PAYLOAD : 0;
+    if (bytes + worst_padding + MEMORY_NODE_SIZE > BlockSize) {
+        return LargeMappingCache::instance().allocate(bytes, alignment, std::nothrow);
+    }
+
+    while (true) {
+        int count = num_blocks.load(std::memory_order_acquire);
+        std::size_t start = thread_hint() % count;
+        bool skipped[MaxNumBlocks] = {};
+        bool any_skipped = false;
+
+        for (int i = 0; i < count; i++) {
+            std::size_t index = (start + i) % count;
+            if (!slots[index].lock.try_lock()) {
+                skipped[index] = true;
+                any_skipped = true;
+                continue;
+            }
+            void* ptr = allocate_locked(slots[index].block, bytes, alignment);
+            slots[index].lock.unlock();
+            if (ptr) {
+                thread_hint() = index;
+                return ptr;
+            }
+        }
+
+        if (any_skipped) {
+            for (int index = 0; index < count; index++) {
+                if (!skipped[index]) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(slots[index].lock);
+                void* ptr = allocate_locked(slots[index].block, bytes, alignment);
+                if (ptr) {
+                    thread_hint() = index;
+                    return ptr;
+                }
+            }
+        }
+
+        if (count >= MaxNumBlocks) {
+            break;
+        }
+
+        void* ptr = allocate_from_new_block(bytes, alignment, count);
+        if (ptr) {
+            return ptr;
+        }
+        if (num_blocks.load(std::memory_order_acquire) == count) {
+            break;  // No other thread grew, so the block could not be mapped
+        }
+    }
+
+    return LargeMappingCache::instance().allocate(bytes, alignment, std::nothrow);
+}
+
+/**
+ * @brief Deallocates memory by locking only the block that owns it.
+ *
+ * Published blocks never move, so the owner is found in the page map without any
+ * lock. Pointers owned by no block are large mappings and go back to the
+ * LargeMappingCache.
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::deallocate(void* ptr,
+                                                                    std::size_t bytes) {
+    std::uintptr_t owner = page_map.get(ptr);
+    if (owner) {
+        std::lock_guard<std::mutex> lock(slots[owner - 1].lock);
+        slots[owner - 1].block.deallocate(ptr, bytes);
+        return;
+    }
+
+    LargeMappingCache::instance().deallocate(ptr);
+}
+
+/**
+ * @brief Carves the batch out of every block that is free to lock.
+ *
+ * Algorithm:
+ * 1. try_lock each published block, starting at the thread's hint, and carve as
+ *    many chunks from it as it can give
+ * 2. If chunks are still missing, allocate one through allocate() (which waits on
+ *    busy blocks or creates a new one) and go back to step 1
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::allocate_batch(std::size_t bytes,
+                                                                        std::size_t count,
+                                                                        void** out) {
+    if (bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+
+    std::size_t done = 0;
+    while (done < count) {
+        int blocks = num_blocks.load(std::memory_order_acquire);
+        std::size_t start = thread_hint() % blocks;
+        for (int i = 0; i < blocks && done < count; i++) {
+            std::size_t index = (start + i) % blocks;
+            if (!slots[index].lock.try_lock()) {
+                continue;
+            }
+            std::size_t carved = slots[index].block.allocate_batch(bytes, count - done, out + done);
+            slots[index].lock.unlock();
+            if (carved) {
+                thread_hint() = index;
+                done += carved;
+            }
+        }
+
+        if (done < count) {
+            void* ptr = allocate(bytes);
+            if (!ptr) {
+                throw std::bad_alloc();
+            }
+            out[done++] = ptr;
+        }
+    }
+}
+
+/**
+ * @brief Sorts the pointers and frees each block's share under one lock acquisition.
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::deallocate_batch(
+    void** ptrs, std::size_t count, [[maybe_unused]] std::size_t bytes) {
+    std::sort(ptrs, ptrs + count, std::less<void*>());
+
+    std::size_t i = 0;
+    while (i < count) {
+        std::uintptr_t owner = page_map.get(ptrs[i]);
+        if (!owner) {
+            LargeMappingCache::instance().deallocate(ptrs[i++]);
+            continue;
+        }
+
+        std::size_t end = i + 1;
+        while (end < count && page_map.get(ptrs[end]) == owner) {
+            end++;
+        }
+        std::lock_guard<std::mutex> lock(slots[owner - 1].lock);
+        slots[owner - 1].block.deallocate_batch(ptrs + i, end - i);
+        i = end;
+    }
+}
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+bool ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::try_expand(
+    void* ptr, [[maybe_unused]] std::size_t old_bytes, std::size_t new_bytes) {
+    if (new_bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+
+    std::uintptr_t owner = page_map.get(ptr);
+    if (owner) {
+        std::lock_guard<std::mutex> lock(slots[owner - 1].lock);
+        return slots[owner - 1].block.try_expand(ptr, new_bytes);
+    }
+
+    return LargeMappingCache::instance().try_expand(ptr, new_bytes);
+}
+
+/**
+ * @brief Resizes in place, or moves the allocation without holding two block locks.
+ *
+ * The new chunk is allocated (locking its block) before the old one is freed
+ * (locking the owner), so at most one block lock is held at a time.
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void* ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::reallocate(void* ptr,
+                                                                     std::size_t old_bytes,
+                                                                     std::size_t new_bytes) {
+    if (try_expand(ptr, old_bytes, new_bytes)) {
+        return ptr;
+    }
+    if (!page_map.get(ptr)) {
+        return LargeMappingCache::instance().reallocate(ptr, new_bytes);
+    }
+
+    void* moved = allocate(new_bytes);
+    if (!moved) {
+        return nullptr;
+    }
+    std::memcpy(moved, ptr, std::min(old_bytes, new_bytes));
+    deallocate(ptr, old_bytes);
+    return moved;
+}
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+void ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>::log_container_state(
+    std::ofstream& logfile) {
+    int count = num_blocks.load(std::memory_order_acquire);
+    logfile << "=================================================\n";
+    logfile << "ConcurrentBlocksContainer State:\n";
+    logfile << "Total Blocks: " << count << "\n";
+    for (int i = 0; i < count; i++) {
+        std::lock_guard<std::mutex> lock(slots[i].lock);
+        logfile << "---------------- Block " << i << " ----------------\n";
+        slots[i].block.log_block_state(logfile);
+        logfile << "---------------- End Block " << i << " ----------------\n";
+    }
+    logfile << "=================================================\n\n";
+}
+}  // namespace hh::halloc
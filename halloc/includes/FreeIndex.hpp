@@ -0,0 +1,746 @@
+/**
+ * @file FreeIndex.hpp
+ * @brief Policies indexing the free chunks of a Block.
+ *
+ * A Block asks its free index for a free chunk of at least a given size and for
+ * its largest free chunk, and keeps it up to date as chunks are split and merged.
+ * Four policies implement the same interface:
+ * - RBTreeIndex: Red-Black tree ordered by size, strict best fit in O(log n)
+ * - AddressOrderedIndex: Red-Black tree ordered by (size, address), best fit that
+ *   prefers the lowest address among equal sizes
+ * - TlsfIndex: two-level segregated fit, good fit in O(1) through two bitmaps
+ * - SegregatedFitIndex: one free list per power-of-two size class, first fit
+ *   within the class and O(1) fallback to larger classes
+ *
+ * Besides insert(), remove(), find_fit() and max(), every policy offers rekey(),
+ * which hands a chunk's index entry to a chunk that took over its memory with a
+ * new size (the remainder of a split, or a merged chunk). The tree policies keep
+ * the entry in place when the order allows it instead of rebalancing twice.
+ *
+ * Every policy keeps its links in the node's left/right/parent (and twins) fields,
+ * which a free chunk stores in its payload, so no policy needs memory of its own per
+ * chunk.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "RBTreeDriver.hpp"
+
+namespace hh::halloc {
+/**
+ * @brief Extracts the size of a free index node (bits 0-61 of its value).
+ *
+ * @tparam T Node type with a value field encoded like MemoryNode::value
+ */
+template <typename T>
+constexpr std::size_t free_index_size(const T* node) {
+    return node->value & ~(3ull << 62);
+}
+
+/**
+ * @brief Free index keeping chunks in a Red-Black tree ordered by size.
+ *
+ * The tree holds one node per distinct free size. Further free chunks of a size
+ * already in the tree are chained behind its node in a LIFO list instead of being
+ * inserted as duplicates, so the tree stays as small as the number of distinct
+ * sizes and only the first and last chunk of a size touch it:
+ * - a chained chunk has parent == itself, left = previous chunk in the chain (the
+ *   tree node for the first one) and right = next chunk in the chain
+ * - the tree node's twins field holds the first chunk of its chain
+ *
+ * find_fit() returns the smallest size that fits (best fit), preferring the most
+ * recently freed chunk of that size, in O(log n). Inserting or removing a chunk
+ * whose size has other free chunks is O(1); otherwise it is an O(log n) tree
+ * operation. max() is O(1), and a request larger than the maximum fails in O(1)
+ * without walking the tree.
+ *
+ * @tparam T Node type (must have fields: value, left, right, parent, twins)
+ *
+ * @note This class is move-only (no copy constructor/assignment)
+ */
+template <typename T>
+class RBTreeIndex {
+    RBTreeDriver<T> tree;  ///< One free chunk per distinct size, ordered by size
+
+    /**
+     * @brief Gets the first chunk chained behind a tree node, or nullptr.
+     */
+    static T* twins_of(const T* node) { return reinterpret_cast<T*>(node->twins); }
+
+    /**
+     * @brief Sets the first chunk chained behind a tree node.
+     */
+    static void set_twins(T* node, T* first) {
+        node->twins = reinterpret_cast<std::uintptr_t>(first);
+    }
+
+    /**
+     * @brief Checks whether a chunk is chained behind a tree node (not in the tree).
+     */
+    static bool is_chained(const T* node) { return node->parent == node; }
+
+public:
+    /**
+     * @brief Inserts a free chunk.
+     * @pre node is not in the index
+     */
+    void insert(T* node);
+
+    /**
+     * @brief Removes a free chunk.
+     * @pre node is in the index and its size has not changed since insert()
+     */
+    void remove(T* node);
+
+    /**
+     * @brief Hands a free chunk's entry to a chunk with a new header and/or size.
+     * @param node Chunk in the index, size unchanged since insert()
+     * @param new_node node itself, or a chunk not in the index
+     * @param new_size Size new_node is indexed under
+     * @post new_node->value holds new_size as a free chunk; node is no longer in
+     *       the index unless it is new_node
+     */
+    void rekey(T* node, T* new_node, std::size_t new_size);
+
+    /**
+     * @brief Finds the smallest free chunk holding at least `bytes` bytes.
+     * @return Best-fit chunk (the last one freed among equal sizes), or nullptr if no
+     *         chunk is large enough
+     */
+    T* find_fit(std::size_t bytes) {
+        T* top = tree.max();
+        if (!top || free_index_size(top) < bytes) {
+            return nullptr;
+        }
+
+        T* node = tree.lower_bound(bytes);
+        if (node && node->twins) {
+            return twins_of(node);
+        }
+        return node;
+    }
+
+    /**
+     * @brief Finds the largest free chunk.
+     * @return Largest chunk, or nullptr if the index is empty
+     */
+    T* max() const { return tree.max(); }
+};
+
+/**
+ * @brief Orders free index nodes by size, then by address.
+ */
+struct SizeThenAddressLess {
+    template <typename T>
+    bool operator()(const T* a, const T* b) const {
+        std::size_t size_a = free_index_size(a);
+        std::size_t size_b = free_index_size(b);
+        return size_a != size_b ? size_a < size_b : a < b;
+    }
+};
+
+/**
+ * @brief Free index keeping chunks in a Red-Black tree ordered by (size, address).
+ *
+ * Address-ordered best fit: find_fit() returns the lowest-addressed chunk among
+ * the smallest ones that fit, so allocations pack towards the start of the block
+ * and the free space at its end stays in large pieces. Every free chunk is a tree
+ * node (no chaining of equal sizes, which would lose the address order), so
+ * insert(), remove() and find_fit() are all O(log n); max() is O(1).
+ *
+ * @tparam T Node type (must have fields: value, left, right, parent)
+ *
+ * @note This class is move-only (no copy constructor/assignment)
+ */
+template <typename T>
+class AddressOrderedIndex {
+    RBTreeDriver<T, SizeThenAddressLess> tree;  ///< Free chunks ordered by (size, address)
+
+public:
+    /**
+     * @brief Inserts a free chunk.
+     * @pre node is not in the index
+     */
+    void insert(T* node) { tree.insert(node); }
+
+    /**
+     * @brief Removes a free chunk.
+     * @pre node is in the index and its size has not changed since insert()
+     */
+    void remove(T* node) { tree.remove(node); }
+
+    /**
+     * @brief Hands a free chunk's entry to a chunk with a new header and/or size.
+     * @param node Chunk in the index, size unchanged since insert()
+     * @param new_node node itself, or a chunk not in the index
+     * @param new_size Size new_node is indexed under
+     * @post new_node->value holds new_size as a free chunk; node is no longer in
+     *       the index unless it is new_node
+     * @note The replaced entry is re-keyed with update_key(), which moves it only if
+     *       the new size or address changed its order
+     */
+    void rekey(T* node, T* new_node, std::size_t new_size) {
+        if (new_node != node) {
+            tree.replace(node, new_node);
+        }
+        tree.update_key(new_node, new_size);
+    }
+
+    /**
+     * @brief Finds the lowest-addressed of the smallest free chunks holding `bytes` bytes.
+     * @return Best-fit chunk, or nullptr if no chunk is large enough
+     *
+     * @note The leftmost node with size >= bytes is, among nodes of its size, the one
+     *       with the lowest address
+     */
+    T* find_fit(std::size_t bytes) {
+        T* top = tree.max();
+        if (!top || free_index_size(top) < bytes) {
+            return nullptr;
+        }
+        return tree.lower_bound(bytes);
+    }
+
+    /**
+     * @brief Finds the largest free chunk.
+     * @return Largest chunk, or nullptr if the index is empty
+     */
+    T* max() const { return tree.max(); }
+};
+
+/**
+ * @brief Two-level segregated fit (TLSF) free index.
+ *
+ * Sizes are split into first-level classes by their highest set bit and each
+ * class into 2^SL_BITS second-level lists of equal width; sizes below SMALL_LIMIT
+ * share first-level class 0 in lists 16 bytes wide. One bitmap tells which
+ * first-level classes are not empty and one bitmap per class which of its lists
+ * are not empty, so find_fit(), insert() and remove() are O(1).
+ *
+ * find_fit() rounds the request up to the next list boundary, so any chunk of the
+ * list it picks fits without looking at it (good fit rather than best fit). When
+ * that finds nothing, it scans the request's own list, so a chunk that fits is
+ * never missed and the Block only falls back to another block when no chunk fits.
+ *
+ * @tparam T Node type (must have fields: value, left, right)
+ *
+ * @note Lists are LIFO; left links to the previous chunk, right to the next one
+ * @note max() scans the top non-empty list, which is short unless many chunks of
+ *       nearly the same large size are free
+ */
+template <typename T>
+class TlsfIndex {
+public:
+    static constexpr std::size_t SL_BITS = 4;                    ///< log2 of lists per class
+    static constexpr std::size_t SL_COUNT = 1 << SL_BITS;       ///< Lists per class
+    static constexpr std::size_t SMALL_SHIFT = SL_BITS + 4;      ///< 16-byte lists below
+    static constexpr std::size_t SMALL_LIMIT = 1 << SMALL_SHIFT;  ///< 256 bytes
+    static constexpr std::size_t FL_COUNT = 48 - SMALL_SHIFT + 1;  ///< Covers sizes < 2^48
+
+private:
+    std::uint64_t fl_bitmap;                 ///< Bit fl set iff class fl has a chunk
+    std::uint32_t sl_bitmap[FL_COUNT];       ///< Bit sl set iff list (fl, sl) has a chunk
+    T* lists[FL_COUNT][SL_COUNT];            ///< Heads of the free lists
+
+    /**
+     * @brief Maps a size to its first- and second-level list.
+     */
+    static void mapping(std::size_t size, std::size_t& fl, std::size_t& sl);
+
+    /**
+     * @brief Finds the first non-empty list at or after (fl, sl).
+     * @return false if every such list is empty
+     */
+    bool next_list(std::size_t& fl, std::size_t& sl) const;
+
+    /**
+     * @brief Clears every list.
+     */
+    void clear();
+
+public:
+    /**
+     * @brief Default constructor - creates an empty index.
+     */
+    TlsfIndex() { clear(); }
+
+    TlsfIndex(const TlsfIndex&) = delete;
+    TlsfIndex& operator=(const TlsfIndex&) = delete;
+
+    /**
+     * @brief Move constructor - takes over the lists, leaving other empty.
+     */
+    TlsfIndex(TlsfIndex&& other) { *this = std::move(other); }
+
+    /**
+     * @brief Move assignment - takes over the lists, leaving other empty.
+     */
+    TlsfIndex& operator=(TlsfIndex&& other);
+
+    /**
+     * @brief Inserts a free chunk at the front of its list.
+     * @pre node is not in the index
+     */
+    void insert(T* node);
+
+    /**
+     * @brief Removes a free chunk.
+     * @pre node is in the index and its size has not changed since insert()
+     */
+    void remove(T* node);
+
+    /**
+     * @brief Hands a free chunk's entry to a chunk with a new header and/or size.
+     * @param node Chunk in the index, size unchanged since insert()
+     * @param new_node node itself, or a chunk not in the index
+     * @param new_size Size new_node is indexed under
+     * @post new_node->value holds new_size as a free chunk; node is no longer in
+     *       the index unless it is new_node
+     */
+    void rekey(T* node, T* new_node, std::size_t new_size) {
+        remove(node);
+        new_node->value = new_size;
+        insert(new_node);
+    }
+
+    /**
+     * @brief Finds a free chunk holding at least `bytes` bytes.
+     * @return A chunk that fits, or nullptr if no chunk is large enough
+     */
+    T* find_fit(std::size_t bytes);
+
+    /**
+     * @brief Finds the largest free chunk.
+     * @return Largest chunk, or nullptr if the index is empty
+     */
+    T* max() const;
+};
+
+/**
+ * @brief Segregated free lists, one per power-of-two size class.
+ *
+ * A chunk of size s is kept in list floor(log2(s)). find_fit() first scans the
+ * request's own class for a chunk that fits, then takes the head of the next
+ * non-empty larger class, which always fits, through a bitmap. insert() and
+ * remove() are O(1).
+ *
+ * @tparam T Node type (must have fields: value, left, right)
+ *
+ * @note Lists are LIFO; left links to the previous chunk, right to the next one
+ */
+template <typename T>
+class SegregatedFitIndex {
+public:
+    static constexpr std::size_t CLASS_COUNT = 64;  ///< One class per bit of a size
+
+private:
+    std::uint64_t bitmap;       ///< Bit c set iff class c has a chunk
+    T* lists[CLASS_COUNT];      ///< Heads of the free lists
+
+    /**
+     * @brief Maps a size to its class.
+     */
+    static std::size_t size_class(std::size_t size) {
+        return static_cast<std::size_t>(std::bit_width(size | 1)) - 1;
+    }
+
+    /**
+     * @brief Clears every list.
+     */
+    void clear();
+
+public:
+    /**
+     * @brief Default constructor - creates an empty index.
+     */
+    SegregatedFitIndex() { clear(); }
+
+    SegregatedFitIndex(const SegregatedFitIndex&) = delete;
+    SegregatedFitIndex& operator=(const SegregatedFitIndex&) = delete;
+
+    /**
+     * @brief Move constructor - takes over the lists, leaving other empty.
+     */
+    SegregatedFitIndex(SegregatedFitIndex&& other) { *this = std::move(other); }
+
+    /**
+     * @brief Move assignment - takes over the lists, leaving other empty.
+     */
+    SegregatedFitIndex& operator=(SegregatedFitIndex&& other);
+
+    /**
+     * @brief Inserts a free chunk at the front of its class list.
+     * @pre node is not in the index
+     */
+    void insert(T* node);
+
+    /**
+     * @brief Removes a free chunk.
+     * @pre node is in the index and its size has not changed since insert()
+     */
+    void remove(T* node);
+
+    /**
+     * @brief Hands a free chunk's entry to a chunk with a new header and/or size.
+     * @param node Chunk in the index, size unchanged since insert()
+     * @param new_node node itself, or a chunk not in the index
+     * @param new_size Size new_node is indexed under
+     * @post new_node->value holds new_size as a free chunk; node is no longer in
+     *       the index unless it is new_node
+     */
+    void rekey(T* node, T* new_node, std::size_t new_size) {
+        remove(node);
+        new_node->value = new_size;
+        insert(new_node);
+    }
+
+    /**
+     * @brief Finds a free chunk holding at least `bytes` bytes.
+     * @return A chunk that fits, or nullptr if no chunk is large enough
+     */
+    T* find_fit(std::size_t bytes);
+
+    /**
+     * @brief Finds the largest free chunk.
+     * @return Largest chunk, or nullptr if the index is empty
+     */
+    T* max() const;
+};
+
+/**
+ * @brief Unlinks a node from a doubly-linked free list (left = prev, right = next).
+ */
+template <typename T>
+void unlink_free_list_node(T*& head, T* node) {
+    if (node->left) {
+        node->left->right = node->right;
+    } else {
+        head = node->right;
+    }
+    if (node->right) {
+        node->right->left = node->left;
+    }
+}
+
+/**
+ * @brief Pushes a node onto the front of a doubly-linked free list.
+ */
+template <typename T>
+void push_free_list_node(T*& head, T* node) {
+    node->left = nullptr;
+    node->right = head;
+    if (head) {
+        head->left = node;
+    }
+    head = node;
+}
+
+/**
+ * @brief Finds the largest node of a free list.
+ */
+template <typename T>
+T* max_free_list_node(T* head) {
+    T* best = head;
+    for (T* node = head; node; node = node->right) {
+        if (free_index_size(node) > free_index_size(best)) {
+            best = node;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Finds the first node of a free list holding at least `bytes` bytes.
+ */
+template <typename T>
+T* first_fit_free_list_node(T* head, std::size_t bytes) {
+    for (T* node = head; node; node = node->right) {
+        if (free_index_size(node) >= bytes) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+}  // namespace hh::halloc
+
+namespace hh::halloc {
+
+// ==================== RBTreeIndex ====================
+
+/**
+ * @brief Chains the chunk behind the tree node of its size, or inserts it into the tree.
+ *
+ * The tree has no duplicates, so lower_bound of the chunk's size finds the node of
+ * that size if there is one.
+ */
+template <typename T>
+void RBTreeIndex<T>::insert(T* node) {
+    std::size_t size = free_index_size(node);
+    T* twin = tree.lower_bound(size);
+    if (!twin || free_index_size(twin) != size) {
+        node->twins = 0;
+        tree.insert(node);
+        return;
+    }
+
+    T* first = twins_of(twin);
+    node->parent = node;
+    node->left = twin;
+    node->right = first;
+    if (first) {
+        first->left = node;
+    }
+    set_twins(twin, node);
+}
+
+/**
+ * @brief Unlinks a chained chunk in O(1), or takes a tree node out of the tree.
+ *
+ * A tree node with chained chunks is not removed from the tree: the first chunk of
+ * its chain takes its place (same size, so the order is unchanged) and inherits
+ * the rest of the chain.
+ */
+template <typename T>
+void RBTreeIndex<T>::remove(T* node) {
+    if (is_chained(node)) {
+        T* prev = node->left;
+        T* next = node->right;
+        if (next) {
+            next->left = prev;
+        }
+        if (is_chained(prev)) {
+            prev->right = next;
+        } else {
+            set_twins(prev, next);
+        }
+        return;
+    }
+
+    T* first = twins_of(node);
+    if (!first) {
+        tree.remove(node);
+        return;
+    }
+
+    T* rest = first->right;
+    tree.replace(node, first);
+    set_twins(first, rest);
+    if (rest) {
+        rest->left = first;
+    }
+}
+
+/**
+ * @brief Keeps a lone tree node's place when its new size allows it.
+ *
+ * A tree node without chained chunks whose new size stays strictly between the
+ * sizes of its neighbours is re-keyed in place (an equal size has to be chained
+ * instead). Anything else is a remove() followed by an insert().
+ */
+template <typename T>
+void RBTreeIndex<T>::rekey(T* node, T* new_node, std::size_t new_size) {
+    if (!is_chained(node) && !node->twins) {
+        T* prev = hh::rb_tree::predecessor(node);
+        T* next = hh::rb_tree::successor(node);
+        if ((!prev || free_index_size(prev) < new_size) &&
+            (!next || new_size < free_index_size(next))) {
+            if (new_node != node) {
+                tree.replace(node, new_node);
+                new_node->twins = 0;
+            }
+            tree.update_key(new_node, new_size);
+            return;
+        }
+    }
+
+    remove(node);
+    new_node->value = new_size;
+    insert(new_node);
+}
+
+// ==================== TlsfIndex ====================
+
+/**
+ * @brief Maps a size to its TLSF list.
+ *
+ * Sizes below SMALL_LIMIT go to class 0, list size / 16. Larger sizes go to class
+ * msb - SMALL_SHIFT + 1 and to the list given by the SL_BITS bits after the
+ * highest set bit. Sizes past the last class share its last list.
+ */
+template <typename T>
+void TlsfIndex<T>::mapping(std::size_t size, std::size_t& fl, std::size_t& sl) {
+    if (size < SMALL_LIMIT) {
+        fl = 0;
+        sl = size >> (SMALL_SHIFT - SL_BITS);
+        return;
+    }
+
+    std::size_t msb = static_cast<std::size_t>(std::bit_width(size)) - 1;
+    fl = msb - SMALL_SHIFT + 1;
+    sl = (size >> (msb - SL_BITS)) & (SL_COUNT - 1);
+    if (fl >= FL_COUNT) {
+        fl = FL_COUNT - 1;
+        sl = SL_COUNT - 1;
+    }
+}
+
+template <typename T>
+bool TlsfIndex<T>::next_list(std::size_t& fl, std::size_t& sl) const {
+    std::uint32_t sl_map = sl < SL_COUNT ? sl_bitmap[fl] & (~0u << sl) : 0;
+    if (!sl_map) {
+        std::uint64_t fl_map = fl + 1 < FL_COUNT ? fl_bitmap & (~0ull << (fl + 1)) : 0;
+        if (!fl_map) {
+            return false;
+        }
+        fl = static_cast<std::size_t>(std::countr_zero(fl_map));
+        sl_map = sl_bitmap[fl];
+    }
+    sl = static_cast<std::size_t>(std::countr_zero(sl_map));
+    return true;
+}
+
+template <typename T>
+void TlsfIndex<T>::clear() {
+    fl_bitmap = 0;
+    for (std::size_t fl = 0; fl < FL_COUNT; fl++) {
+        sl_bitmap[fl] = 0;
+        for (std::size_t sl = 0; sl < SL_COUNT; sl++) {
+            lists[fl][sl] = nullptr;
+        }
+    }
+}
+
+template <typename T>
+TlsfIndex<T>& TlsfIndex<T>::operator=(TlsfIndex&& other) {
+    if (this != &other) {
+        fl_bitmap = other.fl_bitmap;
+        for (std::size_t fl = 0; fl < FL_COUNT; fl++) {
+            sl_bitmap[fl] = other.sl_bitmap[fl];
+            for (std::size_t sl = 0; sl < SL_COUNT; sl++) {
+                lists[fl][sl] = other.lists[fl][sl];
+            }
+        }
+        other.clear();
+    }
+    return *this;
+}
+
+template <typename T>
+void TlsfIndex<T>::insert(T* node) {
+    std::size_t fl, sl;
+    mapping(free_index_size(node), fl, sl);
+    push_free_list_node(lists[fl][sl], node);
+    fl_bitmap |= 1ull << fl;
+    sl_bitmap[fl] |= 1u << sl;
+}
+
+template <typename T>
+void TlsfIndex<T>::remove(T* node) {
+    std::size_t fl, sl;
+    mapping(free_index_size(node), fl, sl);
+    unlink_free_list_node(lists[fl][sl], node);
+    if (!lists[fl][sl]) {
+        sl_bitmap[fl] &= ~(1u << sl);
+        if (!sl_bitmap[fl]) {
+            fl_bitmap &= ~(1ull << fl);
+        }
+    }
+}
+
+/**
+ * @brief Finds a chunk that fits, in O(1) unless only the request's own list has one.
+ *
+ * Algorithm:
+ * 1. Round the request up by the width of its list minus one, so that every chunk
+ *    of the list the rounded size maps to is at least as large as the request
+ * 2. Take the head of the first non-empty list from there on
+ * 3. Otherwise first-fit scan the request's own list, whose chunks may or may not fit
+ */
+template <typename T>
+T* TlsfIndex<T>::find_fit(std::size_t bytes) {
+    std::size_t width = bytes < SMALL_LIMIT
+                            ? std::size_t{1} << (SMALL_SHIFT - SL_BITS)
+                            : std::size_t{1} << (std::bit_width(bytes) - 1 - SL_BITS);
+
+    std::size_t fl, sl;
+    mapping(bytes + width - 1, fl, sl);
+    if (next_list(fl, sl)) {
+        return lists[fl][sl];
+    }
+
+    mapping(bytes, fl, sl);
+    return first_fit_free_list_node(lists[fl][sl], bytes);
+}
+
+template <typename T>
+T* TlsfIndex<T>::max() const {
+    if (!fl_bitmap) {
+        return nullptr;
+    }
+    std::size_t fl = static_cast<std::size_t>(std::bit_width(fl_bitmap)) - 1;
+    std::size_t sl = static_cast<std::size_t>(std::bit_width(sl_bitmap[fl])) - 1;
+    return max_free_list_node(lists[fl][sl]);
+}
+
+// ==================== SegregatedFitIndex ====================
+
+template <typename T>
+void SegregatedFitIndex<T>::clear() {
+    bitmap = 0;
+    for (std::size_t c = 0; c < CLASS_COUNT; c++) {
+        lists[c] = nullptr;
+    }
+}
+
+template <typename T>
+SegregatedFitIndex<T>& SegregatedFitIndex<T>::operator=(SegregatedFitIndex&& other) {
+    if (this != &other) {
+        bitmap = other.bitmap;
+        for (std::size_t c = 0; c < CLASS_COUNT; c++) {
+            lists[c] = other.lists[c];
+        }
+        other.clear();
+    }
+    return *this;
+}
+
+template <typename T>
+void SegregatedFitIndex<T>::insert(T* node) {
+    std::size_t c = size_class(free_index_size(node));
+    push_free_list_node(lists[c], node);
+    bitmap |= 1ull << c;
+}
+
+template <typename T>
+void SegregatedFitIndex<T>::remove(T* node) {
+    std::size_t c = size_class(free_index_size(node));
+    unlink_free_list_node(lists[c], node);
+    if (!lists[c]) {
+        bitmap &= ~(1ull << c);
+    }
+}
+
+template <typename T>
+T* SegregatedFitIndex<T>::find_fit(std::size_t bytes) {
+    std::size_t c = size_class(bytes);
+    if (T* node = first_fit_free_list_node(lists[c], bytes)) {
+        return node;
+    }
+
+    std::uint64_t larger = c + 1 < CLASS_COUNT ? bitmap & (~0ull << (c + 1)) : 0;
+    return larger ? lists[std::countr_zero(larger)] : nullptr;
+}
+
+template <typename T>
+T* SegregatedFitIndex<T>::max() const {
+    if (!bitmap) {
+        return nullptr;
+    }
+    return max_free_list_node(lists[std::bit_width(bitmap) - 1]);
+}
+}  // namespace hh::halloc
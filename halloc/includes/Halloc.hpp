@@ -13,13 +13,20 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <fstream>
 #include <memory>
 
 #include "BlocksContainer.hpp"
+#include "ConcurrentBlocksContainer.hpp"
+#include "PerCpuBlocksContainer.hpp"
+#include "SlabContainer.hpp"
+#include "ThreadCache.hpp"
 
-const int DEFAULT_BLOCK_SIZE = (128 * 1024 * 1024);  ///< Default block size: 128 MB
-const int DEFAULT_MAX_NUM_BLOCKS = 1;                ///< Default max blocks: 1
+const std::size_t DEFAULT_BLOCK_SIZE = (128 * 1024 * 1024);  ///< Default block size: 128 MB
+const int DEFAULT_MAX_NUM_BLOCKS = 1;                        ///< Default max blocks: 1
 
 namespace hh::halloc {
 /**
@@ -34,20 +41,23 @@ namespace hh::halloc {
  * - O(log n) allocation and deallocation (Red-Black tree)
  * - Automatic block coalescing (merges adjacent free blocks)
  * - Automatic block creation up to MaxNumBlocks limit
- * - Thread-unsafe (caller must synchronize)
+ * - Thread-unsafe with the default container (caller must synchronize);
+ *   see CachedHalloc, ConcurrentHalloc and PerCpuHalloc for thread-safe variants
  *
  * @tparam T Type of objects to allocate (default: void for raw bytes)
  * @tparam BlockSize Size of each memory block in bytes (default: 256 MB)
  * @tparam MaxNumBlocks Maximum number of blocks (default: 4)
+ * @tparam Container Container that serves the raw allocations
+ *                   (default: BlocksContainer<BlockSize, MaxNumBlocks>)
  *
  * @note Compatible with STL containers via std::allocator_traits
  */
-template <typename T = void, int BlockSize = DEFAULT_BLOCK_SIZE,
-          int MaxNumBlocks = DEFAULT_MAX_NUM_BLOCKS>
+template <typename T = void, std::size_t BlockSize = DEFAULT_BLOCK_SIZE,
+          int MaxNumBlocks = DEFAULT_MAX_NUM_BLOCKS,
+          typename Container = BlocksContainer<BlockSize, MaxNumBlocks>>
 class Halloc {
     // Use shared_ptr so allocator can be copied (required by STL containers)
-    std::shared_ptr<BlocksContainer<BlockSize, MaxNumBlocks>>
-        blocks;  ///< Underlying multi-block container
+    std::shared_ptr<Container> blocks;  ///< Underlying multi-block container
 
 public:
     // ==================== C++ Allocator Requirements ====================
@@ -68,7 +78,7 @@ public:
      */
     template <typename U>
     struct rebind {
-        using other = Halloc<U, BlockSize, MaxNumBlocks>;
+        using other = Halloc<U, BlockSize, MaxNumBlocks, Container>;
     };
 
     /**
@@ -77,6 +87,28 @@ public:
      */
     Halloc();
 
+    /**
+     * @brief Constructor - creates allocator with a runtime-configured container.
+     *
+     * Only available when Container is constructible from a ContainerConfig
+     * (e.g. DynamicBlocksContainer, see DynamicHalloc).
+     *
+     * @param config Block geometry of the new container
+     * @post blocks contains one initialized block of config.initial_block_size bytes
+     */
+    explicit Halloc(const ContainerConfig& config);
+
+    /**
+     * @brief Constructor - creates allocator whose blocks purge free pages as configured.
+     *
+     * Only available when Container is constructible from a PurgeConfig (e.g.
+     * BlocksContainer, ConcurrentBlocksContainer, PerCpuBlocksContainer).
+     *
+     * @param purge When free chunks return their pages to the OS
+     * @post blocks contains one initialized block of size BlockSize
+     */
+    explicit Halloc(const PurgeConfig& purge);
+
     /**
      * @brief Copy constructor - shares underlying BlocksContainer.
      * @param other Allocator to copy from
@@ -94,7 +126,7 @@ public:
      * @param other Allocator of different type to copy from
      */
     template <typename U>
-    Halloc(const Halloc<U, BlockSize, MaxNumBlocks>& other) : blocks(other.blocks) {}
+    Halloc(const Halloc<U, BlockSize, MaxNumBlocks, Container>& other) : blocks(other.blocks) {}
 
     /**
      * @brief Assignment operator.
@@ -107,7 +139,7 @@ public:
     }
 
     // Allow rebind copy constructor to access private members
-    template <typename U, int BS, int MNB>
+    template <typename U, std::size_t BS, int MNB, typename C>
     friend class Halloc;
 
     /**
@@ -127,9 +159,24 @@ public:
      *       - count * sizeof(T) > BlockSize
      *       - All blocks full and MaxNumBlocks reached
      * @note Does NOT construct objects (use placement new if needed)
+     * @note Over-aligned types (alignof(T) > MIN_ALIGNMENT) are allocated through
+     *       the container's allocate_aligned() automatically
      */
     T* allocate(std::size_t count);
 
+    /**
+     * @brief Allocates memory for 'count' objects at a caller-chosen alignment.
+     *
+     * Useful for SIMD buffers or cache-line isolated storage of types whose own
+     * alignment is smaller than required. Release with deallocate(ptr, count).
+     *
+     * @param count Number of objects to allocate space for
+     * @param alignment Power-of-two alignment (alignof(T) is used if larger)
+     * @return Pointer to allocated memory aligned to max(alignment, alignof(T))
+     * @throws std::invalid_argument if alignment is not a power of two
+     */
+    T* allocate_aligned(std::size_t count, std::size_t alignment);
+
     /**
      * @brief Deallocates memory previously allocated for 'count' objects.
      *
@@ -149,6 +196,61 @@ public:
      */
     void deallocate(T* ptr, std::size_t count);
 
+    /**
+     * @brief Allocates `n` separate arrays of 'count' objects each in one call.
+     *
+     * The arrays are carved back to back from as few free nodes as possible, so
+     * the per-array cost is a split rather than a full best-fit search.
+     *
+     * @param count Number of objects in each array
+     * @param n Number of arrays
+     * @param out Receives the `n` pointers
+     *
+     * @note Release each array with deallocate(ptr, count), or all of them with
+     *       deallocate_batch()
+     */
+    void allocate_batch(std::size_t count, std::size_t n, T** out);
+
+    /**
+     * @brief Deallocates `n` arrays of 'count' objects each in one call.
+     *
+     * The pointers are sorted by address and freed block by block; arrays that are
+     * neighbours in memory are merged before they enter the free tree.
+     *
+     * @param ptrs Pointers previously returned by this allocator (reordered by the call)
+     * @param n Number of pointers
+     * @param count Number of objects in each array (must match the allocation)
+     */
+    void deallocate_batch(T** ptrs, std::size_t n, std::size_t count);
+
+    /**
+     * @brief Resizes an allocation without moving it.
+     *
+     * Grows into free memory right after the allocation, or shrinks by returning
+     * its tail to the container. Large mappings are resized with mremap.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_count Number of objects the allocation currently holds
+     * @param new_count Number of objects it should hold
+     * @return true if ptr now holds new_count objects (release it with
+     *         deallocate(ptr, new_count)); false if nothing changed
+     */
+    bool try_expand(T* ptr, std::size_t old_count, std::size_t new_count);
+
+    /**
+     * @brief Resizes an allocation, moving it only when it cannot be resized in place.
+     *
+     * When the allocation moves, its first min(old_count, new_count) objects are
+     * copied bytewise (large mappings are moved by the kernel without a copy), so
+     * T should be trivially copyable. The old pointer is invalid afterwards.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_count Number of objects the allocation currently holds
+     * @param new_count Number of objects it should hold
+     * @return Pointer to the resized allocation
+     */
+    T* reallocate(T* ptr, std::size_t old_count, std::size_t new_count);
+
     /**
      * @brief Equality comparison - checks if allocators share same container.
      *
@@ -193,6 +295,81 @@ public:
         logfile.close();
     }
 };
+
+/**
+ * @brief Halloc over a growable container whose geometry is chosen at runtime.
+ *
+ * Blocks start small and grow geometrically (2 MiB doubling up to 64 MiB by
+ * default) with no hard block limit; pass a ContainerConfig to the constructor to
+ * choose another geometry. See DynamicBlocksContainer.
+ *
+ * @tparam T Type of objects to allocate
+ */
+template <typename T = void>
+using DynamicHalloc = Halloc<T, 0, 0, DynamicBlocksContainer>;
+
+/**
+ * @brief Thread-safe Halloc with per-thread caches of recently freed chunks.
+ *
+ * Small allocate/deallocate pairs are served from the calling thread's cache
+ * without locking; refills and flushes reach the shared BlocksContainer in batches
+ * under a single mutex. See ThreadCachedContainer.
+ *
+ * @tparam T Type of objects to allocate
+ * @tparam BlockSize Size of each memory block in bytes
+ * @tparam MaxNumBlocks Maximum number of blocks
+ */
+template <typename T = void, std::size_t BlockSize = DEFAULT_BLOCK_SIZE,
+          int MaxNumBlocks = DEFAULT_MAX_NUM_BLOCKS>
+using CachedHalloc = Halloc<T, BlockSize, MaxNumBlocks,
+                            ThreadCachedContainer<BlocksContainer<BlockSize, MaxNumBlocks>>>;
+
+/**
+ * @brief Thread-safe Halloc that locks each memory block separately.
+ *
+ * Threads served by different blocks never wait on each other. See
+ * ConcurrentBlocksContainer.
+ *
+ * @tparam T Type of objects to allocate
+ * @tparam BlockSize Size of each memory block in bytes
+ * @tparam MaxNumBlocks Maximum number of blocks
+ */
+template <typename T = void, std::size_t BlockSize = DEFAULT_BLOCK_SIZE,
+          int MaxNumBlocks = DEFAULT_MAX_NUM_BLOCKS>
+using ConcurrentHalloc =
+    Halloc<T, BlockSize, MaxNumBlocks, ConcurrentBlocksContainer<BlockSize, MaxNumBlocks>>;
+
+/**
+ * @brief Thread-safe Halloc with one arena per CPU.
+ *
+ * Each allocation locks only the arena of the CPU the thread runs on, so
+ * contention scales with core count rather than thread count. See
+ * PerCpuBlocksContainer.
+ *
+ * @tparam T Type of objects to allocate
+ * @tparam BlockSize Size of each memory block in bytes
+ * @tparam MaxNumBlocks Maximum number of blocks per arena
+ */
+template <typename T = void, std::size_t BlockSize = DEFAULT_BLOCK_SIZE,
+          int MaxNumBlocks = DEFAULT_MAX_NUM_BLOCKS>
+using PerCpuHalloc =
+    Halloc<T, BlockSize, MaxNumBlocks, PerCpuBlocksContainer<BlockSize, MaxNumBlocks>>;
+
+/**
+ * @brief Halloc serving objects of up to SLAB_MAX_SIZE bytes from slab pages.
+ *
+ * Small objects are packed into size-classed pages with a free bitmap instead of a
+ * chunk header each; larger ones come from the BlocksContainer. Suited to node-based
+ * containers. Not thread-safe. See SlabContainer.
+ *
+ * @tparam T Type of objects to allocate
+ * @tparam BlockSize Size of each memory block in bytes
+ * @tparam MaxNumBlocks Maximum number of blocks
+ */
+template <typename T = void, std::size_t BlockSize = DEFAULT_BLOCK_SIZE,
+          int MaxNumBlocks = DEFAULT_MAX_NUM_BLOCKS>
+using SlabHalloc =
+    Halloc<T, BlockSize, MaxNumBlocks, SlabContainer<BlocksContainer<BlockSize, MaxNumBlocks>>>;
 }  // namespace hh::halloc
 
 namespace hh::halloc {
@@ -206,14 +383,23 @@ namespace hh::halloc {
  * @tparam T Type of objects to allocate
  * @tparam BlockSize Size of each block in bytes
  * @tparam MaxNumBlocks Maximum number of blocks
+ * @tparam Container Container that serves the raw allocations
  * @post blocks points to a new BlocksContainer with one block of size BlockSize
  */
-template <typename T, int BlockSize, int MaxNumBlocks>
-Halloc<T, BlockSize, MaxNumBlocks>::Halloc()
-    : blocks(std::make_shared<BlocksContainer<BlockSize, MaxNumBlocks>>()) {
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+Halloc<T, BlockSize, MaxNumBlocks, Container>::Halloc()
+    : blocks(std::make_shared<Container>()) {
     // BlocksContainer constructor handles initialization
 }
 
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+Halloc<T, BlockSize, MaxNumBlocks, Container>::Halloc(const ContainerConfig& config)
+    : blocks(std::make_shared<Container>(config)) {}
+
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+Halloc<T, BlockSize, MaxNumBlocks, Container>::Halloc(const PurgeConfig& purge)
+    : blocks(std::make_shared<Container>(purge)) {}
+
 /**
  * @brief Allocates memory for 'count' objects of type T.
  *
@@ -229,9 +415,20 @@ Halloc<T, BlockSize, MaxNumBlocks>::Halloc()
  *
  * @note Does NOT call constructors - caller must use placement new
  */
-template <typename T, int BlockSize, int MaxNumBlocks>
-T* Halloc<T, BlockSize, MaxNumBlocks>::allocate(std::size_t count) {
-    return static_cast<T*>(blocks->allocate(count * sizeof(T)));
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+T* Halloc<T, BlockSize, MaxNumBlocks, Container>::allocate(std::size_t count) {
+    if constexpr (alignof(T) > MIN_ALIGNMENT) {
+        return static_cast<T*>(blocks->allocate_aligned(count * sizeof(T), alignof(T)));
+    } else {
+        return static_cast<T*>(blocks->allocate(count * sizeof(T)));
+    }
+}
+
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+T* Halloc<T, BlockSize, MaxNumBlocks, Container>::allocate_aligned(std::size_t count,
+                                                                   std::size_t alignment) {
+    return static_cast<T*>(
+        blocks->allocate_aligned(count * sizeof(T), std::max(alignment, alignof(T))));
 }
 
 /**
@@ -249,11 +446,66 @@ T* Halloc<T, BlockSize, MaxNumBlocks>::allocate(std::size_t count) {
  *
  * @note Does NOT call destructors - caller must destroy objects manually
  */
-template <typename T, int BlockSize, int MaxNumBlocks>
-void Halloc<T, BlockSize, MaxNumBlocks>::deallocate(T* ptr, std::size_t count) {
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+void Halloc<T, BlockSize, MaxNumBlocks, Container>::deallocate(T* ptr, std::size_t count) {
     blocks->deallocate(ptr, count * sizeof(T));
 }
 
+/**
+ * @brief Batch allocation through the container; over-aligned types fall back to
+ *        allocate(), since batches are carved at MIN_ALIGNMENT.
+ */
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+void Halloc<T, BlockSize, MaxNumBlocks, Container>::allocate_batch(std::size_t count,
+                                                                   std::size_t n, T** out) {
+    if constexpr (alignof(T) > MIN_ALIGNMENT) {
+        for (std::size_t i = 0; i < n; i++) {
+            out[i] = allocate(count);
+        }
+    } else {
+        blocks->allocate_batch(count * sizeof(T), n, reinterpret_cast<void**>(out));
+    }
+}
+
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+void Halloc<T, BlockSize, MaxNumBlocks, Container>::deallocate_batch(T** ptrs, std::size_t n,
+                                                                     std::size_t count) {
+    blocks->deallocate_batch(reinterpret_cast<void**>(ptrs), n, count * sizeof(T));
+}
+
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+bool Halloc<T, BlockSize, MaxNumBlocks, Container>::try_expand(T* ptr, std::size_t old_count,
+                                                               std::size_t new_count) {
+    return blocks->try_expand(ptr, old_count * sizeof(T), new_count * sizeof(T));
+}
+
+/**
+ * @brief Resizes through the container, which knows how to move each kind of memory.
+ *
+ * The container's reallocate() only guarantees MIN_ALIGNMENT when it moves a
+ * chunk, so over-aligned types move through allocate() and a copy instead.
+ */
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+T* Halloc<T, BlockSize, MaxNumBlocks, Container>::reallocate(T* ptr, std::size_t old_count,
+                                                             std::size_t new_count) {
+    if constexpr (alignof(T) > MIN_ALIGNMENT) {
+        if (try_expand(ptr, old_count, new_count)) {
+            return ptr;
+        }
+        T* moved = allocate(new_count);
+        if (!moved) {
+            return nullptr;
+        }
+        std::memcpy(static_cast<void*>(moved), static_cast<const void*>(ptr),
+                    std::min(old_count, new_count) * sizeof(T));
+        deallocate(ptr, old_count);
+        return moved;
+    } else {
+        return static_cast<T*>(
+            blocks->reallocate(ptr, old_count * sizeof(T), new_count * sizeof(T)));
+    }
+}
+
 /**
  * @brief Destructor - releases resources.
  *
@@ -266,8 +518,8 @@ void Halloc<T, BlockSize, MaxNumBlocks>::deallocate(T* ptr, std::size_t count) {
  * @tparam MaxNumBlocks Maximum number of blocks
  * @post If this was the last reference, all memory is returned to the OS
  */
-template <typename T, int BlockSize, int MaxNumBlocks>
-Halloc<T, BlockSize, MaxNumBlocks>::~Halloc() {
+template <typename T, std::size_t BlockSize, int MaxNumBlocks, typename Container>
+Halloc<T, BlockSize, MaxNumBlocks, Container>::~Halloc() {
     // shared_ptr handles cleanup when reference count reaches zero
 }
 
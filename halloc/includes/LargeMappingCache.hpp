@@ -0,0 +1,215 @@
+/**
+ * @file LargeMappingCache.hpp
+ * @brief Registry and reuse cache for allocations that fit in no block.
+ *
+ * This file defines the large-allocation path shared by every container: requests
+ * too large for a block get their own mapping, whose size is recorded in a registry
+ * so it can be released without the caller's byte count. Freed mappings are kept in
+ * a size-bucketed cache for a while, so repeated large alloc/free pairs reuse them
+ * instead of paying for mmap, munmap and fresh page faults every time.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#include "Block.hpp"
+#include "PageMap.hpp"
+
+namespace hh::halloc {
+
+/**
+ * @brief Size-bucketed cache of recently freed large mappings.
+ *
+ * Mapping sizes are rounded up to size classes (four per power of two, in whole
+ * pages), so a cached mapping can serve any later request of the same class. Each
+ * class keeps up to BUCKET_CAPACITY mappings and reuses the most recently freed one,
+ * whose pages are most likely still resident.
+ *
+ * Cached mappings are unmapped once they have been idle for longer than the decay
+ * period, and the oldest ones are evicted when the cache would exceed its byte
+ * limit. Decay is applied whenever a mapping is freed or a cache miss maps a new
+ * one, so an idle cache holds its mappings until the next large operation or
+ * purge().
+ *
+ * The registry tags the first page of every live or cached mapping with its mapped
+ * size in a PageMap, so owns() and deallocate() are O(1) and lock-free lookups.
+ *
+ * @note Thread-safety: all methods may be called concurrently; the cache itself is
+ *       guarded by one mutex, taken only on the large-allocation path
+ */
+class LargeMappingCache {
+public:
+    static constexpr std::size_t BUCKET_CAPACITY = 4;      ///< Cached mappings per size class
+    static constexpr std::size_t CLASSES_PER_DOUBLING = 4;  ///< Size classes per power of two
+    static constexpr std::size_t DEFAULT_MAX_CACHED_BYTES = 256 * 1024 * 1024;  ///< 256 MiB
+    static constexpr std::chrono::milliseconds DEFAULT_DECAY{10000};           ///< 10 s
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t NUM_BUCKETS = CLASSES_PER_DOUBLING * PageMap::ADDRESS_BITS;
+
+    struct Entry {
+        void* ptr;                ///< Start of the cached mapping
+        Clock::time_point freed;  ///< When the mapping entered the cache
+    };
+
+    struct Bucket {
+        Entry entries[BUCKET_CAPACITY];  ///< Oldest first
+        std::size_t count;               ///< Number of valid entries
+    };
+
+    PageMap registry;                 ///< First page of a mapping -> mapped size (0 = not ours)
+    std::mutex lock;                  ///< Guards buckets and cached_bytes
+    Bucket buckets[NUM_BUCKETS];      ///< Cached mappings of each size class
+    std::size_t cached_bytes;         ///< Total size of cached mappings
+    std::size_t max_cached_bytes;     ///< Limit on cached_bytes
+    std::chrono::milliseconds decay;  ///< Idle time after which a cached mapping is unmapped
+
+    /**
+     * @brief Returns the bucket of a size class.
+     * @param mapped A value returned by size_class()
+     */
+    static std::size_t bucket_of(std::size_t mapped);
+
+    /**
+     * @brief Unmaps a mapping and removes it from the registry.
+     */
+    void release(void* ptr, std::size_t mapped);
+
+    /**
+     * @brief Removes entry `index` of a bucket, keeping the others in age order.
+     * @pre lock is held
+     */
+    void remove_entry(std::size_t bucket, std::size_t index);
+
+    /**
+     * @brief Unmaps every cached mapping freed before `cutoff`.
+     * @pre lock is held
+     */
+    void evict_older_than(Clock::time_point cutoff);
+
+    /**
+     * @brief Unmaps the oldest cached mappings until `incoming` more bytes fit the limit.
+     * @pre lock is held
+     */
+    void make_room(std::size_t incoming);
+
+public:
+    /**
+     * @brief Constructor - creates an empty cache.
+     *
+     * @param max_cached_bytes Limit on the total size of cached mappings (0 disables caching)
+     * @param decay Idle time after which a cached mapping is unmapped
+     */
+    explicit LargeMappingCache(std::size_t max_cached_bytes = DEFAULT_MAX_CACHED_BYTES,
+                               std::chrono::milliseconds decay = DEFAULT_DECAY);
+
+    LargeMappingCache(const LargeMappingCache&) = delete;
+    LargeMappingCache& operator=(const LargeMappingCache&) = delete;
+
+    /**
+     * @brief Destructor - unmaps every cached mapping.
+     *
+     * Live mappings are left alone; they remain valid until the process exits.
+     */
+    ~LargeMappingCache();
+
+    /**
+     * @brief Returns the cache shared by all containers.
+     *
+     * The shared cache is never destroyed, so it stays usable during static destruction.
+     */
+    static LargeMappingCache& instance();
+
+    /**
+     * @brief Rounds a size up to its size class.
+     *
+     * @param bytes Requested size
+     * @return Mapped size used for the request: whole pages, and one of
+     *         CLASSES_PER_DOUBLING evenly spaced sizes in its power-of-two range
+     */
+    static std::size_t size_class(std::size_t bytes);
+
+    /**
+     * @brief Maps (or reuses) memory for a large request.
+     *
+     * @param bytes Number of bytes to allocate
+     * @param alignment Power-of-two alignment
+     * @return Pointer to at least bytes bytes aligned to `alignment`; the content is
+     *         unspecified if the mapping is reused
+     * @throws std::bad_alloc if bytes exceeds half the address space or mmap fails
+     */
+    void* allocate(std::size_t bytes, std::size_t alignment);
+
+    /**
+     * @brief Maps (or reuses) memory for a large request, without throwing.
+     *
+     * @param bytes Number of bytes to allocate
+     * @param alignment Power-of-two alignment
+     * @return Same as the throwing overload, or nullptr where it would throw
+     */
+    void* allocate(std::size_t bytes, std::size_t alignment, std::nothrow_t) noexcept;
+
+    /**
+     * @brief Returns a mapping to the cache, or unmaps it if it cannot be cached.
+     *
+     * @param ptr Pointer returned by allocate(); any other pointer (!owns(ptr)) is
+     *            ignored
+     */
+    void deallocate(void* ptr);
+
+    /**
+     * @brief Resizes a live mapping without moving it.
+     *
+     * Growing extends the mapping with mremap, which fails when the address space
+     * after it is taken. Shrinking unmaps the pages past the new size class.
+     *
+     * @param ptr Pointer returned by allocate()
+     * @param bytes New size in bytes
+     * @return true if the mapping now holds at least bytes bytes at ptr; false if
+     *         it cannot grow in place or !owns(ptr)
+     */
+    bool try_expand(void* ptr, std::size_t bytes);
+
+    /**
+     * @brief Resizes a live mapping, moving it with mremap if it cannot grow in place.
+     *
+     * A moved mapping keeps its pages, so its content is preserved without copying.
+     * It is page-aligned, but may lose a larger alignment requested from allocate().
+     *
+     * @param ptr Pointer returned by allocate()
+     * @param bytes New size in bytes
+     * @return Start of the resized mapping (ptr itself if it did not move)
+     * @throws std::bad_alloc if mremap fails
+     * @throws std::invalid_argument if !owns(ptr)
+     */
+    void* reallocate(void* ptr, std::size_t bytes);
+
+    /**
+     * @brief Checks whether a pointer is the start of a mapping from allocate().
+     */
+    bool owns(const void* ptr) const { return registry.get(ptr) != 0; }
+
+    /**
+     * @brief Gets the mapped size of a mapping from allocate().
+     * @return Mapped size in bytes, or 0 if ptr is not the start of such a mapping
+     */
+    std::size_t mapping_size(const void* ptr) const { return registry.get(ptr); }
+
+    /**
+     * @brief Unmaps every cached mapping immediately.
+     */
+    void purge();
+
+    /**
+     * @brief Gets the total size of the mappings currently cached.
+     */
+    std::size_t get_cached_bytes();
+};
+}  // namespace hh::halloc
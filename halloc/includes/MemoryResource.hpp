@@ -0,0 +1,138 @@
+/**
+ * @file MemoryResource.hpp
+ * @brief std::pmr::memory_resource over a Halloc container.
+ *
+ * Halloc's type carries its container geometry (BlockSize, MaxNumBlocks), so every
+ * container that uses it is a distinct type. A memory resource hides the container
+ * behind the polymorphic std::pmr interface instead: any std::pmr container can draw
+ * from it through a plain pointer, whatever the geometry.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <optional>
+
+#include "BlocksContainer.hpp"
+
+namespace hh::halloc {
+/**
+ * @brief Polymorphic memory resource backed by one Halloc container.
+ *
+ * The resource either owns its container or uses one owned by the caller, e.g. a
+ * container that other code allocates from as well. std::pmr containers keep a
+ * pointer to the resource, so any number of them share the container without
+ * reference counting. The resource must outlive every container that uses it, and a
+ * caller-owned container must outlive the resource.
+ *
+ * Requests aligned to at most MIN_ALIGNMENT take the container's allocate() path;
+ * stricter alignments go through allocate_aligned(). Zero-byte requests, which
+ * std::pmr allows, are served as one byte.
+ *
+ * @tparam Container Container that serves the raw allocations
+ *                   (default: DynamicBlocksContainer)
+ *
+ * @note Thread-safety: that of Container. With the default container the resource
+ *       must not be used from several threads at once; use e.g.
+ *       BasicMemoryResource<ConcurrentBlocksContainer<...>> for that.
+ *
+ * Example:
+ * @code
+ * hh::halloc::MemoryResource resource;
+ * std::pmr::vector<int> vec(&resource);
+ * std::pmr::unordered_map<int, std::pmr::string> map(&resource);
+ *
+ * hh::halloc::DynamicBlocksContainer blocks;
+ * hh::halloc::MemoryResource shared(blocks);  // does not own `blocks`
+ * @endcode
+ */
+template <typename Container = DynamicBlocksContainer>
+class BasicMemoryResource : public std::pmr::memory_resource {
+    std::optional<Container> owned;  ///< The container, unless the caller owns it
+    Container* container;            ///< Serves every allocation of this resource
+
+public:
+    /**
+     * @brief Default constructor - creates the container with its default geometry.
+     */
+    BasicMemoryResource() : container(&owned.emplace()) {}
+
+    /**
+     * @brief Constructor - creates a runtime-configured container.
+     *
+     * Only available when Container is constructible from a ContainerConfig
+     * (e.g. DynamicBlocksContainer).
+     *
+     * @param config Block geometry of the container
+     * @throws std::invalid_argument if the configuration is invalid
+     */
+    explicit BasicMemoryResource(const ContainerConfig& config)
+        : container(&owned.emplace(config)) {}
+
+    /**
+     * @brief Constructor - serves allocations from a container owned by the caller.
+     *
+     * The container may keep serving other allocators; memory from the resource
+     * must still be returned through the resource (or the same container).
+     *
+     * @param shared Container to allocate from; must outlive the resource
+     */
+    explicit BasicMemoryResource(Container& shared) : container(&shared) {}
+
+    BasicMemoryResource(const BasicMemoryResource&) = delete;
+    BasicMemoryResource& operator=(const BasicMemoryResource&) = delete;
+
+    /**
+     * @brief Underlying container, e.g. to inspect its blocks.
+     * @return Reference to the container
+     */
+    Container& get_container() { return *container; }
+
+protected:
+    /**
+     * @brief Allocates `bytes` bytes aligned to `alignment`.
+     * @throws std::bad_alloc if the container cannot serve the request
+     */
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    /**
+     * @brief Returns memory obtained from do_allocate() with the same size.
+     */
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+
+    /**
+     * @brief Two resources are interchangeable only if they are the same object.
+     */
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/**
+ * @brief Memory resource over a growable container whose geometry is chosen at runtime.
+ */
+using MemoryResource = BasicMemoryResource<>;
+}  // namespace hh::halloc
+
+namespace hh::halloc {
+template <typename Container>
+void* BasicMemoryResource<Container>::do_allocate(std::size_t bytes, std::size_t alignment) {
+    if (bytes == 0) {
+        bytes = 1;
+    }
+    void* ptr = alignment > MIN_ALIGNMENT ? container->allocate_aligned(bytes, alignment)
+                                          : container->allocate(bytes);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+template <typename Container>
+void BasicMemoryResource<Container>::do_deallocate(void* ptr, std::size_t bytes,
+                                                   [[maybe_unused]] std::size_t alignment) {
+    container->deallocate(ptr, bytes == 0 ? 1 : bytes);
+}
+}  // namespace hh::halloc
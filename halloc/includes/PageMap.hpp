@@ -0,0 +1,244 @@
+/**
+ * @file PageMap.hpp
+ * @brief Radix tree mapping 4 KiB pages to a small per-page value.
+ *
+ * This file defines the page map used to find which block owns a pointer in
+ * constant time. Every page of a block is tagged with a value (e.g. the block's
+ * index + 1); untagged pages read as 0, which marks memory the map does not own.
+ */
+
+#pragma once
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "Block.hpp"
+
+namespace hh::halloc {
+
+/**
+ * @brief Three-level radix tree from page number to a pointer-sized value.
+ *
+ * A 48-bit virtual address holds a 36-bit page number (4 KiB pages), split into
+ * three 12-bit indices: root -> mid -> leaf. Each level is a 32 KiB array obtained
+ * from mmap on first use, so the map costs nothing until a range is tagged and
+ * only the parts of the address space that hold blocks are ever materialized.
+ * A lookup is three dependent loads regardless of how many blocks exist.
+ *
+ * @note Thread-safety: get() is lock-free and may run concurrently with set_range()
+ *       on other pages; concurrent set_range() calls on disjoint ranges are safe
+ * @note Nodes are only released by the destructor
+ */
+class PageMap {
+public:
+    static constexpr std::size_t PAGE_SHIFT = 12;  ///< log2 of the tracked page size
+    static constexpr std::size_t LEVEL_BITS = 12;  ///< Index bits per tree level
+    static constexpr std::size_t ADDRESS_BITS = PAGE_SHIFT + 3 * LEVEL_BITS;  ///< 48
+
+private:
+    static constexpr std::size_t FANOUT = std::size_t{1} << LEVEL_BITS;
+
+    struct Leaf {
+        std::atomic<std::uintptr_t> values[FANOUT];  ///< Value of each page (0 = untagged)
+    };
+
+    struct Mid {
+        std::atomic<Leaf*> leaves[FANOUT];  ///< Leaf of each 16 MiB range
+    };
+
+    struct Root {
+        std::atomic<Mid*> mids[FANOUT];  ///< Mid node of each 64 GiB range
+    };
+
+    std::atomic<Root*> root;  ///< Created on first set_range()
+
+    /**
+     * @brief Returns a child node, creating it with mmap if it does not exist yet.
+     *
+     * Racing creators install with a CAS; the loser unmaps its node and uses the
+     * winner's. Fresh anonymous mappings are zero-filled, i.e. all entries are empty.
+     *
+     * @return The child node, or nullptr if it cannot be mapped
+     */
+    template <typename Node>
+    static Node* get_or_create(std::atomic<Node*>& slot);
+
+    /**
+     * @brief Returns the leaf covering a page, creating missing levels.
+     * @return The leaf, or nullptr if a level cannot be mapped
+     */
+    Leaf* leaf_for(std::uintptr_t page);
+
+public:
+    /**
+     * @brief Constructor - creates an empty map (no memory is mapped).
+     */
+    PageMap() : root(nullptr) {}
+
+    PageMap(const PageMap&) = delete;
+    PageMap& operator=(const PageMap&) = delete;
+
+    /**
+     * @brief Destructor - unmaps every node of the tree.
+     */
+    ~PageMap();
+
+    /**
+     * @brief Tags every page overlapping [start, start + bytes) with `value`.
+     *
+     * @param start First address of the range
+     * @param bytes Length of the range in bytes
+     * @param value Value to store (0 clears the tag)
+     * @throws std::bad_alloc if a node cannot be mapped or the range lies above
+     *         the 48-bit address space covered by the map
+     */
+    void set_range(const void* start, std::size_t bytes, std::uintptr_t value);
+
+    /**
+     * @brief Tags a range like set_range(), reporting failure instead of throwing.
+     *
+     * Every node the range needs is mapped before any page is tagged, so a failed
+     * call leaves all tags unchanged.
+     *
+     * @return true if the range was tagged; false if a node cannot be mapped or the
+     *         range lies above the address space covered by the map
+     */
+    bool try_set_range(const void* start, std::size_t bytes, std::uintptr_t value) noexcept;
+
+    /**
+     * @brief Returns the value of the page containing ptr.
+     *
+     * @param ptr Any address
+     * @return The page's value, or 0 if the page was never tagged
+     */
+    std::uintptr_t get(const void* ptr) const {
+        auto page = reinterpret_cast<std::uintptr_t>(ptr) >> PAGE_SHIFT;
+        if (page >> (3 * LEVEL_BITS)) {
+            return 0;
+        }
+
+        Root* r = root.load(std::memory_order_acquire);
+        if (!r) {
+            return 0;
+        }
+        Mid* mid = r->mids[page >> (2 * LEVEL_BITS)].load(std::memory_order_acquire);
+        if (!mid) {
+            return 0;
+        }
+        Leaf* leaf =
+            mid->leaves[(page >> LEVEL_BITS) & (FANOUT - 1)].load(std::memory_order_acquire);
+        if (!leaf) {
+            return 0;
+        }
+        return leaf->values[page & (FANOUT - 1)].load(std::memory_order_acquire);
+    }
+};
+}  // namespace hh::halloc
+
+namespace hh::halloc {
+
+template <typename Node>
+Node* PageMap::get_or_create(std::atomic<Node*>& slot) {
+    Node* node = slot.load(std::memory_order_acquire);
+    if (node) {
+        return node;
+    }
+
+    void* memory = REQUEST_MEMORY_VIA_MMAP(sizeof(Node));
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+
+    Node* created = static_cast<Node*>(memory);
+    if (slot.compare_exchange_strong(node, created, std::memory_order_acq_rel,
+                                     std::memory_order_acquire)) {
+        return created;
+    }
+
+    // Another thread installed the node first
+    RELEASE_MEMORY_VIA_MUNMAP(memory, sizeof(Node));
+    return node;
+}
+
+inline PageMap::Leaf* PageMap::leaf_for(std::uintptr_t page) {
+    Root* r = get_or_create(root);
+    if (!r) {
+        return nullptr;
+    }
+    Mid* mid = get_or_create(r->mids[page >> (2 * LEVEL_BITS)]);
+    if (!mid) {
+        return nullptr;
+    }
+    return get_or_create(mid->leaves[(page >> LEVEL_BITS) & (FANOUT - 1)]);
+}
+
+inline void PageMap::set_range(const void* start, std::size_t bytes, std::uintptr_t value) {
+    if (!try_set_range(start, bytes, value)) {
+        throw std::bad_alloc();
+    }
+}
+
+/**
+ * @brief Tags a range page by page, walking each leaf only once.
+ *
+ * A first pass maps the leaves of the whole range, so that running out of memory
+ * never leaves the range half tagged. Stores use release ordering so that a reader
+ * which obtains a pointer into the range through any synchronizing operation also
+ * sees its tag.
+ */
+inline bool PageMap::try_set_range(const void* start, std::size_t bytes,
+                                   std::uintptr_t value) noexcept {
+    if (bytes == 0) {
+        return true;
+    }
+
+    auto address = reinterpret_cast<std::uintptr_t>(start);
+    std::uintptr_t first = address >> PAGE_SHIFT;
+    std::uintptr_t last = (address + bytes - 1) >> PAGE_SHIFT;
+    if (last >> (3 * LEVEL_BITS)) {
+        return false;
+    }
+
+    for (std::uintptr_t page = first; page <= last; page = (page | (FANOUT - 1)) + 1) {
+        if (!leaf_for(page)) {
+            return false;
+        }
+    }
+
+    std::uintptr_t page = first;
+    while (page <= last) {
+        Leaf* leaf = leaf_for(page);
+        do {
+            leaf->values[page & (FANOUT - 1)].store(value, std::memory_order_release);
+            page++;
+        } while (page <= last && (page & (FANOUT - 1)) != 0);
+    }
+    return true;
+}
+
+inline PageMap::~PageMap() {
+    Root* r = root.load(std::memory_order_acquire);
+    if (!r) {
+        return;
+    }
+
+    for (auto& mid_slot : r->mids) {
+        Mid* mid = mid_slot.load(std::memory_order_relaxed);
+        if (!mid) {
+            continue;
+        }
+        for (auto& leaf_slot : mid->leaves) {
+            Leaf* leaf = leaf_slot.load(std::memory_order_relaxed);
+            if (leaf) {
+                RELEASE_MEMORY_VIA_MUNMAP(leaf, sizeof(Leaf));
+            }
+        }
+        RELEASE_MEMORY_VIA_MUNMAP(mid, sizeof(Mid));
+    }
+    RELEASE_MEMORY_VIA_MUNMAP(r, sizeof(Root));
+}
+}  // namespace hh::halloc
@@ -0,0 +1,473 @@
+/**
+ * @file PerCpuBlocksContainer.hpp
+ * @brief Thread-safe container with one BlocksContainer arena per CPU.
+ *
+ * This file defines a container that keeps one arena per CPU and serves every
+ * allocation from the arena of the CPU the calling thread is running on. Lock
+ * contention therefore scales with the number of cores instead of the number of
+ * threads, and memory is not multiplied by the thread count like per-thread caches.
+ */
+
+#pragma once
+
+#include <sched.h>
+#include <unistd.h>
+
+#if __has_include(<sys/rseq.h>)
+#include <sys/rseq.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include "BlocksContainer.hpp"
+#include "LargeMappingCache.hpp"
+#include "PageMap.hpp"
+#include "RemoteFreeQueue.hpp"
+
+#if defined(RSEQ_SIG) && (defined(__x86_64__) || defined(__aarch64__))
+#define HALLOC_HAVE_RSEQ 1
+#else
+#define HALLOC_HAVE_RSEQ 0
+#endif
+
+namespace hh::halloc {
+
+/**
+ * @brief Returns the CPU the calling thread is currently running on.
+ *
+ * Reads the cpu_id field of the thread's restartable-sequences area when glibc
+ * registered one (a plain memory load), and falls back to sched_getcpu() otherwise.
+ * The result is only a hint: the thread may migrate right after the call.
+ *
+ * @return CPU number (0 if it cannot be determined)
+ */
+inline int current_cpu() {
+#if HALLOC_HAVE_RSEQ
+    if (__rseq_size > 0) {
+        auto* area = reinterpret_cast<const volatile struct rseq*>(
+            static_cast<char*>(__builtin_thread_pointer()) + __rseq_offset);
+        int cpu = static_cast<int>(area->cpu_id);
+        if (cpu >= 0) {
+            return cpu;
+        }
+    }
+#endif
+    int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : cpu;
+}
+
+/**
+ * @brief Thread-safe container keeping one BlocksContainer arena per CPU.
+ *
+ * Every allocation locks only the arena of the calling thread's current CPU.
+ * Arenas are created lazily on first use, so CPUs that never allocate cost nothing.
+ *
+ * Any thread may free any pointer: the owning arena is found through a lock-free
+ * page map, in which every arena tags the pages of each block it creates. Frees
+ * into the current CPU's arena lock it directly when it is free.
+ * Frees into another CPU's arena (or into a busy one) are pushed onto that arena's
+ * lock-free remote-free queue instead; the arena drains the queue in one batch the
+ * next time it is locked, returning the chunks through Block::deallocate (and so
+ * Block::coalesce_nodes).
+ *
+ * @tparam BlockSize Size of each memory block in bytes
+ * @tparam MaxNumBlocks Maximum number of blocks per arena
+ *
+ * @note Thread-safety: allocate/deallocate may be called concurrently from any thread
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+class PerCpuBlocksContainer {
+    /**
+     * @brief One CPU's arena, padded to a cache line to avoid false sharing.
+     */
+    struct alignas(64) Arena {
+        std::mutex lock;  ///< Guards container
+        std::unique_ptr<BlocksContainer<BlockSize, MaxNumBlocks>>
+            container;  ///< Created on first use
+        std::size_t known_blocks = 0;  ///< Blocks of this arena already in the page map
+        RemoteFreeQueue remote_frees;   ///< Chunks freed by threads not holding lock
+    };
+
+    std::size_t num_arenas;           ///< Number of arenas (configured CPUs)
+    std::unique_ptr<Arena[]> arenas;  ///< One arena per CPU
+    PageMap page_map;                 ///< Page -> owning arena index + 1 (0 = not a block)
+    PurgeConfig purge;                ///< Purge policy of every arena's blocks
+
+    /**
+     * @brief Publishes blocks an arena created since the last call.
+     * @pre The caller holds arenas[index].lock
+     */
+    void publish_new_blocks(std::size_t index);
+
+    /**
+     * @brief Returns every chunk queued by remote frees to the arena's blocks.
+     * @pre The caller holds arena.lock
+     */
+    static void drain_remote_frees(Arena& arena);
+
+    /**
+     * @brief Finds the arena owning a pointer without taking any lock.
+     * @return Arena index, or num_arenas if no arena owns ptr (large mapping)
+     */
+    std::size_t find_owner(const void* ptr) const;
+
+public:
+    /**
+     * @brief Constructor - sizes the arena table to the number of configured CPUs.
+     * @post No arena has created a block yet
+     */
+    PerCpuBlocksContainer() : PerCpuBlocksContainer(PurgeConfig{}) {}
+
+    /**
+     * @brief Constructor - sizes the arena table, purging free pages as configured.
+     * @param purge When free chunks of every arena return their pages to the OS
+     * @post No arena has created a block yet
+     */
+    explicit PerCpuBlocksContainer(const PurgeConfig& purge);
+
+    PerCpuBlocksContainer(const PerCpuBlocksContainer&) = delete;
+    PerCpuBlocksContainer& operator=(const PerCpuBlocksContainer&) = delete;
+
+    /**
+     * @brief Allocates memory from the calling thread's current CPU arena.
+     *
+     * @param bytes Number of bytes to allocate
+     * @return Pointer to allocated memory
+     * @throws std::invalid_argument if bytes == 0
+     */
+    void* allocate(std::size_t bytes);
+
+    /**
+     * @brief Allocates memory aligned to `alignment` from the current CPU arena.
+     *
+     * @param bytes Number of bytes to allocate
+     * @param alignment Power-of-two alignment; values <= MIN_ALIGNMENT behave like allocate()
+     * @return Pointer to allocated memory aligned to `alignment`
+     * @throws std::invalid_argument if bytes == 0 or alignment is not a power of two
+     */
+    void* allocate_aligned(std::size_t bytes, std::size_t alignment);
+
+    /**
+     * @brief Deallocates memory into the arena that owns it.
+     *
+     * Never waits on another CPU's arena: such frees are queued lock-free.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param bytes Size of the allocation
+     */
+    void deallocate(void* ptr, std::size_t bytes);
+
+    /**
+     * @brief Allocates `count` chunks from the current CPU arena under one lock.
+     *
+     * @param bytes Size of each chunk in bytes
+     * @param count Number of chunks
+     * @param out Receives the `count` pointers
+     * @throws std::invalid_argument if bytes == 0
+     */
+    void allocate_batch(std::size_t bytes, std::size_t count, void** out);
+
+    /**
+     * @brief Deallocates `count` chunks, locking each owning arena once.
+     *
+     * Unlike deallocate(), this waits for the owning arenas' locks: a whole batch
+     * is worth one lock acquisition, and queuing it chunk by chunk would lose the
+     * merging of neighbouring chunks.
+     *
+     * @param ptrs Pointers returned by this container (reordered by the call)
+     * @param count Number of pointers
+     * @param bytes Size of each allocation
+     */
+    void deallocate_batch(void** ptrs, std::size_t count, std::size_t bytes);
+
+    /**
+     * @brief Resizes an allocation in place inside the arena that owns it.
+     *
+     * Unlike deallocate(), this waits for the owning arena's lock, since the
+     * caller needs the answer.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_bytes Current size of the allocation
+     * @param new_bytes Requested size
+     * @return true if ptr now holds new_bytes bytes; false if nothing changed
+     * @throws std::invalid_argument if new_bytes == 0
+     */
+    bool try_expand(void* ptr, std::size_t old_bytes, std::size_t new_bytes);
+
+    /**
+     * @brief Resizes an allocation, moving it only when it cannot be resized in place.
+     *
+     * Large mappings move with mremap; block chunks are copied into a new allocation
+     * from the current CPU's arena.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_bytes Current size of the allocation
+     * @param new_bytes Requested size
+     * @return Pointer to the resized allocation
+     * @throws std::invalid_argument if new_bytes == 0
+     */
+    void* reallocate(void* ptr, std::size_t old_bytes, std::size_t new_bytes);
+
+    /**
+     * @brief Gets the number of arenas.
+     */
+    std::size_t get_num_arenas() const { return num_arenas; }
+
+    /**
+     * @brief Gets the arena the calling thread would allocate from right now.
+     */
+    std::size_t current_arena() const {
+        return static_cast<std::size_t>(current_cpu()) % num_arenas;
+    }
+
+    /**
+     * @brief Logs the current state of every created arena to a file.
+     *
+     * @param logfile Output stream to write the log to
+     */
+    void log_container_state(std::ofstream& logfile);
+};
+}  // namespace hh::halloc
+
+namespace hh::halloc {
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::PerCpuBlocksContainer(const PurgeConfig& purge)
+    : purge(purge) {
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    num_arenas = cpus > 0 ? static_cast<std::size_t>(cpus) : 1;
+    arenas = std::make_unique<Arena[]>(num_arenas);
+}
+
+/**
+ * @brief Tags the pages of the arena's newly created blocks in the page map.
+ *
+ * Arenas own disjoint blocks, so they tag their pages concurrently without a lock.
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::publish_new_blocks(std::size_t index) {
+    Arena& arena = arenas[index];
+    std::size_t total = arena.container->get_num_blocks();
+    if (arena.known_blocks == total) {
+        return;
+    }
+
+    for (std::size_t i = arena.known_blocks; i < total; i++) {
+        page_map.set_range(arena.container->get_block_head(i), arena.container->get_block_size(i),
+                           index + 1);
+    }
+    arena.known_blocks = total;
+}
+
+/**
+ * @brief Detaches the arena's remote-free queue and frees the whole batch.
+ *
+ * One atomic exchange takes every queued chunk; each is then returned to its block,
+ * which coalesces it with free neighbours.
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::drain_remote_frees(Arena& arena) {
+    void* chunk = arena.remote_frees.take_all();
+    while (chunk) {
+        void* next = RemoteFreeQueue::next(chunk);
+        arena.container->deallocate(chunk, 0);
+        chunk = next;
+    }
+}
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+std::size_t PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::find_owner(const void* ptr) const {
+    std::uintptr_t owner = page_map.get(ptr);
+    return owner ? owner - 1 : num_arenas;
+}
+
+/**
+ * @brief Allocates from the arena of the current CPU.
+ *
+ * Algorithm:
+ * 1. Pick the arena of the CPU the thread runs on (rseq cpu_id / sched_getcpu)
+ * 2. Lock it, creating its BlocksContainer on first use
+ * 3. Drain chunks other threads queued for this arena, so they can be reused
+ * 4. Allocate, then publish any block the arena created
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void* PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::allocate(std::size_t bytes) {
+    return allocate_aligned(bytes, MIN_ALIGNMENT);
+}
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+void* PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::allocate_aligned(std::size_t bytes,
+                                                                       std::size_t alignment) {
+    if (bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+
+    std::size_t index = current_arena();
+    Arena& arena = arenas[index];
+
+    std::lock_guard<std::mutex> lock(arena.lock);
+    if (!arena.container) {
+        arena.container = std::make_unique<BlocksContainer<BlockSize, MaxNumBlocks>>(purge);
+    }
+    drain_remote_frees(arena);
+
+    void* ptr = arena.container->allocate_aligned(bytes, alignment);
+    publish_new_blocks(index);
+    return ptr;
+}
+
+/**
+ * @brief Returns memory to its owning arena, whichever CPU the caller is on.
+ *
+ * Algorithm:
+ * 1. Pointers owned by no arena are large mappings and go back to the
+ *    LargeMappingCache
+ * 2. If the owner is the current CPU's arena and its lock is free, free directly
+ *    (draining any queued remote frees while the lock is held)
+ * 3. Otherwise push the chunk onto the owner's remote-free queue, lock-free
+ *
+ * Chunks smaller than a pointer cannot hold the queue link and always take the
+ * owner's lock.
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::deallocate(void* ptr, std::size_t bytes) {
+    std::size_t index = find_owner(ptr);
+    if (index == num_arenas) {
+        LargeMappingCache::instance().deallocate(ptr);
+        return;
+    }
+
+    Arena& arena = arenas[index];
+    if (bytes < sizeof(void*)) {
+        std::lock_guard<std::mutex> lock(arena.lock);
+        arena.container->deallocate(ptr, bytes);
+        return;
+    }
+
+    if (index == current_arena() && arena.lock.try_lock()) {
+        std::lock_guard<std::mutex> lock(arena.lock, std::adopt_lock);
+        drain_remote_frees(arena);
+        arena.container->deallocate(ptr, bytes);
+        return;
+    }
+
+    arena.remote_frees.push(ptr);
+}
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+void PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::allocate_batch(std::size_t bytes,
+                                                                    std::size_t count,
+                                                                    void** out) {
+    if (bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+
+    std::size_t index = current_arena();
+    Arena& arena = arenas[index];
+
+    std::lock_guard<std::mutex> lock(arena.lock);
+    if (!arena.container) {
+        arena.container = std::make_unique<BlocksContainer<BlockSize, MaxNumBlocks>>(purge);
+    }
+    drain_remote_frees(arena);
+
+    arena.container->allocate_batch(bytes, count, out);
+    publish_new_blocks(index);
+}
+
+/**
+ * @brief Sorts the pointers and frees each arena's share under one lock acquisition.
+ *
+ * Arenas own disjoint blocks, but the blocks of different arenas interleave in the
+ * address space, so a run ends whenever the owner changes.
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+void PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::deallocate_batch(void** ptrs,
+                                                                      std::size_t count,
+                                                                      std::size_t bytes) {
+    std::sort(ptrs, ptrs + count, std::less<void*>());
+
+    std::size_t i = 0;
+    while (i < count) {
+        std::size_t index = find_owner(ptrs[i]);
+        if (index == num_arenas) {
+            LargeMappingCache::instance().deallocate(ptrs[i++]);
+            continue;
+        }
+
+        std::size_t end = i + 1;
+        while (end < count && find_owner(ptrs[end]) == index) {
+            end++;
+        }
+        Arena& arena = arenas[index];
+        std::lock_guard<std::mutex> lock(arena.lock);
+        drain_remote_frees(arena);
+        arena.container->deallocate_batch(ptrs + i, end - i, bytes);
+        i = end;
+    }
+}
+
+/**
+ * @brief Resizes within the owning arena, draining its remote frees first.
+ *
+ * A neighbour freed by another thread may still sit in the remote-free queue;
+ * draining it first lets the chunk grow into it.
+ */
+template <std::size_t BlockSize, int MaxNumBlocks>
+bool PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::try_expand(void* ptr,
+                                                                std::size_t old_bytes,
+                                                                std::size_t new_bytes) {
+    if (new_bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+
+    std::size_t index = find_owner(ptr);
+    if (index == num_arenas) {
+        return LargeMappingCache::instance().try_expand(ptr, new_bytes);
+    }
+
+    Arena& arena = arenas[index];
+    std::lock_guard<std::mutex> lock(arena.lock);
+    drain_remote_frees(arena);
+    return arena.container->try_expand(ptr, old_bytes, new_bytes);
+}
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+void* PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::reallocate(void* ptr,
+                                                                 std::size_t old_bytes,
+                                                                 std::size_t new_bytes) {
+    if (try_expand(ptr, old_bytes, new_bytes)) {
+        return ptr;
+    }
+    if (find_owner(ptr) == num_arenas) {
+        return LargeMappingCache::instance().reallocate(ptr, new_bytes);
+    }
+
+    void* moved = allocate(new_bytes);
+    std::memcpy(moved, ptr, std::min(old_bytes, new_bytes));
+    deallocate(ptr, old_bytes);
+    return moved;
+}
+
+template <std::size_t BlockSize, int MaxNumBlocks>
+void PerCpuBlocksContainer<BlockSize, MaxNumBlocks>::log_container_state(std::ofstream& logfile) {
+    logfile << "PerCpuBlocksContainer State:\n";
+    logfile << "Total Arenas: " << num_arenas << "\n";
+    for (std::size_t i = 0; i < num_arenas; i++) {
+        std::lock_guard<std::mutex> lock(arenas[i].lock);
+        if (arenas[i].container) {
+            drain_remote_frees(arenas[i]);
+            logfile << "================ Arena " << i << " ================\n";
+            arenas[i].container->log_container_state(logfile);
+        }
+    }
+}
+}  // namespace hh::halloc
@@ -20,21 +20,23 @@ namespace hh::halloc {
  * tree duplication.
  *
  * @tparam T Node type (must have fields: value, left, right, parent)
+ * @tparam Less Node ordering functor used by insert() (by value by default)
  *
  * @note This class is move-only (no copy constructor/assignment)
  * @note The node type T must be compatible with hh::rb_tree functions
  */
-template <typename T>
+template <typename T, typename Less = hh::rb_tree::ValueLess>
 class RBTreeDriver {
 private:
-    T* root;  ///< Pointer to root node of the RB-tree
+    T* root;       ///< Pointer to root node of the RB-tree
+    T* rightmost;  ///< Largest node, kept up to date so max() is O(1)
 
 public:
     /**
      * @brief Default constructor - creates an empty tree.
      * @post root == nullptr
      */
-    explicit RBTreeDriver() : root(nullptr) {}
+    explicit RBTreeDriver() : root(nullptr), rightmost(nullptr) {}
 
     /**
      * @brief Constructor with existing root node.
@@ -44,7 +46,7 @@ public:
      *
      * @note Caller transfers ownership of the tree to this driver
      */
-    explicit RBTreeDriver(T* node) : root(node) {}
+    explicit RBTreeDriver(T* node) : root(node), rightmost(hh::rb_tree::maximum(node)) {}
 
     /**
      * @brief Copy constructor - deleted (move-only semantics).
@@ -63,7 +65,10 @@ public:
      * @post this->root == other.root (original value)
      * @post other.root == nullptr
      */
-    RBTreeDriver(RBTreeDriver&& other) : root(other.root) { other.root = nullptr; }
+    RBTreeDriver(RBTreeDriver&& other) : root(other.root), rightmost(other.rightmost) {
+        other.root = nullptr;
+        other.rightmost = nullptr;
+    }
 
     /**
      * @brief Move assignment - transfers ownership of tree.
@@ -76,7 +81,9 @@ public:
     RBTreeDriver& operator=(RBTreeDriver&& other) {
         if (this != &other) {
             root = other.root;
+            rightmost = other.rightmost;
             other.root = nullptr;
+            other.rightmost = nullptr;
         }
         return *this;
     }
@@ -97,8 +104,15 @@ public:
      * @post RB-tree properties are maintained
      *
      * @note Time complexity: O(log n)
+     * @note A node that orders after the current maximum becomes the maximum, as
+     *       insert() places it at the end of the rightmost path
      */
-    void insert(T* node) { hh::rb_tree::insert(root, node); }
+    void insert(T* node) {
+        hh::rb_tree::insert(root, node, Less{});
+        if (!rightmost || !Less{}(node, rightmost)) {
+            rightmost = node;
+        }
+    }
 
     /**
      * @brief Removes a node from the RB-tree.
@@ -118,7 +132,51 @@ public:
      * @note Time complexity: O(log n)
      * @warning Do not call this after modifying node->value (tree uses value for comparisons)
      */
-    void remove(T* node) { hh::rb_tree::remove(root, node); }
+    void remove(T* node) {
+        if (node == rightmost) {
+            rightmost = hh::rb_tree::predecessor(node);
+        }
+        hh::rb_tree::remove(root, node);
+    }
+
+    /**
+     * @brief Puts a node in the place of another one without rebalancing.
+     *
+     * Delegates to hh::rb_tree::replace.
+     *
+     * @param old_node Node in the tree
+     * @param new_node Node not in the tree, ordering exactly where old_node does
+     *
+     * @note Time complexity: O(1)
+     */
+    void replace(T* old_node, T* new_node) {
+        hh::rb_tree::replace(root, old_node, new_node);
+        if (old_node == rightmost) {
+            rightmost = new_node;
+        }
+    }
+
+    /**
+     * @brief Changes the value of a node, moving it only if its order changes.
+     *
+     * Delegates to hh::rb_tree::update_key.
+     *
+     * @param node Node in the tree
+     * @param value New value (bit 63 clear; the node keeps its color)
+     *
+     * @note Time complexity: O(log n), without rebalancing when the order is unchanged
+     */
+    void update_key(T* node, std::size_t value) {
+        bool was_max = node == rightmost;
+        if (hh::rb_tree::update_key(root, node, value, Less{})) {
+            return;
+        }
+        if (was_max) {
+            rightmost = hh::rb_tree::maximum(root);
+        } else if (!Less{}(node, rightmost)) {
+            rightmost = node;
+        }
+    }
 
     /**
      * @brief Finds the smallest node with value >= key using custom comparison.
@@ -126,17 +184,29 @@ public:
      * Delegates to hh::rb_tree::lower_bound for efficient search.
      *
      * @param key Search key
-     * @param cmp Comparison function: returns true if first >= second
+     * @param cmp Functor (or function pointer) called as cmp(key, node_value); returns
+     *            true if the node satisfies the key (key <= node_value by default)
      * @return Pointer to node with smallest value >= key, or nullptr if no such node
      *
-     * @pre cmp != nullptr
      * @post Return value is nullptr or points to node in tree
      *
      * @note Time complexity: O(log n)
      * @note Used for best-fit allocation (find smallest free block >= requested size)
+     * @note cmp is a template argument, so a functor or lambda is inlined into the search
      */
-    T* lower_bound(std::size_t key, bool (*cmp)(std::size_t, std::size_t)) {
+    template <typename Compare = hh::rb_tree::KeyLessEqual>
+    T* lower_bound(std::size_t key, Compare cmp = Compare{}) {
         return hh::rb_tree::lower_bound(root, key, cmp);
     }
+
+    /**
+     * @brief Finds the node with the largest value.
+     *
+     * @return Pointer to the largest node, or nullptr if the tree is empty
+     *
+     * @note Time complexity: O(1); the maximum is maintained by insert(), remove()
+     *       and replace()
+     */
+    T* max() const { return rightmost; }
 };
 }  // namespace hh::halloc
\ No newline at end of file
@@ -0,0 +1,76 @@
+/**
+ * @file RemoteFreeQueue.hpp
+ * @brief Lock-free multi-producer/single-consumer queue of freed chunks.
+ *
+ * Threads that free memory owned by an arena they do not hold push the chunk here
+ * instead of taking the arena's lock. The arena's owner later takes the whole list
+ * in one atomic exchange and returns the chunks to their blocks in a batch.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace hh::halloc {
+
+/**
+ * @brief Intrusive lock-free MPSC stack of freed chunks.
+ *
+ * Each queued chunk stores the link to the next one in its first word, so pushing
+ * needs no memory besides the chunk itself. Producers push with a CAS loop; the
+ * consumer detaches everything at once with an exchange, which also makes the
+ * structure immune to ABA (single elements are never popped).
+ *
+ * @note push() may be called concurrently from any number of threads
+ * @note take_all() must only be called by the current owner (e.g. under the arena lock)
+ * @note Queued chunks must be at least sizeof(void*) bytes
+ */
+class RemoteFreeQueue {
+    std::atomic<void*> head;  ///< Most recently pushed chunk, or nullptr
+
+public:
+    /**
+     * @brief Default constructor - creates an empty queue.
+     */
+    RemoteFreeQueue() : head(nullptr) {}
+
+    RemoteFreeQueue(const RemoteFreeQueue&) = delete;
+    RemoteFreeQueue& operator=(const RemoteFreeQueue&) = delete;
+
+    /**
+     * @brief Pushes a freed chunk without taking any lock.
+     *
+     * @param chunk Chunk to queue (its first word is overwritten with the link)
+     */
+    void push(void* chunk) {
+        void* old_head = head.load(std::memory_order_relaxed);
+        do {
+            *static_cast<void**>(chunk) = old_head;
+        } while (!head.compare_exchange_weak(old_head, chunk, std::memory_order_release,
+                                             std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Detaches every queued chunk in one atomic operation.
+     *
+     * @return First chunk of the detached list (follow with next()), or nullptr
+     */
+    void* take_all() {
+        if (!head.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return head.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Checks whether any chunk is waiting (a hint under concurrency).
+     */
+    bool empty() const { return head.load(std::memory_order_relaxed) == nullptr; }
+
+    /**
+     * @brief Returns the chunk queued after `chunk` in a detached list.
+     */
+    static void* next(void* chunk) { return *static_cast<void**>(chunk); }
+};
+}  // namespace hh::halloc
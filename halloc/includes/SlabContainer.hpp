@@ -0,0 +1,478 @@
+/**
+ * @file SlabContainer.hpp
+ * @brief Headerless slab pages for small objects in front of a container.
+ *
+ * This file defines SlabContainer, a wrapper around a container (BlocksContainer by
+ * default) that serves requests of up to SLAB_MAX_SIZE bytes from slab pages. A
+ * slab page holds objects of a single size class back to back, with one free bit
+ * per object in the page header instead of a MemoryNode per object, so small
+ * objects pack densely and are allocated without any RB-tree search.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "Block.hpp"
+#include "BlocksContainer.hpp"
+#include "PageMap.hpp"
+
+namespace hh::halloc {
+
+constexpr std::size_t SLAB_PAGE_SIZE = std::size_t{1} << PageMap::PAGE_SHIFT;  ///< 4 KiB
+constexpr std::size_t SLAB_SPAN_PAGES = 16;  ///< Slab pages carved from one container chunk
+constexpr std::size_t SLAB_GRANULE = MIN_ALIGNMENT;  ///< Width of one size class in bytes
+constexpr std::size_t SLAB_MAX_SIZE = 256;           ///< Largest request served from slabs
+constexpr std::size_t SLAB_NUM_CLASSES = SLAB_MAX_SIZE / SLAB_GRANULE;  ///< Size classes
+
+/**
+ * @brief Container front-end serving small requests from size-classed slab pages.
+ *
+ * Slab pages are taken from spans of SLAB_SPAN_PAGES pages, each span being one
+ * page-aligned chunk allocated from the wrapped container (and so from a Block).
+ * Every page is tagged in a page map while its span is live, which is how
+ * deallocate() tells slab objects from ordinary chunks in O(1).
+ *
+ * Each size class keeps a list of its pages that have free objects; allocation
+ * takes the lowest free bit of the first page in the list. A page that becomes
+ * empty goes back to its span, unless it is the last page of its class (so that a
+ * single allocate/deallocate pair does not create and destroy a page every time).
+ * A span whose pages are all back is returned to the container.
+ *
+ * Requests above SLAB_MAX_SIZE, and over-aligned ones, go straight to the container.
+ *
+ * @tparam Container Underlying container type (must provide the BlocksContainer
+ *                   allocation interface)
+ *
+ * @note Thread-safety: This class is NOT thread-safe
+ */
+template <typename Container>
+class SlabContainer {
+    /**
+     * @brief Header at the start of every slab page.
+     */
+    struct SlabPage {
+        SlabPage* next;            ///< Next page in its class list or in the free page list
+        SlabPage* prev;            ///< Previous page in the same list
+        SlabPage* span;            ///< First page of the span this page belongs to
+        std::uint32_t span_used;   ///< Pages of the span in use (first page only)
+        std::uint32_t object_size;  ///< Size of every object on the page
+        std::uint16_t capacity;    ///< Number of objects on the page
+        std::uint16_t free_count;  ///< Number of free objects on the page
+        std::uint64_t free_bits[SLAB_PAGE_SIZE / SLAB_GRANULE / 64];  ///< 1 = object free
+    };
+
+    static constexpr std::size_t HEADER_SIZE = align_up(sizeof(SlabPage), MIN_ALIGNMENT);
+    static constexpr std::size_t SPAN_BYTES = SLAB_SPAN_PAGES * SLAB_PAGE_SIZE;
+    static_assert((SLAB_PAGE_SIZE - HEADER_SIZE) / SLAB_GRANULE <=
+                      8 * sizeof(SlabPage::free_bits),
+                  "free_bits must cover every object of the smallest size class");
+
+    Container container;                    ///< Serves spans and every other request
+    PageMap slab_map;                       ///< Page of a live span -> 1 (0 = not a slab)
+    SlabPage* partial[SLAB_NUM_CLASSES];    ///< Pages with free objects, per size class
+    SlabPage* free_pages;                   ///< Unused pages of live spans
+    std::size_t num_spans;                  ///< Number of live spans
+
+    /**
+     * @brief Maps a request size to its size class index.
+     * @pre 0 < bytes <= SLAB_MAX_SIZE
+     */
+    static std::size_t size_class(std::size_t bytes) { return (bytes - 1) / SLAB_GRANULE; }
+
+    /**
+     * @brief Returns the page holding a slab object.
+     */
+    static SlabPage* page_of(const void* ptr) {
+        return reinterpret_cast<SlabPage*>(reinterpret_cast<std::uintptr_t>(ptr) &
+                                           ~(SLAB_PAGE_SIZE - 1));
+    }
+
+    /**
+     * @brief Checks whether a pointer is an object on a slab page.
+     */
+    bool is_slab(const void* ptr) const { return slab_map.get(ptr) != 0; }
+
+    /**
+     * @brief Pushes a page onto the front of a list.
+     */
+    static void push(SlabPage*& list, SlabPage* page);
+
+    /**
+     * @brief Unlinks a page from the list it is in.
+     */
+    static void unlink(SlabPage*& list, SlabPage* page);
+
+    /**
+     * @brief Takes an unused page, allocating a new span if there is none.
+     * @throws std::bad_alloc if the container cannot provide a span
+     */
+    SlabPage* take_page();
+
+    /**
+     * @brief Hands an empty page back to its span, releasing the span once it is empty.
+     */
+    void return_page(SlabPage* page);
+
+    /**
+     * @brief Turns an unused page into an empty page of a size class.
+     */
+    static void format_page(SlabPage* page, std::size_t cls);
+
+    /**
+     * @brief Allocates one object of a size class.
+     */
+    void* allocate_small(std::size_t cls);
+
+    /**
+     * @brief Frees one slab object.
+     */
+    void deallocate_small(void* ptr);
+
+public:
+    /**
+     * @brief Constructor - creates the wrapped container from the given arguments.
+     *
+     * @param args Arguments forwarded to the Container constructor (e.g. a ContainerConfig)
+     * @post No slab page exists yet
+     */
+    template <typename... Args>
+    explicit SlabContainer(Args&&... args);
+
+    SlabContainer(const SlabContainer&) = delete;
+    SlabContainer& operator=(const SlabContainer&) = delete;
+
+    /**
+     * @brief Allocates memory, from a slab page for requests up to SLAB_MAX_SIZE bytes.
+     *
+     * @param bytes Number of bytes to allocate
+     * @return Pointer to allocated memory (MIN_ALIGNMENT-aligned)
+     * @throws std::invalid_argument if bytes == 0
+     */
+    void* allocate(std::size_t bytes);
+
+    /**
+     * @brief Allocates aligned memory; over-aligned requests bypass the slabs.
+     *
+     * @param bytes Number of bytes to allocate
+     * @param alignment Power-of-two alignment
+     * @return Pointer to allocated memory aligned to `alignment`
+     * @throws std::invalid_argument if bytes == 0 or alignment is not a power of two
+     */
+    void* allocate_aligned(std::size_t bytes, std::size_t alignment);
+
+    /**
+     * @brief Deallocates memory, to its slab page or to the container.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param bytes Size of the allocation (slab objects find their size class themselves)
+     */
+    void deallocate(void* ptr, std::size_t bytes);
+
+    /**
+     * @brief Allocates `count` chunks of `bytes` bytes each.
+     *
+     * @param bytes Size of each chunk in bytes
+     * @param count Number of chunks
+     * @param out Receives the `count` pointers
+     * @throws std::invalid_argument if bytes == 0
+     */
+    void allocate_batch(std::size_t bytes, std::size_t count, void** out);
+
+    /**
+     * @brief Deallocates `count` chunks of `bytes` bytes each.
+     *
+     * @param ptrs Pointers returned by this container (may be reordered by the call)
+     * @param count Number of pointers
+     * @param bytes Size of each allocation
+     */
+    void deallocate_batch(void** ptrs, std::size_t count, std::size_t bytes);
+
+    /**
+     * @brief Resizes an allocation without moving it.
+     *
+     * A slab object can take any size up to its size class; other allocations are
+     * resized by the container.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_bytes Current size of the allocation
+     * @param new_bytes Requested size
+     * @return true if ptr now holds new_bytes bytes; false if nothing changed
+     * @throws std::invalid_argument if new_bytes == 0
+     */
+    bool try_expand(void* ptr, std::size_t old_bytes, std::size_t new_bytes);
+
+    /**
+     * @brief Resizes an allocation, moving it only when it cannot be resized in place.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_bytes Current size of the allocation
+     * @param new_bytes Requested size
+     * @return Pointer to the resized allocation
+     * @throws std::invalid_argument if new_bytes == 0
+     */
+    void* reallocate(void* ptr, std::size_t old_bytes, std::size_t new_bytes);
+
+    /**
+     * @brief Gets the number of spans currently carved into slab pages.
+     */
+    std::size_t get_num_spans() const { return num_spans; }
+
+    /**
+     * @brief Gets the wrapped container.
+     */
+    Container& get_container() { return container; }
+
+    /**
+     * @brief Logs the state of the wrapped container (spans show as used chunks).
+     *
+     * @param logfile Output stream to write the log to
+     */
+    void log_container_state(std::ofstream& logfile) const;
+};
+}  // namespace hh::halloc
+
+namespace hh::halloc {
+
+template <typename Container>
+template <typename... Args>
+SlabContainer<Container>::SlabContainer(Args&&... args)
+    : container(std::forward<Args>(args)...), partial(), free_pages(nullptr), num_spans(0) {}
+
+template <typename Container>
+void SlabContainer<Container>::push(SlabPage*& list, SlabPage* page) {
+    page->prev = nullptr;
+    page->next = list;
+    if (list) {
+        list->prev = page;
+    }
+    list = page;
+}
+
+template <typename Container>
+void SlabContainer<Container>::unlink(SlabPage*& list, SlabPage* page) {
+    if (page->prev) {
+        page->prev->next = page->next;
+    } else {
+        list = page->next;
+    }
+    if (page->next) {
+        page->next->prev = page->prev;
+    }
+}
+
+/**
+ * @brief Pops an unused page, carving a new span into pages when none is left.
+ *
+ * A span is one SPAN_BYTES chunk aligned to SLAB_PAGE_SIZE, so its pages are
+ * whole PageMap pages and each page header can be found by masking a pointer.
+ */
+template <typename Container>
+typename SlabContainer<Container>::SlabPage* SlabContainer<Container>::take_page() {
+    if (!free_pages) {
+        auto* base = static_cast<unsigned char*>(
+            container.allocate_aligned(SPAN_BYTES, SLAB_PAGE_SIZE));
+        auto* span = reinterpret_cast<SlabPage*>(base);
+        for (std::size_t i = SLAB_SPAN_PAGES; i-- > 0;) {
+            auto* page = reinterpret_cast<SlabPage*>(base + i * SLAB_PAGE_SIZE);
+            page->span = span;
+            push(free_pages, page);
+        }
+        span->span_used = 0;
+        slab_map.set_range(base, SPAN_BYTES, 1);
+        num_spans++;
+    }
+
+    SlabPage* page = free_pages;
+    unlink(free_pages, page);
+    page->span->span_used++;
+    return page;
+}
+
+template <typename Container>
+void SlabContainer<Container>::return_page(SlabPage* page) {
+    SlabPage* span = page->span;
+    push(free_pages, page);
+    if (--span->span_used > 0) {
+        return;
+    }
+
+    auto* base = reinterpret_cast<unsigned char*>(span);
+    for (std::size_t i = 0; i < SLAB_SPAN_PAGES; i++) {
+        unlink(free_pages, reinterpret_cast<SlabPage*>(base + i * SLAB_PAGE_SIZE));
+    }
+    slab_map.set_range(base, SPAN_BYTES, 0);
+    container.deallocate(base, SPAN_BYTES);
+    num_spans--;
+}
+
+template <typename Container>
+void SlabContainer<Container>::format_page(SlabPage* page, std::size_t cls) {
+    std::size_t object_size = (cls + 1) * SLAB_GRANULE;
+    std::size_t capacity = (SLAB_PAGE_SIZE - HEADER_SIZE) / object_size;
+
+    page->object_size = static_cast<std::uint32_t>(object_size);
+    page->capacity = static_cast<std::uint16_t>(capacity);
+    page->free_count = static_cast<std::uint16_t>(capacity);
+    for (std::size_t word = 0; word < std::size(page->free_bits); word++) {
+        std::size_t first = word * 64;
+        std::size_t bits = capacity > first ? std::min<std::size_t>(capacity - first, 64) : 0;
+        page->free_bits[word] = bits == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << bits) - 1;
+    }
+}
+
+/**
+ * @brief Takes the lowest free object of the first page with room in the class.
+ *
+ * A page leaves the class list when its last object is taken and comes back
+ * (to the front) when one of its objects is freed.
+ */
+template <typename Container>
+void* SlabContainer<Container>::allocate_small(std::size_t cls) {
+    SlabPage* page = partial[cls];
+    if (!page) {
+        page = take_page();
+        format_page(page, cls);
+        push(partial[cls], page);
+    }
+
+    std::size_t word = 0;
+    while (!page->free_bits[word]) {
+        word++;
+    }
+    std::size_t bit = static_cast<std::size_t>(std::countr_zero(page->free_bits[word]));
+    page->free_bits[word] &= page->free_bits[word] - 1;
+
+    if (--page->free_count == 0) {
+        unlink(partial[cls], page);
+    }
+
+    std::size_t index = word * 64 + bit;
+    return reinterpret_cast<unsigned char*>(page) + HEADER_SIZE + index * page->object_size;
+}
+
+/**
+ * @brief Sets the object's free bit and recycles the page once it is empty.
+ *
+ * An empty page stays in its class when it is the only page there, so a class that
+ * is briefly idle keeps one page ready.
+ */
+template <typename Container>
+void SlabContainer<Container>::deallocate_small(void* ptr) {
+    SlabPage* page = page_of(ptr);
+    std::size_t cls = page->object_size / SLAB_GRANULE - 1;
+    std::size_t index = static_cast<std::size_t>(static_cast<unsigned char*>(ptr) -
+                                                 reinterpret_cast<unsigned char*>(page) -
+                                                 HEADER_SIZE) /
+                        page->object_size;
+    page->free_bits[index / 64] |= std::uint64_t{1} << (index % 64);
+
+    if (page->free_count++ == 0) {
+        push(partial[cls], page);
+    }
+    if (page->free_count == page->capacity && (page->next || page->prev)) {
+        unlink(partial[cls], page);
+        return_page(page);
+    }
+}
+
+template <typename Container>
+void* SlabContainer<Container>::allocate(std::size_t bytes) {
+    if (bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+    if (bytes > SLAB_MAX_SIZE) {
+        return container.allocate(bytes);
+    }
+    return allocate_small(size_class(bytes));
+}
+
+template <typename Container>
+void* SlabContainer<Container>::allocate_aligned(std::size_t bytes, std::size_t alignment) {
+    if (alignment <= MIN_ALIGNMENT) {
+        return allocate(bytes);
+    }
+    return container.allocate_aligned(bytes, alignment);
+}
+
+template <typename Container>
+void SlabContainer<Container>::deallocate(void* ptr, std::size_t bytes) {
+    if (is_slab(ptr)) {
+        deallocate_small(ptr);
+        return;
+    }
+    container.deallocate(ptr, bytes);
+}
+
+template <typename Container>
+void SlabContainer<Container>::allocate_batch(std::size_t bytes, std::size_t count, void** out) {
+    if (bytes > SLAB_MAX_SIZE) {
+        container.allocate_batch(bytes, count, out);
+        return;
+    }
+    for (std::size_t i = 0; i < count; i++) {
+        out[i] = allocate(bytes);
+    }
+}
+
+template <typename Container>
+void SlabContainer<Container>::deallocate_batch(void** ptrs, std::size_t count,
+                                                std::size_t bytes) {
+    if (bytes > SLAB_MAX_SIZE) {
+        container.deallocate_batch(ptrs, count, bytes);
+        return;
+    }
+    for (std::size_t i = 0; i < count; i++) {
+        deallocate(ptrs[i], bytes);
+    }
+}
+
+template <typename Container>
+bool SlabContainer<Container>::try_expand(void* ptr, std::size_t old_bytes,
+                                          std::size_t new_bytes) {
+    if (new_bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+    if (is_slab(ptr)) {
+        return new_bytes <= page_of(ptr)->object_size;
+    }
+    return container.try_expand(ptr, old_bytes, new_bytes);
+}
+
+/**
+ * @brief Resizes in place when possible; slab objects that outgrow their class move.
+ *
+ * Ordinary chunks stay with the container even when they shrink below
+ * SLAB_MAX_SIZE: deallocate() tells them apart by address, not by size.
+ */
+template <typename Container>
+void* SlabContainer<Container>::reallocate(void* ptr, std::size_t old_bytes,
+                                           std::size_t new_bytes) {
+    if (!is_slab(ptr)) {
+        return container.reallocate(ptr, old_bytes, new_bytes);
+    }
+    if (try_expand(ptr, old_bytes, new_bytes)) {
+        return ptr;
+    }
+
+    void* moved = allocate(new_bytes);
+    std::memcpy(moved, ptr, std::min(old_bytes, new_bytes));
+    deallocate_small(ptr);
+    return moved;
+}
+
+template <typename Container>
+void SlabContainer<Container>::log_container_state(std::ofstream& logfile) const {
+    logfile << "SlabContainer State:\n";
+    logfile << "Slab Spans: " << num_spans << "\n";
+    container.log_container_state(logfile);
+}
+}  // namespace hh::halloc
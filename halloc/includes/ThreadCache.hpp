@@ -0,0 +1,530 @@
+/**
+ * @file ThreadCache.hpp
+ * @brief Per-thread caches of recently freed chunks in front of a shared container.
+ *
+ * This file defines ThreadCachedContainer, an opt-in wrapper around a container
+ * (BlocksContainer by default) that keeps a small size-classed free list per thread.
+ * Most allocate/deallocate pairs are served from the calling thread's cache with no
+ * lock and no RB-tree walk. Only refills and flushes reach the shared container, in
+ * batches, under a single mutex.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "BlocksContainer.hpp"
+
+namespace hh::halloc {
+
+constexpr std::size_t THREAD_CACHE_GRANULE = 16;     ///< Width of one size class in bytes
+constexpr std::size_t THREAD_CACHE_MAX_SIZE = 1024;  ///< Largest request served by the cache
+constexpr std::size_t THREAD_CACHE_NUM_CLASSES =
+    THREAD_CACHE_MAX_SIZE / THREAD_CACHE_GRANULE;  ///< Number of size classes
+constexpr std::size_t THREAD_CACHE_BATCH_BYTES =
+    2048;  ///< Target bytes moved per refill/flush of one size class
+
+/**
+ * @brief Thread-safe container front-end with per-thread size-classed caches.
+ *
+ * Requests up to THREAD_CACHE_MAX_SIZE bytes are rounded up to a multiple of
+ * THREAD_CACHE_GRANULE and served from the calling thread's bin for that size class.
+ * Freed chunks go back to the bin of the freeing thread. Freed chunks are linked
+ * through their first word, so a cached chunk costs no extra memory.
+ *
+ * When a bin is empty it is refilled with a batch of chunks taken from the shared
+ * container under its mutex. When a bin grows past twice the batch size, everything
+ * past the first batch is flushed back in one locked pass. Requests above
+ * THREAD_CACHE_MAX_SIZE bypass the cache and go straight to the locked container.
+ *
+ * A thread returns its cached chunks when it exits (or on flush_thread_cache()).
+ * Caches belonging to a container that has already been destroyed are dropped
+ * without touching their (already unmapped) chunks.
+ *
+ * @tparam Container Underlying container type (must provide allocate/deallocate/
+ *                   log_container_state like BlocksContainer)
+ *
+ * @note Thread-safety: allocate/deallocate may be called concurrently from any thread
+ * @note A chunk may be freed by a different thread than the one that allocated it
+ */
+template <typename Container>
+class ThreadCachedContainer {
+    /**
+     * @brief State shared by every thread that uses this container.
+     *
+     * Kept behind a shared_ptr so exiting threads can tell (through a weak_ptr)
+     * whether the container still exists before flushing into it.
+     */
+    struct Shared {
+        std::mutex mutex;     ///< Guards container
+        Container container;  ///< Underlying (thread-unsafe) container
+        std::uint64_t id;     ///< Unique id, detects address reuse by a new container
+    };
+
+    /**
+     * @brief Singly-linked LIFO list of cached chunks of one size class.
+     */
+    struct Bin {
+        void* head;         ///< Most recently freed chunk (links through first word)
+        std::size_t count;  ///< Number of chunks in the list
+    };
+
+    /**
+     * @brief One thread's cache for one container.
+     */
+    struct CacheEntry {
+        Shared* owner;                       ///< Container this cache belongs to
+        std::uint64_t id;                    ///< owner->id at registration time
+        std::weak_ptr<Shared> weak;          ///< Liveness check used on thread exit
+        Bin bins[THREAD_CACHE_NUM_CLASSES];  ///< One bin per size class
+    };
+
+    /**
+     * @brief All caches of the calling thread; flushes them on thread exit.
+     */
+    struct ThreadCaches {
+        std::vector<CacheEntry> entries;  ///< One entry per container used by the thread
+        ~ThreadCaches();
+    };
+
+    std::shared_ptr<Shared> shared;  ///< Shared container state
+
+    /**
+     * @brief Returns the calling thread's cache list for this container type.
+     */
+    static ThreadCaches& local_caches();
+
+    /**
+     * @brief Returns the calling thread's cache entry for this container, creating it
+     *        on first use.
+     */
+    CacheEntry& local_entry();
+
+    /**
+     * @brief Maps a request size to its size class index.
+     * @pre 0 < bytes <= THREAD_CACHE_MAX_SIZE
+     */
+    static std::size_t size_class(std::size_t bytes) {
+        return (bytes + THREAD_CACHE_GRANULE - 1) / THREAD_CACHE_GRANULE - 1;
+    }
+
+    /**
+     * @brief Returns the chunk size (in bytes) of a size class.
+     */
+    static std::size_t class_size(std::size_t cls) { return (cls + 1) * THREAD_CACHE_GRANULE; }
+
+    /**
+     * @brief Returns the number of chunks moved per refill/flush for a size class.
+     */
+    static std::size_t batch_size(std::size_t cls) {
+        return std::clamp<std::size_t>(THREAD_CACHE_BATCH_BYTES / class_size(cls), 2, 32);
+    }
+
+    /**
+     * @brief Refills an empty bin with one batch of chunks from the shared container.
+     */
+    void refill(Bin& bin, std::size_t cls);
+
+    /**
+     * @brief Returns all but the first `keep` chunks of a bin to the container.
+     * @pre The caller holds state.mutex
+     */
+    static void flush(Shared& state, Bin& bin, std::size_t cls, std::size_t keep);
+
+public:
+    /**
+     * @brief Default constructor - creates the shared container.
+     */
+    ThreadCachedContainer();
+
+    ThreadCachedContainer(const ThreadCachedContainer&) = delete;
+    ThreadCachedContainer& operator=(const ThreadCachedContainer&) = delete;
+
+    /**
+     * @brief Allocates memory, from the calling thread's cache when possible.
+     *
+     * @param bytes Number of bytes to allocate
+     * @return Pointer to allocated memory
+     * @throws std::invalid_argument if bytes == 0
+     */
+    void* allocate(std::size_t bytes);
+
+    /**
+     * @brief Allocates aligned memory.
+     *
+     * Cached chunks are only MIN_ALIGNMENT-aligned, so over-aligned requests bypass
+     * the cache and go to the container under its lock. The chunk may still be
+     * returned through deallocate() and cached like any other chunk of its size.
+     *
+     * @param bytes Number of bytes to allocate
+     * @param alignment Power-of-two alignment
+     * @return Pointer to allocated memory aligned to `alignment`
+     * @throws std::invalid_argument if bytes == 0 or alignment is not a power of two
+     */
+    void* allocate_aligned(std::size_t bytes, std::size_t alignment);
+
+    /**
+     * @brief Deallocates memory into the calling thread's cache when possible.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param bytes Size passed to allocate() (selects the size class)
+     */
+    void deallocate(void* ptr, std::size_t bytes);
+
+    /**
+     * @brief Allocates `count` chunks of `bytes` bytes each.
+     *
+     * Cached sizes are popped from the thread's bin (refilled in batches as usual);
+     * larger sizes are carved by the container under a single lock acquisition.
+     *
+     * @param bytes Size of each chunk in bytes
+     * @param count Number of chunks
+     * @param out Receives the `count` pointers
+     * @throws std::invalid_argument if bytes == 0
+     */
+    void allocate_batch(std::size_t bytes, std::size_t count, void** out);
+
+    /**
+     * @brief Deallocates `count` chunks of `bytes` bytes each.
+     *
+     * Cached sizes go to the thread's bin; larger sizes are freed by the container
+     * under a single lock acquisition.
+     *
+     * @param ptrs Pointers returned by this container (may be reordered by the call)
+     * @param count Number of pointers
+     * @param bytes Size of each allocation
+     */
+    void deallocate_batch(void** ptrs, std::size_t count, std::size_t bytes);
+
+    /**
+     * @brief Resizes an allocation without moving it.
+     *
+     * A chunk whose size class does not change already holds the new size, so this
+     * succeeds without locking. Other resizes go to the container under its lock.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_bytes Current size of the allocation
+     * @param new_bytes Requested size
+     * @return true if ptr now holds new_bytes bytes; false if nothing changed
+     * @throws std::invalid_argument if new_bytes == 0
+     */
+    bool try_expand(void* ptr, std::size_t old_bytes, std::size_t new_bytes);
+
+    /**
+     * @brief Resizes an allocation, moving it only when it cannot be resized in place.
+     *
+     * Allocations above THREAD_CACHE_MAX_SIZE on both sides are resized by the
+     * container (so large mappings move with mremap); others are copied through
+     * the thread's cache.
+     *
+     * @param ptr Pointer previously returned by allocate()
+     * @param old_bytes Current size of the allocation
+     * @param new_bytes Requested size
+     * @return Pointer to the resized allocation
+     * @throws std::invalid_argument if new_bytes == 0
+     */
+    void* reallocate(void* ptr, std::size_t old_bytes, std::size_t new_bytes);
+
+    /**
+     * @brief Returns every chunk cached by the calling thread to the container.
+     */
+    void flush_thread_cache();
+
+    /**
+     * @brief Number of chunks currently cached by the calling thread.
+     */
+    std::size_t thread_cached_count();
+
+    /**
+     * @brief Logs the state of the underlying container (cached chunks show as used).
+     *
+     * @param logfile Output stream to write the log to
+     */
+    void log_container_state(std::ofstream& logfile) const;
+};
+}  // namespace hh::halloc
+
+namespace hh::halloc {
+
+/**
+ * @brief Flushes every live container's cache when the owning thread exits.
+ *
+ * Entries whose container has already been destroyed are skipped: their chunks
+ * belonged to blocks that were unmapped with the container.
+ */
+template <typename Container>
+ThreadCachedContainer<Container>::ThreadCaches::~ThreadCaches() {
+    for (auto& entry : entries) {
+        std::shared_ptr<Shared> owner = entry.weak.lock();
+        if (!owner) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(owner->mutex);
+        for (std::size_t cls = 0; cls < THREAD_CACHE_NUM_CLASSES; cls++) {
+            flush(*owner, entry.bins[cls], cls, 0);
+        }
+    }
+}
+
+template <typename Container>
+typename ThreadCachedContainer<Container>::ThreadCaches&
+ThreadCachedContainer<Container>::local_caches() {
+    thread_local ThreadCaches caches;
+    return caches;
+}
+
+/**
+ * @brief Finds (or registers) the calling thread's cache for this container.
+ *
+ * A matching address with a different id means the previous container at this
+ * address was destroyed: its chunks are gone, so the bins are simply reset.
+ * Registration also prunes entries of containers that no longer exist.
+ */
+template <typename Container>
+typename ThreadCachedContainer<Container>::CacheEntry&
+ThreadCachedContainer<Container>::local_entry() {
+    ThreadCaches& caches = local_caches();
+    Shared* owner = shared.get();
+
+    for (auto& entry : caches.entries) {
+        if (entry.owner == owner) {
+            if (entry.id != owner->id) {
+                entry = CacheEntry{owner, owner->id, shared, {}};
+            }
+            return entry;
+        }
+    }
+
+    std::erase_if(caches.entries, [](const CacheEntry& entry) { return entry.weak.expired(); });
+    caches.entries.push_back(CacheEntry{owner, owner->id, shared, {}});
+    return caches.entries.back();
+}
+
+/**
+ * @brief Takes one batch of chunks of a size class from the shared container.
+ *
+ * All chunks of the batch are obtained under a single lock acquisition.
+ */
+template <typename Container>
+void ThreadCachedContainer<Container>::refill(Bin& bin, std::size_t cls) {
+    std::size_t chunk_size = class_size(cls);
+    std::size_t count = batch_size(cls);
+
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    for (std::size_t i = 0; i < count; i++) {
+        void* chunk = shared->container.allocate(chunk_size);
+        *static_cast<void**>(chunk) = bin.head;
+        bin.head = chunk;
+        bin.count++;
+    }
+}
+
+/**
+ * @brief Returns the tail of a bin (everything after the first `keep` chunks).
+ *
+ * The hottest chunks (most recently freed) stay in the cache.
+ */
+template <typename Container>
+void ThreadCachedContainer<Container>::flush(Shared& state, Bin& bin, std::size_t cls,
+                                             std::size_t keep) {
+    if (bin.count <= keep) {
+        return;
+    }
+
+    void** link = &bin.head;
+    for (std::size_t i = 0; i < keep; i++) {
+        link = static_cast<void**>(*link);
+    }
+
+    void* chunk = *link;
+    *link = nullptr;
+    bin.count = keep;
+
+    std::size_t chunk_size = class_size(cls);
+    while (chunk) {
+        void* next = *static_cast<void**>(chunk);
+        state.container.deallocate(chunk, chunk_size);
+        chunk = next;
+    }
+}
+
+template <typename Container>
+ThreadCachedContainer<Container>::ThreadCachedContainer() : shared(std::make_shared<Shared>()) {
+    static std::atomic<std::uint64_t> next_id{0};
+    shared->id = ++next_id;
+}
+
+/**
+ * @brief Allocates from the calling thread's bin, refilling it when empty.
+ *
+ * Algorithm:
+ * 1. Requests above THREAD_CACHE_MAX_SIZE go to the container under its lock
+ * 2. Otherwise, find the size-class bin of the calling thread
+ * 3. If the bin is empty, refill it with one batch from the container
+ * 4. Pop the most recently freed chunk
+ */
+template <typename Container>
+void* ThreadCachedContainer<Container>::allocate(std::size_t bytes) {
+    if (bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+
+    if (bytes > THREAD_CACHE_MAX_SIZE) {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        return shared->container.allocate(bytes);
+    }
+
+    std::size_t cls = size_class(bytes);
+    Bin& bin = local_entry().bins[cls];
+
+    if (!bin.head) {
+        refill(bin, cls);
+    }
+
+    void* chunk = bin.head;
+    bin.head = *static_cast<void**>(chunk);
+    bin.count--;
+    return chunk;
+}
+
+template <typename Container>
+void* ThreadCachedContainer<Container>::allocate_aligned(std::size_t bytes,
+                                                         std::size_t alignment) {
+    if (alignment <= MIN_ALIGNMENT) {
+        return allocate(bytes);
+    }
+
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    return shared->container.allocate_aligned(bytes, alignment);
+}
+
+/**
+ * @brief Pushes a chunk onto the calling thread's bin, flushing when it overflows.
+ *
+ * Once a bin holds more than two batches, everything past the first batch is
+ * returned to the container in one locked pass.
+ */
+template <typename Container>
+void ThreadCachedContainer<Container>::deallocate(void* ptr, std::size_t bytes) {
+    if (bytes > THREAD_CACHE_MAX_SIZE) {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->container.deallocate(ptr, bytes);
+        return;
+    }
+
+    std::size_t cls = size_class(bytes);
+    Bin& bin = local_entry().bins[cls];
+
+    *static_cast<void**>(ptr) = bin.head;
+    bin.head = ptr;
+    bin.count++;
+
+    std::size_t batch = batch_size(cls);
+    if (bin.count > 2 * batch) {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        flush(*shared, bin, cls, batch);
+    }
+}
+
+template <typename Container>
+void ThreadCachedContainer<Container>::allocate_batch(std::size_t bytes, std::size_t count,
+                                                      void** out) {
+    if (bytes > THREAD_CACHE_MAX_SIZE) {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->container.allocate_batch(bytes, count, out);
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        out[i] = allocate(bytes);
+    }
+}
+
+template <typename Container>
+void ThreadCachedContainer<Container>::deallocate_batch(void** ptrs, std::size_t count,
+                                                        std::size_t bytes) {
+    if (bytes > THREAD_CACHE_MAX_SIZE) {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->container.deallocate_batch(ptrs, count, bytes);
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        deallocate(ptrs[i], bytes);
+    }
+}
+
+/**
+ * @brief Resizes in place, skipping the container when the size class is unchanged.
+ *
+ * A chunk served from a bin holds at least its class size, and deallocate() with
+ * the new size files it under a class no larger than that, so the chunk can be
+ * cached and reused as usual whatever size it was resized to.
+ */
+template <typename Container>
+bool ThreadCachedContainer<Container>::try_expand(void* ptr, std::size_t old_bytes,
+                                                  std::size_t new_bytes) {
+    if (new_bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+
+    if (old_bytes <= THREAD_CACHE_MAX_SIZE && new_bytes <= THREAD_CACHE_MAX_SIZE &&
+        size_class(old_bytes) == size_class(new_bytes)) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    return shared->container.try_expand(ptr, old_bytes, new_bytes);
+}
+
+template <typename Container>
+void* ThreadCachedContainer<Container>::reallocate(void* ptr, std::size_t old_bytes,
+                                                   std::size_t new_bytes) {
+    if (old_bytes > THREAD_CACHE_MAX_SIZE && new_bytes > THREAD_CACHE_MAX_SIZE) {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        return shared->container.reallocate(ptr, old_bytes, new_bytes);
+    }
+    if (try_expand(ptr, old_bytes, new_bytes)) {
+        return ptr;
+    }
+
+    void* moved = allocate(new_bytes);
+    std::memcpy(moved, ptr, std::min(old_bytes, new_bytes));
+    deallocate(ptr, old_bytes);
+    return moved;
+}
+
+template <typename Container>
+void ThreadCachedContainer<Container>::flush_thread_cache() {
+    CacheEntry& entry = local_entry();
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    for (std::size_t cls = 0; cls < THREAD_CACHE_NUM_CLASSES; cls++) {
+        flush(*shared, entry.bins[cls], cls, 0);
+    }
+}
+
+template <typename Container>
+std::size_t ThreadCachedContainer<Container>::thread_cached_count() {
+    CacheEntry& entry = local_entry();
+    std::size_t count = 0;
+    for (const Bin& bin : entry.bins) {
+        count += bin.count;
+    }
+    return count;
+}
+
+template <typename Container>
+void ThreadCachedContainer<Container>::log_container_state(std::ofstream& logfile) const {
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    shared->container.log_container_state(logfile);
+}
+}  // namespace hh::halloc
@@ -6,96 +6,301 @@
 #include "../includes/Block.hpp"
 
 #include <sys/mman.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <new>
+#include <stdexcept>
 
-#include "../includes/RBTreeDriver.hpp"
+#include "../includes/FreeIndex.hpp"
 
 namespace hh::halloc {
 
-std::size_t Block::get_actual_value(std::size_t value) const {
+template <typename FreeIndex>
+std::size_t BasicBlock<FreeIndex>::get_actual_value(std::size_t value) const {
     // Clear bits 62-63 (status and color), keep bits 0-61 (size)
     return value & ~(3ull << 62);
 }
 
-void Block::mark_as_used(std::size_t& value) const {
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::mark_as_used(std::size_t& value) const {
     // Set bit 62 to indicate allocated/used
     value |= (1ull << 62);
 }
 
-void Block::mark_as_free(std::size_t& value) const {
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::mark_as_free(std::size_t& value) const {
     // Clear bit 62 to indicate free
     value &= ~(1ull << 62);
 }
 
-bool Block::is_free(const std::size_t& value) const {
+template <typename FreeIndex>
+bool BasicBlock<FreeIndex>::is_free(const std::size_t& value) const {
     // Check if bit 62 is clear (free)
     return !(value & (1ull << 62));
 }
 
-Block::Block() : size(0), head(nullptr), rb_tree() {}
+template <typename FreeIndex>
+MemoryNode* BasicBlock<FreeIndex>::next_node(const MemoryNode* node) const {
+    // The next chunk starts right after this chunk's payload, unless the block ends there
+    auto* next = (unsigned char*)node + MEMORY_NODE_SIZE + get_actual_value(node->value);
+    return next < (unsigned char*)head + size ? (MemoryNode*)next : nullptr;
+}
 
-Block::Block(std::size_t bytes) {
-    size = bytes;
-    head = (MemoryNode*)REQUEST_MEMORY_VIA_MMAP(bytes);
+template <typename FreeIndex>
+MemoryNode* BasicBlock<FreeIndex>::prev_node(const MemoryNode* node) const {
+    // The boundary tag holds the previous chunk's size; the first chunk has none
+    if (node == head) {
+        return nullptr;
+    }
+    return (MemoryNode*)((unsigned char*)node - node->prev_size - MEMORY_NODE_SIZE);
+}
 
-    if (head == MAP_FAILED) {
-        head = nullptr;
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::update_next_prev_size(MemoryNode* node) const {
+    MemoryNode* next = next_node(node);
+    if (next) {
+        next->prev_size = get_actual_value(node->value);
+    }
+}
+
+template <typename FreeIndex>
+BasicBlock<FreeIndex>::BasicBlock()
+    : size(0),
+      head(nullptr),
+      free_chunks(),
+      free_bytes(0),
+      purge_threshold(DEFAULT_PURGE_THRESHOLD),
+      purge_granule(static_cast<std::size_t>(sysconf(_SC_PAGESIZE))),
+      reserved(0),
+      size_classes(),
+      tail(nullptr),
+      purge_decay(DEFAULT_PURGE_DECAY),
+      purge_deadline(),
+      purge_pending(false) {}
+
+template <typename FreeIndex>
+BasicBlock<FreeIndex>::BasicBlock(std::size_t bytes, std::size_t purge_threshold,
+                                  PageBacking backing, std::size_t reserve_bytes,
+                                  const SizeClasses& size_classes,
+                                  std::chrono::milliseconds purge_decay)
+    : BasicBlock(std::nothrow, bytes, purge_threshold, backing, reserve_bytes, size_classes,
+                 purge_decay) {
+    if (!size_classes.is_valid()) {
+        throw std::invalid_argument("Invalid size classes");
+    }
+    if (!head) {
         throw std::bad_alloc();
     }
+}
+
+template <typename FreeIndex>
+BasicBlock<FreeIndex>::BasicBlock(std::nothrow_t, std::size_t bytes, std::size_t purge_threshold,
+                                  PageBacking backing, std::size_t reserve_bytes,
+                                  const SizeClasses& size_classes,
+                                  std::chrono::milliseconds purge_decay)
+    : size(0),
+      head(nullptr),
+      free_chunks(),
+      free_bytes(0),
+      purge_threshold(purge_threshold),
+      purge_granule(static_cast<std::size_t>(sysconf(_SC_PAGESIZE))),
+      reserved(0),
+      size_classes(size_classes),
+      tail(nullptr),
+      purge_decay(purge_decay),
+      purge_deadline(),
+      purge_pending(false) {
+    if (!size_classes.is_valid()) {
+        return;
+    }
+
+    // Huge pages are mapped, unmapped and purged whole
+    if (backing != PageBacking::Regular) {
+        bytes = align_up(bytes, HUGE_PAGE_SIZE);
+        purge_granule = HUGE_PAGE_SIZE;
+    }
+
+    void* memory = MAP_FAILED;
+    std::size_t mapped = bytes;
+    if (reserve_bytes > bytes) {
+        // Reserve the whole range, commit the first pages only
+        bytes = align_up(bytes, purge_granule);
+        mapped = align_up(reserve_bytes, purge_granule);
+        memory = reserve_address_space(mapped, purge_granule);
+        if (memory != MAP_FAILED && mprotect(memory, bytes, PROT_READ | PROT_WRITE) != 0) {
+            RELEASE_MEMORY_VIA_MUNMAP(memory, mapped);
+            memory = MAP_FAILED;
+        }
+        if (memory != MAP_FAILED && backing != PageBacking::Regular) {
+            madvise(memory, mapped, MADV_HUGEPAGE);
+        }
+    } else {
+        memory = request_block_memory(bytes, backing);
+    }
+
+    if (memory == MAP_FAILED) {
+        return;
+    }
+    head = static_cast<MemoryNode*>(memory);
+    size = bytes;
+    reserved = mapped;
 
     // Initialize the single free node covering the entire block
+    head->prev_size = 0;
     head->value = bytes - MEMORY_NODE_SIZE;
     mark_as_free(head->value);
 
-    // Initialize linked list pointers
-    head->next = nullptr;
-    head->prev = nullptr;
-
-    // Initialize RB-tree pointers
+    // Initialize free index links
     head->left = nullptr;
     head->right = nullptr;
     head->parent = nullptr;
 
-    // Insert into RB-tree
-    rb_tree = RBTreeDriver<MemoryNode>{head};
+    // Fresh anonymous pages are not resident until touched
+    head->purged = true;
+    tail = head;
+
+    insert_free(head);
 }
 
-Block::Block(Block&& other)
-    : size(other.size), head(other.head), rb_tree(std::move(other.rb_tree)) {
+template <typename FreeIndex>
+BasicBlock<FreeIndex>::BasicBlock(BasicBlock&& other)
+    : size(other.size),
+      head(other.head),
+      free_chunks(std::move(other.free_chunks)),
+      free_bytes(other.free_bytes),
+      purge_threshold(other.purge_threshold),
+      purge_granule(other.purge_granule),
+      reserved(other.reserved),
+      size_classes(other.size_classes),
+      tail(other.tail),
+      purge_decay(other.purge_decay),
+      purge_deadline(other.purge_deadline),
+      purge_pending(other.purge_pending) {
     other.head = nullptr;
     other.size = 0;
+    other.free_bytes = 0;
+    other.reserved = 0;
+    other.tail = nullptr;
+    other.purge_pending = false;
 }
 
-Block& Block::operator=(Block&& other) {
+template <typename FreeIndex>
+BasicBlock<FreeIndex>& BasicBlock<FreeIndex>::operator=(BasicBlock&& other) {
     if (this != &other) {
         head = other.head;
         size = other.size;
-        rb_tree = std::move(other.rb_tree);
+        free_chunks = std::move(other.free_chunks);
+        free_bytes = other.free_bytes;
+        purge_threshold = other.purge_threshold;
+        purge_granule = other.purge_granule;
+        reserved = other.reserved;
+        size_classes = other.size_classes;
+        tail = other.tail;
+        purge_decay = other.purge_decay;
+        purge_deadline = other.purge_deadline;
+        purge_pending = other.purge_pending;
 
         other.head = nullptr;
         other.size = 0;
+        other.free_bytes = 0;
+        other.reserved = 0;
+        other.tail = nullptr;
+        other.purge_pending = false;
     }
     return *this;
 }
 
-MemoryNode* Block::best_fit(std::size_t bytes) {
-    // Find smallest free node >= bytes using RB-tree
-    MemoryNode* node =
-        rb_tree.lower_bound(bytes, [](std::size_t a, std::size_t b) { return (a) <= (b); });
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::insert_free(MemoryNode* node) {
+    free_chunks.insert(node);
+    free_bytes += get_actual_value(node->value);
+}
+
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::remove_free(MemoryNode* node) {
+    free_chunks.remove(node);
+    free_bytes -= get_actual_value(node->value);
+}
+
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::rekey_free(MemoryNode* node, MemoryNode* new_node,
+                                       std::size_t new_size) {
+    free_bytes -= get_actual_value(node->value);
+    free_chunks.rekey(node, new_node, new_size);
+    free_bytes += new_size;
+}
+
+template <typename FreeIndex>
+MemoryNode* BasicBlock<FreeIndex>::best_fit(std::size_t bytes) {
+    std::size_t rounded = size_classes.round(bytes);
+    MemoryNode* node = free_chunks.find_fit(rounded);
+    if (!node && rounded != bytes) {
+        node = free_chunks.find_fit(bytes);
+    }
     return node;
 }
 
+template <typename FreeIndex>
+std::size_t BasicBlock<FreeIndex>::largest_free_size() const {
+    MemoryNode* node = free_chunks.max();
+    return node ? get_actual_value(node->value) : 0;
+}
+
+/**
+ * @brief Computes the leading padding needed to align a node's payload.
+ *
+ * The payload can only move forward in steps that leave room for a new header in
+ * front of it, and the skipped region must stay a usable free node with at least
+ * MIN_CHUNK_PAYLOAD bytes of payload. So the aligned payload address p is the first
+ * multiple of `alignment` with p >= payload + MEMORY_NODE_SIZE + MIN_CHUNK_PAYLOAD.
+ */
+template <typename FreeIndex>
+std::size_t BasicBlock<FreeIndex>::aligned_padding(const MemoryNode* node,
+                                                   std::size_t alignment) const {
+    auto payload = reinterpret_cast<std::uintptr_t>(node) + MEMORY_NODE_SIZE;
+    if (payload % alignment == 0) {
+        return 0;
+    }
+    return align_up(payload + MEMORY_NODE_SIZE + MIN_CHUNK_PAYLOAD, alignment) - payload;
+}
+
+/**
+ * @brief Finds a free node able to serve an aligned request.
+ *
+ * The plain best fit is used when its payload can be aligned within its size; this
+ * keeps the common case (payload already aligned) as tight as best_fit. Otherwise
+ * the search is repeated for the worst-case padding, which any node can absorb.
+ */
+template <typename FreeIndex>
+MemoryNode* BasicBlock<FreeIndex>::best_fit_aligned(std::size_t bytes, std::size_t alignment) {
+    MemoryNode* node = best_fit(bytes);
+    if (!node || alignment <= MIN_ALIGNMENT) {
+        return node;
+    }
+    if (aligned_padding(node, alignment) + bytes <= get_actual_value(node->value)) {
+        return node;
+    }
+    return best_fit(bytes + alignment + MEMORY_NODE_SIZE + MIN_CHUNK_PAYLOAD);
+}
+
 /**
  * @brief Allocates memory from a specific free node.
  *
  * This function performs the final allocation step after best_fit has found a suitable node:
- * 1. Removes the node from the RB-tree of free blocks
- * 2. Splits the node if it's larger than needed (via shrink_then_align)
- * 3. Marks the node as used
- * 4. Returns pointer to usable memory (after metadata)
+ * 1. Round the request like shrink_then_align does
+ * 2. If the tail would be smaller than min_remainder, remove it from the free index
+ * 3. Otherwise the remainder after the request takes over the node's entry in the
+ *    free index (rekey), which keeps its place there whenever its smaller size
+ *    does not change its order, e.g. when carving from the largest free chunk
+ * 4. Mark the node as used and return pointer to usable memory (after metadata)
+ *
+ * The remainder's header lies past the node's free index links (the request is at
+ * least MIN_CHUNK_PAYLOAD bytes), so the links are intact until rekey has read them.
  *
  * @param bytes Number of bytes requested by user (excluding metadata)
  * @param node Free node to allocate from (must be large enough)
@@ -105,21 +310,76 @@ MemoryNode* Block::best_fit(std::size_t bytes) {
  * @pre is_free(node->value) == true
  * @pre get_actual_value(node->value) >= bytes
  * @post is_free(node->value) == false (node marked as used)
- * @post If node was split, a new free node exists in RB-tree
+ * @post If node was split, a new free node exists in the free index
  */
-void* Block::allocate(std::size_t bytes, MemoryNode* node) {
+template <typename FreeIndex>
+void* BasicBlock<FreeIndex>::allocate(std::size_t bytes, MemoryNode* node) {
     // Calculate pointer to usable memory (skip metadata)
     void* actual_mem = (void*)((char*)node + MEMORY_NODE_SIZE);
 
-    // Remove from RB-tree (will be marked as used)
-    rb_tree.remove(node);
+    std::size_t node_size = get_actual_value(node->value);
+    bytes = chunk_size(bytes, node_size);
+    if (node_size < bytes + MEMORY_NODE_SIZE + size_classes.min_remainder) {
+        remove_free(node);
+        mark_as_used(node->value);
+        return actual_mem;
+    }
 
-    // Split node if large enough, mark as used
-    shrink_then_align(node, bytes);
+    // The remainder inherits the node's free index entry and its purged flag
+    auto* rest = (MemoryNode*)((unsigned char*)node + MEMORY_NODE_SIZE + bytes);
+    bool purged = node->purged;
+    rekey_free(node, rest, node_size - bytes - MEMORY_NODE_SIZE);
+    rest->prev_size = bytes;
+    rest->purged = purged;
+    update_next_prev_size(rest);
+    if (node == tail) {
+        tail = rest;
+    }
 
+    node->value = bytes;
+    mark_as_used(node->value);
     return actual_mem;
 }
 
+/**
+ * @brief Allocates aligned memory from a specific free node.
+ *
+ * Algorithm:
+ * 1. Compute the padding that moves the payload to an aligned address
+ * 2. If there is none, this is a regular allocate()
+ * 3. Otherwise split the node at the padding: the leading part stays a free node
+ *    in the free index (re-keyed to its smaller size), the trailing part starts at
+ *    the aligned payload and is allocated (and split again) like a regular node
+ *
+ * @pre node was returned by best_fit_aligned(bytes, alignment)
+ */
+template <typename FreeIndex>
+void* BasicBlock<FreeIndex>::allocate_aligned(std::size_t bytes, std::size_t alignment,
+                                              MemoryNode* node) {
+    std::size_t padding = alignment > MIN_ALIGNMENT ? aligned_padding(node, alignment) : 0;
+    if (padding == 0) {
+        return allocate(bytes, node);
+    }
+
+    std::size_t node_size = get_actual_value(node->value);
+    MemoryNode* aligned_node = (MemoryNode*)((unsigned char*)node + padding);
+
+    // The leading part keeps its header and becomes a smaller free node
+    rekey_free(node, node, padding - MEMORY_NODE_SIZE);
+
+    aligned_node->prev_size = padding - MEMORY_NODE_SIZE;
+    aligned_node->value = node_size - padding;
+    aligned_node->purged = node->purged;
+    update_next_prev_size(aligned_node);
+    if (node == tail) {
+        tail = aligned_node;
+    }
+
+    shrink_then_align(aligned_node, bytes);
+
+    return (void*)((char*)aligned_node + MEMORY_NODE_SIZE);
+}
+
 /**
  * @brief Deallocates previously allocated memory and merges with adjacent free blocks.
  *
@@ -127,7 +387,7 @@ void* Block::allocate(std::size_t bytes, MemoryNode* node) {
  * 1. Converts user pointer back to MemoryNode pointer
  * 2. Marks the node as free
  * 3. Attempts to merge with adjacent free blocks (coalescing)
- * 4. Inserts the (possibly merged) node into RB-tree
+ * 4. Inserts the (possibly merged) node into the free index
  *
  * Coalescing reduces fragmentation by combining adjacent free blocks into larger blocks.
  *
@@ -138,15 +398,16 @@ void* Block::allocate(std::size_t bytes, MemoryNode* node) {
  * @pre ptr was previously returned by allocate()
  * @pre The block containing this node has not been destroyed
  * @post Node is marked as free
- * @post Node is inserted into RB-tree (possibly merged with neighbors)
+ * @post Node is inserted into the free index (possibly merged with neighbors)
  * @post Adjacent free blocks are coalesced if possible
  */
-void Block::deallocate(void* ptr, [[maybe_unused]] std::size_t bytes) {
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::deallocate(void* ptr, [[maybe_unused]] std::size_t bytes) {
     MemoryNode* node = (MemoryNode*)((char*)ptr - MEMORY_NODE_SIZE);
 
     mark_as_free(node->value);
 
-    // Merge with adjacent free blocks and insert into RB-tree
+    // Merge with adjacent free blocks and insert into the free index
     coalesce_nodes(node);
 }
 
@@ -154,84 +415,243 @@ void Block::deallocate(void* ptr, [[maybe_unused]] std::size_t bytes) {
  * @brief Splits a node if it's significantly larger than requested size.
  *
  * Algorithm:
- * 1. Check if remainder after allocation is large enough (>= MEMORY_NODE_SIZE + 1)
- * 2. If yes:
+ * 1. Round the request with size_classes (a multiple of granule >= MIN_ALIGNMENT),
+ *    so the remainder node (and the payload that will later be carved from it)
+ *    stays aligned (and at least MIN_CHUNK_PAYLOAD, so the chunk can hold tree links
+ *    once freed); a node smaller than the rounded size is used whole
+ * 2. Check if remainder after allocation is large enough
+ *    (>= MEMORY_NODE_SIZE + size_classes.min_remainder)
+ * 3. If yes:
  *    a. Create new MemoryNode in the remainder space
- *    b. Initialize new node's metadata (size, RB-tree pointers, linked-list pointers)
- *    c. Update doubly-linked list to insert new node after current
+ *    b. Initialize new node's header (size, boundary tag)
+ *    c. Update the boundary tag of the chunk after the new node
  *    d. Shrink current node's size to requested bytes
- *    e. Insert new free node into RB-tree
- * 3. Mark current node as used
+ *    e. Insert new free node into the free index
+ * 4. Mark current node as used
  *
  * This prevents internal fragmentation by returning excess memory to the free pool.
  *
- * @param node Node to potentially split (already removed from RB-tree)
+ * @param node Node to potentially split (already removed from the free index)
  * @param bytes Requested allocation size (excluding metadata)
  *
  * @pre node != nullptr
- * @pre node is not in RB-tree (must be removed before calling)
+ * @pre node is not in the free index (must be removed before calling)
  * @pre get_actual_value(node->value) >= bytes
- * @post node->value == bytes (or original size if no split occurred)
+ * @post node->value == size_classes.round(bytes) (or original size if no split occurred)
  * @post is_free(node->value) == false
- * @post If split occurred, a new free node exists in RB-tree and linked list
+ * @post If split occurred, a new free node exists in the free index
  *
- * @note Minimum split size: MEMORY_NODE_SIZE + 1 (metadata + at least 1 byte)
+ * @note Minimum split size: MEMORY_NODE_SIZE + size_classes.min_remainder
  */
-void Block::shrink_then_align(MemoryNode* node, std::size_t bytes) {
-    std::size_t node_size = get_actual_value(node->value);
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::shrink_then_align(MemoryNode* node, std::size_t bytes) {
+    bytes = chunk_size(bytes, get_actual_value(node->value));
 
     // Split only if remainder is large enough for a new node
-    if (node_size >= bytes + MEMORY_NODE_SIZE + 1ull) {
-        // Create new free node in the remainder space
-        MemoryNode* new_node = (MemoryNode*)((unsigned char*)node + MEMORY_NODE_SIZE + bytes);
-        std::size_t new_node_size = node_size - bytes - MEMORY_NODE_SIZE;
+    MemoryNode* new_node = split_off(node, bytes);
+    if (new_node) {
+        // The remainder's pages lie inside the original node's, so they stay purged
+        new_node->purged = node->purged;
+
+        // Insert remainder into the free index as free node
+        insert_free(new_node);
+    }
+
+    // Mark current node as used
+    mark_as_used(node->value);
+}
+
+template <typename FreeIndex>
+MemoryNode* BasicBlock<FreeIndex>::split_off(MemoryNode* node, std::size_t bytes) {
+    std::size_t node_size = get_actual_value(node->value);
+    if (node_size < bytes + MEMORY_NODE_SIZE + size_classes.min_remainder) {
+        return nullptr;
+    }
+
+    // Create new free node in the remainder space
+    MemoryNode* new_node = (MemoryNode*)((unsigned char*)node + MEMORY_NODE_SIZE + bytes);
+    new_node->value = node_size - bytes - MEMORY_NODE_SIZE;
+    mark_as_free(new_node->value);
+    new_node->prev_size = bytes;
+
+    // The chunk after the remainder now has the remainder as its neighbour
+    update_next_prev_size(new_node);
+    if (node == tail) {
+        tail = new_node;
+    }
+
+    node->value = bytes;
+    return new_node;
+}
+
+/**
+ * @brief Splits a free node into `count` used chunks and a free remainder.
+ *
+ * Every chunk but the last is cut off the front of what remains of the node; the
+ * remainder after the last one inherits the node's purged flag, like the remainder
+ * of a single allocation.
+ */
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::carve(MemoryNode* node, std::size_t bytes, std::size_t count,
+                                  void** out) {
+    bool purged = node->purged;
+    remove_free(node);
+
+    for (std::size_t i = 0; i + 1 < count; i++) {
+        out[i] = (unsigned char*)node + MEMORY_NODE_SIZE;
+        MemoryNode* rest = split_off(node, bytes);
+        mark_as_used(node->value);
+        node = rest;
+    }
+
+    out[count - 1] = (unsigned char*)node + MEMORY_NODE_SIZE;
+    MemoryNode* rest = split_off(node, bytes);
+    if (rest) {
+        rest->purged = purged;
+        insert_free(rest);
+    }
+    mark_as_used(node->value);
+}
 
-        mark_as_free(new_node_size);
+/**
+ * @brief Allocates a batch of equal-sized chunks from as few free nodes as possible.
+ *
+ * Algorithm:
+ * 1. Round the size like allocate() does; `k` chunks then span
+ *    k * (bytes + MEMORY_NODE_SIZE) - MEMORY_NODE_SIZE bytes of payload
+ * 2. Take the best fit for all remaining chunks, or else the largest free node
+ * 3. Carve as many chunks as that node holds; repeat until done or the largest
+ *    free node cannot hold a single chunk
+ */
+template <typename FreeIndex>
+std::size_t BasicBlock<FreeIndex>::allocate_batch(std::size_t bytes, std::size_t count,
+                                                  void** out) {
+    bytes = size_classes.round(bytes);
+    std::size_t stride = bytes + MEMORY_NODE_SIZE;
+
+    std::size_t done = 0;
+    while (done < count) {
+        std::size_t remaining = count - done;
+        MemoryNode* node = best_fit(remaining * stride - MEMORY_NODE_SIZE);
+        if (!node) {
+            node = free_chunks.max();
+        }
+        if (!node || get_actual_value(node->value) < bytes) {
+            break;
+        }
 
-        new_node->value = new_node_size;
+        std::size_t fits = (get_actual_value(node->value) + MEMORY_NODE_SIZE) / stride;
+        std::size_t taken = std::min(remaining, fits);
+        carve(node, bytes, taken, out + done);
+        done += taken;
+    }
+    return done;
+}
 
-        // Initialize RB-tree pointers
-        new_node->left = nullptr;
-        new_node->right = nullptr;
-        new_node->parent = nullptr;
+/**
+ * @brief Frees sorted chunks, merging each run of neighbours before coalescing it.
+ *
+ * Algorithm:
+ * 1. Mark the next chunk free
+ * 2. While the following pointer is the chunk right after it, absorb that chunk
+ *    (its header becomes payload of the run)
+ * 3. Coalesce the run with its free neighbours, which also updates the boundary
+ *    tag after it, purges it if it is large enough, and inserts it into the free index
+ */
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::deallocate_batch(void* const* ptrs, std::size_t count) {
+    std::size_t i = 0;
+    while (i < count) {
+        MemoryNode* node = (MemoryNode*)((char*)ptrs[i] - MEMORY_NODE_SIZE);
+        mark_as_free(node->value);
+        i++;
+
+        while (i < count) {
+            MemoryNode* next = next_node(node);
+            if (!next || (char*)next + MEMORY_NODE_SIZE != (char*)ptrs[i]) {
+                break;
+            }
+            if (next == tail) {
+                tail = node;
+            }
+            node->value =
+                get_actual_value(node->value) + MEMORY_NODE_SIZE + get_actual_value(next->value);
+            i++;
+        }
 
-        // Update doubly-linked list
-        new_node->next = node->next;
-        new_node->prev = node;
+        coalesce_nodes(node);
+    }
+}
 
-        if (node->next) {
-            node->next->prev = new_node;
+/**
+ * @brief Resizes a used chunk in place.
+ *
+ * Algorithm:
+ * 1. Round the new size like allocate() does
+ * 2. Growing: if the next chunk is free and large enough for the size rounded to
+ *    MIN_ALIGNMENT, remove it from the free index, absorb it, then split off (and
+ *    re-insert) what the size class does not need.
+ *    The split-off part lies inside the absorbed chunk, so it keeps its purged flag
+ * 3. Shrinking: split off the unused tail and coalesce it like a freed chunk; its
+ *    pages held user data, so it starts out not purged
+ */
+template <typename FreeIndex>
+bool BasicBlock<FreeIndex>::try_expand(void* ptr, std::size_t bytes) {
+    MemoryNode* node = (MemoryNode*)((char*)ptr - MEMORY_NODE_SIZE);
+    std::size_t node_size = get_actual_value(node->value);
+    std::size_t needed = std::max(align_up(bytes, MIN_ALIGNMENT), MIN_CHUNK_PAYLOAD);
+
+    if (needed > node_size) {
+        MemoryNode* next = next_node(node);
+        if (!next || !is_free(next->value) ||
+            node_size + MEMORY_NODE_SIZE + get_actual_value(next->value) < needed) {
+            return false;
         }
 
-        node->next = new_node;
-        node->value = bytes;
+        bool purged = next->purged;
+        remove_free(next);
+        if (next == tail) {
+            tail = node;
+        }
+        node->value = node_size + MEMORY_NODE_SIZE + get_actual_value(next->value);
+        update_next_prev_size(node);
 
-        // Insert remainder into RB-tree as free node
-        rb_tree.insert(new_node);
+        MemoryNode* rest = split_off(node, chunk_size(bytes, get_actual_value(node->value)));
+        if (rest) {
+            rest->purged = purged;
+            insert_free(rest);
+        }
+        mark_as_used(node->value);
+        return true;
     }
 
-    // Mark current node as used
+    MemoryNode* rest = split_off(node, chunk_size(bytes, node_size));
     mark_as_used(node->value);
+    if (rest) {
+        rest->purged = false;
+        coalesce_nodes(rest);
+    }
+    return true;
 }
 
 /**
  * @brief Attempts to merge (coalesce) a free node with adjacent free blocks.
  *
  * Algorithm:
- * 1. Forward merge: If next node exists and is free:
- *    a. Remove next node from RB-tree (critical: do this BEFORE modifying)
- *    b. Add next node's size + metadata to current node's size
- *    c. Update linked list to skip next node
- *    d. Update next->next->prev if it exists
- *
- * 2. Backward merge: If previous node exists and is free:
- *    a. Remove previous node from RB-tree (critical: do this BEFORE modifying)
- *    b. Add current node's size + metadata to previous node's size
- *    c. Update linked list to skip current node
- *    d. Update current->next->prev if it exists
- *    e. Set current node pointer to previous node
+ * 1. Forward merge: if the next node is free, absorb it (its header becomes payload)
+ * 2. Backward merge: if the previous node (found via prev_size) is free, it absorbs
+ *    the current node, which continues as the previous node
+ * 3. Update the boundary tag of the chunk after the merged node
+ * 4. Enter the merged node into the free index: it takes over the entry of a merged
+ *    neighbour (rekey, the larger one if both were free, the other is removed) or
+ *    is inserted if no neighbour was free
+ * 5. Purge its pages if it reached the purge threshold: at once with a purge decay
+ *    of 0, otherwise once the decay has passed (see defer_purge)
  *
- * 3. Insert the (possibly merged) node into RB-tree
+ * Taking over a neighbour's entry costs no rebalancing when the merged size keeps
+ * the neighbour's order. Every header involved lies outside the other nodes' free
+ * index links, so the links are intact until the free index has read them; the
+ * purge runs last because it may release the pages holding a neighbour's links.
  *
  * This function reduces fragmentation by combining adjacent free blocks.
  *
@@ -239,70 +659,229 @@ void Block::shrink_then_align(MemoryNode* node, std::size_t bytes) {
  *
  * @pre node != nullptr
  * @pre is_free(node->value) == true
- * @pre node is NOT in RB-tree yet
- * @post node (or merged node) is inserted into RB-tree
+ * @pre node is NOT in the free index yet
+ * @post node (or merged node) is in the free index
  * @post Adjacent free blocks are merged if they existed
- * @post Linked list is updated to reflect any merges
+ * @post Boundary tags are updated to reflect any merges
  */
-void Block::coalesce_nodes(MemoryNode* node) {
-    // Forward merge: merge with next node if it's free
-    if (node->next && is_free(node->next->value)) {
-        MemoryNode* next_node = node->next;
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::coalesce_nodes(MemoryNode* node) {
+    // Purged neighbours keep their pages purged, so only the rest must be purged
+    std::uintptr_t clean_until = 0;
+    std::uintptr_t clean_from = 0;
 
-        rb_tree.remove(next_node);
+    std::size_t merged_size = get_actual_value(node->value);
+    MemoryNode* entry = nullptr;  // Merged neighbour whose free index entry is reused
 
-        node->value =
-            get_actual_value(node->value) + get_actual_value(next_node->value) + MEMORY_NODE_SIZE;
+    // Forward merge: merge with next node if it's free
+    MemoryNode* next = next_node(node);
+    if (next && is_free(next->value)) {
+        if (next->purged) {
+            clean_from = reinterpret_cast<std::uintptr_t>(next) + sizeof(MemoryNode);
+        }
+        if (next == tail) {
+            tail = node;
+        }
+        merged_size += MEMORY_NODE_SIZE + get_actual_value(next->value);
+        entry = next;
+    }
 
-        mark_as_free(node->value);
+    // Backward merge: merge with previous node if it's free
+    MemoryNode* prev = prev_node(node);
+    if (prev && is_free(prev->value)) {
+        if (prev->purged) {
+            clean_until = reinterpret_cast<std::uintptr_t>(node);
+        }
+        if (node == tail) {
+            tail = prev;
+        }
+        merged_size += MEMORY_NODE_SIZE + get_actual_value(prev->value);
+
+        // Keep the entry of the larger neighbour, whose order is closer to the merged size
+        if (!entry || get_actual_value(prev->value) >= get_actual_value(entry->value)) {
+            if (entry) {
+                remove_free(entry);
+            }
+            entry = prev;
+        } else {
+            remove_free(prev);
+        }
 
-        // Update linked list
-        node->next = next_node->next;
+        // Continue with merged node
+        node = prev;
+    }
 
-        if (node->next) {
-            node->next->prev = node;
-        }
+    if (entry) {
+        rekey_free(entry, node, merged_size);
+    } else {
+        insert_free(node);
     }
 
-    // Backward merge: merge with previous node if it's free
-    if (node->prev && is_free(node->prev->value)) {
-        MemoryNode* prev_node = node->prev;
+    // The chunk after the merged node must see its new size
+    update_next_prev_size(node);
 
-        rb_tree.remove(prev_node);
+    if (purge_decay.count() == 0) {
+        purge_free_pages(node, clean_until, clean_from);
+    } else {
+        defer_purge(node);
+    }
+}
 
-        prev_node->value =
-            get_actual_value(prev_node->value) + get_actual_value(node->value) + MEMORY_NODE_SIZE;
+/**
+ * @brief Leaves a merged node's pages resident until the purge decay has passed.
+ *
+ * The purged flag cannot describe a node that is purged only in part, so a node
+ * that absorbed freed pages counts as dirty as a whole. The first large dirty node
+ * arms the deadline; the first merge after it purges the whole block. A tight
+ * alloc/free loop next to a large free chunk therefore costs one clock read per
+ * free and one purge per decay, instead of a madvise and page faults per free.
+ */
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::defer_purge(MemoryNode* node) {
+    node->purged = false;
+    if (purge_threshold == 0) {
+        return;
+    }
+
+    bool large = get_actual_value(node->value) >= purge_threshold;
+    if (!large && !purge_pending) {
+        return;
+    }
 
-        mark_as_free(prev_node->value);
+    auto now = std::chrono::steady_clock::now();
+    if (!purge_pending) {
+        purge_pending = true;
+        purge_deadline = now + purge_decay;
+    } else if (now >= purge_deadline) {
+        purge();
+    }
+}
 
-        // Update linked list
-        prev_node->next = node->next;
+/**
+ * @brief Purges every dirty free chunk of the block in one pass over its chunks.
+ *
+ * Free chunks are never adjacent, so each one is purged on its own. Purging a chunk
+ * whose pages were partly purged already only repeats the madvise on those pages.
+ */
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::purge() {
+    purge_pending = false;
+    if (!head || purge_threshold == 0) {
+        return;
+    }
 
-        if (prev_node->next) {
-            prev_node->next->prev = prev_node;
+    for (MemoryNode* node = head; node; node = next_node(node)) {
+        if (is_free(node->value) && !node->purged) {
+            purge_free_pages(node, 0, 0);
         }
+    }
+}
 
-        // Continue with merged node
-        node = prev_node;
+/**
+ * @brief Releases the resident pages of a large free node with MADV_DONTNEED.
+ *
+ * Only whole pages strictly inside the payload, past the tree links and purged
+ * flag, are released, so the node's header and the next chunk's header stay
+ * resident. MADV_DONTNEED (rather than MADV_FREE) drops the pages from RSS right
+ * away; they read back as zeros when the chunk is reused. Huge-page-backed blocks
+ * purge whole huge pages only, so a purge never splits a huge page in use.
+ *
+ * Algorithm:
+ * 1. Nodes below purge_threshold are only marked as not purged
+ * 2. Compute the page-aligned interior of the node
+ * 3. Shrink it by the parts that belonged to purged neighbours
+ * 4. madvise what remains and mark the node as purged
+ */
+template <typename FreeIndex>
+void BasicBlock<FreeIndex>::purge_free_pages(MemoryNode* node, std::uintptr_t clean_until,
+                                             std::uintptr_t clean_from) {
+    std::size_t node_size = get_actual_value(node->value);
+    if (purge_threshold == 0 || node_size < purge_threshold) {
+        node->purged = false;
+        return;
+    }
+
+    std::size_t page_size = purge_granule;
+    auto address = reinterpret_cast<std::uintptr_t>(node);
+    std::uintptr_t begin = align_up(address + sizeof(MemoryNode), page_size);
+    std::uintptr_t end = (address + MEMORY_NODE_SIZE + node_size) & ~(page_size - 1);
+
+    // A purged neighbour's interior ends/starts at a page boundary of its own
+    if (clean_until) {
+        begin = std::max(begin, clean_until & ~(page_size - 1));
+    }
+    if (clean_from) {
+        end = std::min(end, align_up(clean_from, page_size));
     }
 
-    // Insert merged node into RB-tree
-    rb_tree.insert(node);
+    if (begin < end) {
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+    }
+    node->purged = true;
+}
+
+/**
+ * @brief Commits the next part of the reservation and hands it to the last chunk.
+ *
+ * Algorithm:
+ * 1. Make the pages after the committed range writable with mprotect
+ * 2. If the last chunk is free, enlarge it (re-inserting it into the free index)
+ * 3. Otherwise create a new free chunk covering the new pages
+ *
+ * Freshly committed pages have never been touched, so the purged flag of an
+ * enlarged chunk stays valid and a new chunk starts out purged.
+ */
+template <typename FreeIndex>
+bool BasicBlock<FreeIndex>::grow(std::size_t bytes) {
+    std::size_t delta = align_up(bytes, purge_granule);
+    if (!head || delta > reserved - size) {
+        return false;
+    }
+
+    auto* end = (unsigned char*)head + size;
+    if (mprotect(end, delta, PROT_READ | PROT_WRITE) != 0) {
+        return false;
+    }
+    size += delta;
+
+    if (is_free(tail->value)) {
+        remove_free(tail);
+        tail->value = get_actual_value(tail->value) + delta;
+        mark_as_free(tail->value);
+        insert_free(tail);
+        return true;
+    }
+
+    MemoryNode* node = (MemoryNode*)end;
+    node->prev_size = get_actual_value(tail->value);
+    node->value = delta - MEMORY_NODE_SIZE;
+    mark_as_free(node->value);
+    node->purged = true;
+    tail = node;
+    insert_free(node);
+    return true;
 }
 
 /**
  * @brief Destructor - releases the entire memory block back to the OS.
  *
- * Uses munmap to return the entire mmap'd region to the operating system.
+ * Uses munmap to return the entire mmap'd region (including any reserved but
+ * uncommitted address space) to the operating system.
  * This deallocates all memory nodes at once, regardless of individual allocation status.
  *
  * @post All memory in this Block is returned to OS
  * @post head pointer is invalid after this call
  */
-Block::~Block() {
+template <typename FreeIndex>
+BasicBlock<FreeIndex>::~BasicBlock() {
     if (head) {
-        RELEASE_MEMORY_VIA_MUNMAP(head, size);
+        RELEASE_MEMORY_VIA_MUNMAP(head, reserved);
     }
 }
 
+template class BasicBlock<RBTreeIndex<MemoryNode>>;
+template class BasicBlock<AddressOrderedIndex<MemoryNode>>;
+template class BasicBlock<TlsfIndex<MemoryNode>>;
+template class BasicBlock<SegregatedFitIndex<MemoryNode>>;
+
 };  // namespace hh::halloc
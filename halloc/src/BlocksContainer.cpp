@@ -0,0 +1,352 @@
+/**
+ * @file BlocksContainer.cpp
+ * @brief Implementation of DynamicBlocksContainer
+ */
+
+#include "../includes/BlocksContainer.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace hh::halloc {
+
+DynamicBlocksContainer::DynamicBlocksContainer(const ContainerConfig& config)
+    : config(config), blocks(nullptr), num_blocks(0), capacity(0),
+      next_block_size(config.initial_block_size) {
+    if (config.initial_block_size < MEMORY_NODE_SIZE + MIN_CHUNK_PAYLOAD) {
+        throw std::invalid_argument("Initial block size cannot hold a chunk");
+    }
+    if (config.max_block_size < config.initial_block_size) {
+        throw std::invalid_argument("Max block size must be >= initial block size");
+    }
+    if (config.growth_factor == 0) {
+        throw std::invalid_argument("Growth factor must be positive");
+    }
+
+    create_block(config.initial_block_size);
+}
+
+DynamicBlocksContainer::~DynamicBlocksContainer() {
+    for (std::size_t i = 0; i < num_blocks; i++) {
+        blocks[i].~Block();
+    }
+    if (blocks) {
+        RELEASE_MEMORY_VIA_MUNMAP(blocks, capacity * sizeof(Block));
+    }
+}
+
+/**
+ * @brief Moves every block into a table twice as large.
+ *
+ * Moving a Block only transfers its head pointer and RB-tree root, so the chunks
+ * themselves (and therefore the page map tags) are untouched.
+ */
+void DynamicBlocksContainer::grow_table() {
+    std::size_t grown_capacity = capacity ? 2 * capacity : 4;
+    if (config.max_blocks) {
+        grown_capacity = std::min(grown_capacity, config.max_blocks);
+    }
+
+    void* memory = REQUEST_MEMORY_VIA_MMAP(grown_capacity * sizeof(Block));
+    if (memory == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    free_index.reserve(grown_capacity);
+
+    auto* grown = static_cast<Block*>(memory);
+    for (std::size_t i = 0; i < num_blocks; i++) {
+        new (&grown[i]) Block(std::move(blocks[i]));
+        blocks[i].~Block();
+    }
+
+    if (blocks) {
+        RELEASE_MEMORY_VIA_MUNMAP(blocks, capacity * sizeof(Block));
+    }
+    blocks = grown;
+    capacity = grown_capacity;
+}
+
+/**
+ * @brief Creates the next block of the growth sequence.
+ *
+ * Block sizes follow initial_block_size * growth_factor^n, capped at max_block_size.
+ * A request larger than the next size gets a block of its own size (rounded up to
+ * whole pages) without advancing the sequence further than one step.
+ */
+bool DynamicBlocksContainer::create_block(std::size_t needed) {
+    if (config.max_blocks && num_blocks >= config.max_blocks) {
+        return false;
+    }
+    if (num_blocks == capacity) {
+        grow_table();
+    }
+
+    std::size_t size = next_block_size;
+    if (needed > size) {
+        std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        size = std::min(align_up(needed, page_size), config.max_block_size);
+    }
+
+    // The whole reservation is tagged up front, so growing in place needs no tagging
+    new (&blocks[num_blocks]) Block(size, config.purge_threshold, config.backing,
+                                    config.reserve_block_size, config.size_classes,
+                                    config.purge_decay);
+    if (!page_map.try_set_range(blocks[num_blocks].get_head(),
+                                blocks[num_blocks].get_reserved_size(),
+                                static_cast<std::uintptr_t>(num_blocks) + 1)) {
+        // Unmap the untagged block so the slot is free for the next attempt
+        blocks[num_blocks].~Block();
+        throw std::bad_alloc();
+    }
+    free_index.update(num_blocks, blocks[num_blocks].largest_free_size());
+    num_blocks++;
+
+    advance_block_size();
+    return true;
+}
+
+bool DynamicBlocksContainer::grow_last_block(std::size_t needed) {
+    Block& last = blocks[num_blocks - 1];
+    std::size_t room = last.get_reserved_size() - last.get_size();
+    if (room < needed) {
+        return false;
+    }
+
+    if (!last.grow(std::min(std::max(needed, next_block_size), room))) {
+        return false;
+    }
+    free_index.update(num_blocks - 1, last.largest_free_size());
+
+    advance_block_size();
+    return true;
+}
+
+void DynamicBlocksContainer::advance_block_size() {
+    // Saturate at max_block_size instead of overflowing
+    if (next_block_size > config.max_block_size / config.growth_factor) {
+        next_block_size = config.max_block_size;
+    } else {
+        next_block_size = std::min(next_block_size * config.growth_factor, config.max_block_size);
+    }
+}
+
+/**
+ * @brief Finds a free node in the first block that can serve the request.
+ *
+ * Algorithm:
+ * 1. Ask the free index for the first block whose largest free node >= bytes
+ * 2. Search that block's RB-tree for the best fit at the requested alignment
+ * 3. If alignment padding made the block unusable, retry steps 1-2 with the
+ *    worst-case padded size, which any block passing step 1 can always serve
+ *
+ * Blocks are filled in index order, which keeps later blocks empty for as long as
+ * possible instead of comparing best fits across every block.
+ */
+std::pair<std::size_t, MemoryNode*> DynamicBlocksContainer::best_fit(std::size_t bytes,
+                                                                     std::size_t alignment) {
+    std::size_t index = free_index.find_first(bytes);
+    if (index == free_index.NOT_FOUND) {
+        return {std::numeric_limits<std::size_t>::max(), nullptr};
+    }
+
+    MemoryNode* node = blocks[index].best_fit_aligned(bytes, alignment);
+    if (!node) {
+        index = free_index.find_first(bytes + alignment + MEMORY_NODE_SIZE + MIN_CHUNK_PAYLOAD);
+        if (index == free_index.NOT_FOUND) {
+            return {std::numeric_limits<std::size_t>::max(), nullptr};
+        }
+        node = blocks[index].best_fit_aligned(bytes, alignment);
+    }
+
+    return {index, node};
+}
+
+void* DynamicBlocksContainer::allocate(std::size_t bytes) {
+    return allocate_aligned(bytes, MIN_ALIGNMENT);
+}
+
+/**
+ * @brief Allocates aligned memory from the container.
+ *
+ * The default allocate() path is this function with MIN_ALIGNMENT, which every
+ * Block payload already satisfies, so only over-aligned requests pay for padding.
+ * A new block is sized for the worst-case padding, so it can always serve the
+ * request that created it.
+ */
+void* DynamicBlocksContainer::allocate_aligned(std::size_t bytes, std::size_t alignment) {
+    if (bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        throw std::invalid_argument("Alignment must be a power of two");
+    }
+
+    // Bytes a fresh block needs to serve the request, header and padding included
+    std::size_t worst_padding =
+        alignment > MIN_ALIGNMENT ? alignment + MEMORY_NODE_SIZE + MIN_CHUNK_PAYLOAD : 0;
+    std::size_t needed = config.size_classes.round(bytes) + worst_padding + MEMORY_NODE_SIZE;
+    if (needed > config.max_block_size) {
+        return LargeMappingCache::instance().allocate(bytes, alignment);
+    }
+
+    auto [index, node] = best_fit(bytes, alignment);
+
+    // No suitable node found in existing blocks: grow the last one in place
+    if (!node && grow_last_block(needed)) {
+        index = num_blocks - 1;
+        node = blocks[index].best_fit_aligned(bytes, alignment);
+    }
+
+    // Otherwise try to create a new block
+    if (!node && create_block(needed)) {
+        index = num_blocks - 1;
+        node = blocks[index].best_fit_aligned(bytes, alignment);
+    }
+
+    // Use a dedicated mapping if no block can serve the request; deallocate() hands
+    // pointers that the page map does not attribute to a block back to the cache
+    if (!node) {
+        return LargeMappingCache::instance().allocate(bytes, alignment);
+    }
+
+    void* ptr = blocks[index].allocate_aligned(bytes, alignment, node);
+    free_index.update(index, blocks[index].largest_free_size());
+    return ptr;
+}
+
+/**
+ * @brief Deallocates memory by finding the owning block.
+ *
+ * Algorithm:
+ * 1. Look up the page of ptr: every page of block i is tagged with i + 1
+ * 2. If tagged, call blocks[tag - 1].deallocate()
+ * 3. Otherwise the pointer is a large mapping and goes back to the LargeMappingCache
+ */
+void DynamicBlocksContainer::deallocate(void* ptr, std::size_t bytes) {
+    std::uintptr_t owner = page_map.get(ptr);
+    if (owner) {
+        blocks[owner - 1].deallocate(ptr, bytes);
+        free_index.update(owner - 1, blocks[owner - 1].largest_free_size());
+        return;
+    }
+
+    LargeMappingCache::instance().deallocate(ptr);
+}
+
+/**
+ * @brief Fills `out` block by block, growing the container only when all are full.
+ *
+ * Algorithm:
+ * 1. Ask the free index for a block whose largest node holds every remaining chunk,
+ *    or else any block that holds one
+ * 2. Carve as many chunks from it as it can give
+ * 3. If no block has room, allocate one chunk through allocate(), which grows the
+ *    last block, creates a new one or falls back to a large mapping
+ */
+void DynamicBlocksContainer::allocate_batch(std::size_t bytes, std::size_t count, void** out) {
+    if (bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+
+    std::size_t chunk = config.size_classes.round(bytes);
+    std::size_t done = 0;
+    while (done < count) {
+        std::size_t span = (count - done) * (chunk + MEMORY_NODE_SIZE) - MEMORY_NODE_SIZE;
+        std::size_t index = free_index.find_first(span);
+        if (index == free_index.NOT_FOUND) {
+            index = free_index.find_first(chunk);
+        }
+        if (index == free_index.NOT_FOUND) {
+            out[done++] = allocate(bytes);
+            continue;
+        }
+
+        done += blocks[index].allocate_batch(bytes, count - done, out + done);
+        free_index.update(index, blocks[index].largest_free_size());
+    }
+}
+
+/**
+ * @brief Sorts the pointers, then frees each block's share in one pass.
+ *
+ * Blocks occupy disjoint address ranges, so after sorting the pointers of one block
+ * are contiguous; each run is found with page map lookups and freed together, and
+ * the free index is updated once per run. Large mappings go back one by one.
+ */
+void DynamicBlocksContainer::deallocate_batch(void** ptrs, std::size_t count,
+                                              [[maybe_unused]] std::size_t bytes) {
+    std::sort(ptrs, ptrs + count, std::less<void*>());
+
+    std::size_t i = 0;
+    while (i < count) {
+        std::uintptr_t owner = page_map.get(ptrs[i]);
+        if (!owner) {
+            LargeMappingCache::instance().deallocate(ptrs[i++]);
+            continue;
+        }
+
+        std::size_t end = i + 1;
+        while (end < count && page_map.get(ptrs[end]) == owner) {
+            end++;
+        }
+        blocks[owner - 1].deallocate_batch(ptrs + i, end - i);
+        free_index.update(owner - 1, blocks[owner - 1].largest_free_size());
+        i = end;
+    }
+}
+
+bool DynamicBlocksContainer::try_expand(void* ptr, [[maybe_unused]] std::size_t old_bytes,
+                                        std::size_t new_bytes) {
+    if (new_bytes < 1) {
+        throw std::invalid_argument("Bytes must be positive");
+    }
+
+    std::uintptr_t owner = page_map.get(ptr);
+    if (!owner) {
+        return LargeMappingCache::instance().try_expand(ptr, new_bytes);
+    }
+
+    if (!blocks[owner - 1].try_expand(ptr, new_bytes)) {
+        return false;
+    }
+    free_index.update(owner - 1, blocks[owner - 1].largest_free_size());
+    return true;
+}
+
+void* DynamicBlocksContainer::reallocate(void* ptr, std::size_t old_bytes, std::size_t new_bytes) {
+    if (try_expand(ptr, old_bytes, new_bytes)) {
+        return ptr;
+    }
+    if (!page_map.get(ptr)) {
+        return LargeMappingCache::instance().reallocate(ptr, new_bytes);
+    }
+
+    void* moved = allocate(new_bytes);
+    std::memcpy(moved, ptr, std::min(old_bytes, new_bytes));
+    deallocate(ptr, old_bytes);
+    return moved;
+}
+
+void DynamicBlocksContainer::log_container_state(std::ofstream& logfile) const {
+    logfile << "=================================================\n";
+    logfile << "BlocksContainer State:\n";
+    logfile << "Total Blocks: " << num_blocks << "\n";
+    for (std::size_t i = 0; i < num_blocks; i++) {
+        logfile << "---------------- Block " << i << " ----------------\n";
+        blocks[i].log_block_state(logfile);
+        logfile << "---------------- End Block " << i << " ----------------\n";
+    }
+    logfile << "=================================================\n\n";
+}
+};  // namespace hh::halloc
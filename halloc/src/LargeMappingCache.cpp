@@ -0,0 +1,254 @@
+/**
+ * @file LargeMappingCache.cpp
+ * @brief Implementation of LargeMappingCache
+ */
+
+#include "../includes/LargeMappingCache.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+
+namespace hh::halloc {
+
+LargeMappingCache::LargeMappingCache(std::size_t max_cached_bytes,
+                                     std::chrono::milliseconds decay)
+    : buckets(), cached_bytes(0), max_cached_bytes(max_cached_bytes), decay(decay) {}
+
+LargeMappingCache::~LargeMappingCache() {
+    purge();
+}
+
+/**
+ * @brief Returns the shared cache, constructed on first use and never destroyed.
+ *
+ * Containers with static storage duration may release large mappings while the
+ * program exits, so the shared cache must outlive every static destructor.
+ */
+LargeMappingCache& LargeMappingCache::instance() {
+    alignas(LargeMappingCache) static unsigned char storage[sizeof(LargeMappingCache)];
+    static LargeMappingCache* cache = new (storage) LargeMappingCache();
+    return *cache;
+}
+
+/**
+ * @brief Rounds a size up to its size class.
+ *
+ * A size in [2^k, 2^(k+1)) is rounded up to a multiple of 2^k / CLASSES_PER_DOUBLING,
+ * after rounding to whole pages, so the worst-case waste is a quarter of the request.
+ */
+std::size_t LargeMappingCache::size_class(std::size_t bytes) {
+    std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    bytes = align_up(bytes, page_size);
+
+    std::size_t step = std::bit_floor(bytes) / CLASSES_PER_DOUBLING;
+    return step > page_size ? align_up(bytes, step) : bytes;
+}
+
+std::size_t LargeMappingCache::bucket_of(std::size_t mapped) {
+    std::size_t doubling = std::bit_floor(mapped);
+    std::size_t index = (mapped - doubling) * CLASSES_PER_DOUBLING / doubling;
+    return (std::bit_width(mapped) - 1) * CLASSES_PER_DOUBLING + index;
+}
+
+void LargeMappingCache::release(void* ptr, std::size_t mapped) {
+    registry.set_range(ptr, 1, 0);
+    RELEASE_MEMORY_VIA_MUNMAP(ptr, mapped);
+}
+
+void LargeMappingCache::remove_entry(std::size_t bucket, std::size_t index) {
+    Bucket& b = buckets[bucket];
+    for (std::size_t i = index + 1; i < b.count; i++) {
+        b.entries[i - 1] = b.entries[i];
+    }
+    b.count--;
+}
+
+void LargeMappingCache::evict_older_than(Clock::time_point cutoff) {
+    for (std::size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        // Entries are kept oldest first, so stale ones are at the front
+        while (buckets[bucket].count && buckets[bucket].entries[0].freed < cutoff) {
+            void* ptr = buckets[bucket].entries[0].ptr;
+            std::size_t mapped = registry.get(ptr);
+            remove_entry(bucket, 0);
+            cached_bytes -= mapped;
+            release(ptr, mapped);
+        }
+    }
+}
+
+void LargeMappingCache::make_room(std::size_t incoming) {
+    while (cached_bytes && cached_bytes + incoming > max_cached_bytes) {
+        // Find the globally oldest entry: the oldest of each bucket is its first
+        std::size_t oldest = NUM_BUCKETS;
+        for (std::size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+            if (buckets[bucket].count &&
+                (oldest == NUM_BUCKETS ||
+                 buckets[bucket].entries[0].freed < buckets[oldest].entries[0].freed)) {
+                oldest = bucket;
+            }
+        }
+
+        void* ptr = buckets[oldest].entries[0].ptr;
+        std::size_t mapped = registry.get(ptr);
+        remove_entry(oldest, 0);
+        cached_bytes -= mapped;
+        release(ptr, mapped);
+    }
+}
+
+/**
+ * @brief Serves a large request from the cache, or maps a new size-class mapping.
+ *
+ * Algorithm:
+ * 1. Reject requests larger than half the address space, which no mapping can
+ *    satisfy and whose size class would have no bucket; round the rest up to
+ *    their size class
+ * 2. Reuse the most recently freed cached mapping of that class whose address
+ *    satisfies the alignment
+ * 3. Otherwise drop decayed cache entries and map a new mapping of the class size,
+ *    tagging its first page in the registry
+ */
+void* LargeMappingCache::allocate(std::size_t bytes, std::size_t alignment,
+                                 std::nothrow_t) noexcept {
+    if (bytes > (std::size_t{1} << (PageMap::ADDRESS_BITS - 1))) {
+        return nullptr;
+    }
+    std::size_t mapped = size_class(bytes);
+    std::size_t bucket = bucket_of(mapped);
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        Bucket& b = buckets[bucket];
+        for (std::size_t i = b.count; i-- > 0;) {
+            void* ptr = b.entries[i].ptr;
+            if (reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0) {
+                remove_entry(bucket, i);
+                cached_bytes -= mapped;
+                return ptr;
+            }
+        }
+        evict_older_than(Clock::now() - decay);
+    }
+
+    void* ptr = request_aligned_memory_via_mmap(mapped, alignment);
+    if (ptr == MAP_FAILED) {
+        return nullptr;
+    }
+    if (!registry.try_set_range(ptr, 1, mapped)) {
+        RELEASE_MEMORY_VIA_MUNMAP(ptr, mapped);
+        return nullptr;
+    }
+    return ptr;
+}
+
+void* LargeMappingCache::allocate(std::size_t bytes, std::size_t alignment) {
+    void* ptr = allocate(bytes, alignment, std::nothrow);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+/**
+ * @brief Caches a freed mapping, evicting decayed and, if needed, the oldest entries.
+ *
+ * Mappings larger than the whole cache are unmapped right away; a full bucket
+ * unmaps its oldest entry to make room for the new one. Pointers the registry does
+ * not know have no size class, so they are left alone.
+ */
+void LargeMappingCache::deallocate(void* ptr) {
+    std::size_t mapped = registry.get(ptr);
+    if (mapped == 0) {
+        return;
+    }
+    std::size_t bucket = bucket_of(mapped);
+
+    if (mapped <= max_cached_bytes) {
+        std::lock_guard<std::mutex> guard(lock);
+        Clock::time_point now = Clock::now();
+        evict_older_than(now - decay);
+        make_room(mapped);
+
+        Bucket& b = buckets[bucket];
+        if (b.count == BUCKET_CAPACITY) {
+            void* oldest = b.entries[0].ptr;
+            remove_entry(bucket, 0);
+            cached_bytes -= mapped;
+            release(oldest, mapped);
+        }
+        b.entries[b.count++] = Entry{ptr, now};
+        cached_bytes += mapped;
+        return;
+    }
+
+    release(ptr, mapped);
+}
+
+/**
+ * @brief Grows a mapping with mremap (without MREMAP_MAYMOVE) or trims its tail.
+ *
+ * Only the registry entry of the mapping changes, and only the caller holds the
+ * mapping, so no lock is needed.
+ */
+bool LargeMappingCache::try_expand(void* ptr, std::size_t bytes) {
+    std::size_t mapped = registry.get(ptr);
+    if (mapped == 0) {
+        return false;
+    }
+    std::size_t resized = size_class(bytes);
+    if (resized == mapped) {
+        return true;
+    }
+
+    if (resized < mapped) {
+        RELEASE_MEMORY_VIA_MUNMAP(static_cast<unsigned char*>(ptr) + resized, mapped - resized);
+    } else if (mremap(ptr, mapped, resized, 0) == MAP_FAILED) {
+        return false;
+    }
+    registry.set_range(ptr, 1, resized);
+    return true;
+}
+
+/**
+ * @brief Resizes a mapping, letting the kernel move its pages when it must grow.
+ *
+ * MREMAP_MAYMOVE relocates the page table entries rather than the data, so even a
+ * moved mapping costs no copy.
+ */
+void* LargeMappingCache::reallocate(void* ptr, std::size_t bytes) {
+    if (try_expand(ptr, bytes)) {
+        return ptr;
+    }
+
+    std::size_t mapped = registry.get(ptr);
+    if (mapped == 0) {
+        throw std::invalid_argument("Pointer is not a large mapping");
+    }
+    std::size_t resized = size_class(bytes);
+    void* moved = mremap(ptr, mapped, resized, MREMAP_MAYMOVE);
+    if (moved == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    registry.set_range(ptr, 1, 0);
+    registry.set_range(moved, 1, resized);
+    return moved;
+}
+
+void LargeMappingCache::purge() {
+    std::lock_guard<std::mutex> guard(lock);
+    evict_older_than(Clock::time_point::max());
+}
+
+std::size_t LargeMappingCache::get_cached_bytes() {
+    std::lock_guard<std::mutex> guard(lock);
+    return cached_bytes;
+}
+}  // namespace hh::halloc
@@ -1,5 +1,15 @@
 #pragma once
 
 #include "./halloc/includes/Block.hpp"
+#include "./halloc/includes/BlockFreeIndex.hpp"
 #include "./halloc/includes/BlocksContainer.hpp"
-#include "./halloc/includes/Halloc.hpp"
\ No newline at end of file
+#include "./halloc/includes/ConcurrentBlocksContainer.hpp"
+#include "./halloc/includes/FreeIndex.hpp"
+#include "./halloc/includes/Halloc.hpp"
+#include "./halloc/includes/LargeMappingCache.hpp"
+#include "./halloc/includes/MemoryResource.hpp"
+#include "./halloc/includes/PageMap.hpp"
+#include "./halloc/includes/PerCpuBlocksContainer.hpp"
+#include "./halloc/includes/SlabContainer.hpp"
+#include "./halloc/includes/RemoteFreeQueue.hpp"
+#include "./halloc/includes/ThreadCache.hpp"
@@ -0,0 +1,390 @@
+/**
+ * @file halloc_malloc.cpp
+ * @brief malloc/free and global operator new/delete replacement on top of Halloc.
+ *
+ * Built as libhalloc_malloc.so. Loading it with LD_PRELOAD (or linking it ahead of
+ * libc) routes every heap allocation of an unmodified program through one
+ * ConcurrentBlocksContainer:
+ *
+ * @code
+ * LD_PRELOAD=/path/to/libhalloc_malloc.so ./program
+ * @endcode
+ *
+ * Exported symbols are the set glibc documents as replaceable: malloc, free, calloc,
+ * realloc, reallocarray, posix_memalign, aligned_alloc, memalign, valloc, pvalloc and
+ * malloc_usable_size, plus every form of the global operator new and delete.
+ *
+ * Free pages are purged like in any ConcurrentBlocksContainer (see PurgeConfig). Two
+ * environment variables, read once when the first allocation creates the engine,
+ * override the defaults:
+ * - HALLOC_PURGE_THRESHOLD: smallest free chunk, in bytes, whose pages are returned
+ *   to the OS (0 disables purging)
+ * - HALLOC_PURGE_DECAY_MS: how long such a chunk stays resident before it is purged
+ *   (0 purges it as soon as it forms)
+ *
+ * free() gets no size. The allocation size is read back from the allocation itself:
+ * chunks inside a block carry their payload size in the MemoryNode header just
+ * before the pointer, and dedicated large mappings are recorded with their mapped
+ * size in the LargeMappingCache registry.
+ *
+ * The engine must not itself call malloc. It is constructed on first use in static
+ * storage and never destroyed, so it survives static destruction of the program. It
+ * only uses mmap, mutexes and trivially destructible thread-local state. Running out
+ * of memory is reported by the engine with nullptr, never with an exception: the
+ * exception object would be allocated through malloc again, possibly while the
+ * engine holds its growth mutex. C callers get nullptr with errno set to ENOMEM.
+ *
+ * @note fork() while another thread holds a block lock leaves that lock held in the
+ *       child, as with any lock-based allocator without fork handlers; children
+ *       that only exec are unaffected
+ */
+
+#include <errno.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include "halloc/includes/Block.hpp"
+#include "halloc/includes/BlocksContainer.hpp"
+#include "halloc/includes/ConcurrentBlocksContainer.hpp"
+#include "halloc/includes/LargeMappingCache.hpp"
+
+/// Marks the replaced functions as exported; everything else is built hidden
+#define HALLOC_EXPORT __attribute__((visibility("default")))
+
+namespace hh::halloc {
+namespace {
+
+constexpr std::size_t INTERPOSER_BLOCK_SIZE = 64 * 1024 * 1024;  ///< 64 MiB per block
+constexpr int INTERPOSER_MAX_BLOCKS = 256;  ///< 16 GiB in blocks, large mappings beyond
+
+using Engine = ConcurrentBlocksContainer<INTERPOSER_BLOCK_SIZE, INTERPOSER_MAX_BLOCKS>;
+
+/**
+ * @brief Reads a non-negative decimal number from the environment.
+ *
+ * Uses getenv and strtoull only, neither of which allocates.
+ *
+ * @return The variable's value, or fallback if it is unset or not a number
+ */
+std::size_t environment_value(const char* name, std::size_t fallback) {
+    const char* text = std::getenv(name);
+    if (!text || *text < '0' || *text > '9') {
+        return fallback;
+    }
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    return *end == '\0' ? static_cast<std::size_t>(value) : fallback;
+}
+
+/**
+ * @brief Builds the engine's purge policy from HALLOC_PURGE_THRESHOLD and
+ *        HALLOC_PURGE_DECAY_MS.
+ */
+PurgeConfig purge_config_from_environment() {
+    PurgeConfig purge;
+    purge.threshold = environment_value("HALLOC_PURGE_THRESHOLD", purge.threshold);
+    purge.decay = std::chrono::milliseconds(environment_value(
+        "HALLOC_PURGE_DECAY_MS", static_cast<std::size_t>(purge.decay.count())));
+    return purge;
+}
+
+/**
+ * @brief Returns the container serving every allocation, constructed on first use.
+ *
+ * Like LargeMappingCache::instance(), the engine lives in static storage and is
+ * never destroyed: pointers may be freed by static destructors or other libraries
+ * after main returns.
+ */
+Engine& engine() {
+    alignas(Engine) static unsigned char storage[sizeof(Engine)];
+    static Engine* instance = new (storage) Engine(purge_config_from_environment());
+    return *instance;
+}
+
+/**
+ * @brief Checks that alignment is a power of two.
+ */
+bool valid_alignment(std::size_t alignment) {
+    return alignment != 0 && (alignment & (alignment - 1)) == 0;
+}
+
+/**
+ * @brief Allocates `bytes` bytes aligned to `alignment`, never throwing.
+ *
+ * @param bytes Requested size; 0 is served as one byte so every call returns a
+ *              distinct pointer
+ * @param alignment Power-of-two alignment
+ * @return Pointer to the allocation, or nullptr with errno = ENOMEM
+ */
+void* allocate(std::size_t bytes, std::size_t alignment) noexcept {
+    // Like glibc, refuse sizes whose pointer differences would overflow
+    if (bytes > static_cast<std::size_t>(PTRDIFF_MAX)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    // The engine returns nullptr when it runs out of memory; only its construction
+    // (mapping the first block) throws
+    try {
+        void* ptr = alignment > MIN_ALIGNMENT
+                        ? engine().allocate_aligned(bytes ? bytes : 1, alignment)
+                        : engine().allocate(bytes ? bytes : 1);
+        if (ptr) {
+            return ptr;
+        }
+    } catch (...) {
+    }
+    errno = ENOMEM;
+    return nullptr;
+}
+
+/**
+ * @brief Gets the number of usable bytes of an allocation.
+ *
+ * Large mappings report their mapped size; block chunks report their payload
+ * size, which may exceed the request by the rounding and an unsplit remainder.
+ *
+ * @pre ptr was returned by allocate()
+ */
+std::size_t usable_size(void* ptr) noexcept {
+    if (std::size_t mapped = LargeMappingCache::instance().mapping_size(ptr)) {
+        return mapped;
+    }
+    auto* node = reinterpret_cast<MemoryNode*>(static_cast<char*>(ptr) - MEMORY_NODE_SIZE);
+    return get_actual_value(node->value);
+}
+
+/**
+ * @brief Frees an allocation, taking its size from the allocation itself.
+ */
+void deallocate(void* ptr) noexcept {
+    if (ptr) {
+        engine().deallocate(ptr, usable_size(ptr));
+    }
+}
+
+/**
+ * @brief Resizes an allocation in place when possible, otherwise moves it.
+ * @return Resized allocation, or nullptr with errno = ENOMEM and ptr untouched
+ */
+void* reallocate(void* ptr, std::size_t bytes) noexcept {
+    if (!ptr) {
+        return allocate(bytes, MIN_ALIGNMENT);
+    }
+    if (bytes == 0) {
+        deallocate(ptr);
+        return nullptr;
+    }
+    if (bytes > static_cast<std::size_t>(PTRDIFF_MAX)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    try {
+        return engine().reallocate(ptr, usable_size(ptr), bytes);
+    } catch (...) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+}
+
+/**
+ * @brief Allocation loop of the throwing operator new forms.
+ *
+ * Calls the installed new_handler until the allocation succeeds, and throws
+ * std::bad_alloc when there is no handler.
+ */
+void* allocate_or_throw(std::size_t bytes, std::size_t alignment) {
+    while (true) {
+        void* ptr = allocate(bytes, alignment);
+        if (ptr) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+}  // namespace
+}  // namespace hh::halloc
+
+namespace halloc = hh::halloc;
+
+// ==================== C ALLOCATION FUNCTIONS ====================
+
+extern "C" {
+
+HALLOC_EXPORT void* malloc(std::size_t bytes) noexcept {
+    return halloc::allocate(bytes, halloc::MIN_ALIGNMENT);
+}
+
+HALLOC_EXPORT void free(void* ptr) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void* calloc(std::size_t count, std::size_t size) noexcept {
+    std::size_t bytes = 0;
+    if (__builtin_mul_overflow(count, size, &bytes)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    void* ptr = halloc::allocate(bytes, halloc::MIN_ALIGNMENT);
+    if (ptr) {
+        std::memset(ptr, 0, bytes);
+    }
+    return ptr;
+}
+
+HALLOC_EXPORT void* realloc(void* ptr, std::size_t bytes) noexcept {
+    return halloc::reallocate(ptr, bytes);
+}
+
+HALLOC_EXPORT void* reallocarray(void* ptr, std::size_t count, std::size_t size) noexcept {
+    std::size_t bytes = 0;
+    if (__builtin_mul_overflow(count, size, &bytes)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return halloc::reallocate(ptr, bytes);
+}
+
+HALLOC_EXPORT int posix_memalign(void** out, std::size_t alignment, std::size_t bytes) noexcept {
+    if (!halloc::valid_alignment(alignment) || alignment % sizeof(void*) != 0) {
+        return EINVAL;
+    }
+    int saved = errno;
+    void* ptr = halloc::allocate(bytes, alignment);
+    errno = saved;
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+HALLOC_EXPORT void* aligned_alloc(std::size_t alignment, std::size_t bytes) noexcept {
+    if (!halloc::valid_alignment(alignment)) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return halloc::allocate(bytes, alignment);
+}
+
+// Like glibc, memalign rounds an alignment that is not a power of two up to one
+HALLOC_EXPORT void* memalign(std::size_t alignment, std::size_t bytes) noexcept {
+    if (alignment > std::numeric_limits<std::size_t>::max() / 2 + 1) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return halloc::allocate(bytes, std::bit_ceil(alignment));
+}
+
+HALLOC_EXPORT void* valloc(std::size_t bytes) noexcept {
+    return halloc::allocate(bytes, static_cast<std::size_t>(sysconf(_SC_PAGESIZE)));
+}
+
+HALLOC_EXPORT void* pvalloc(std::size_t bytes) noexcept {
+    auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return halloc::allocate((bytes + page - 1) & ~(page - 1), page);
+}
+
+HALLOC_EXPORT std::size_t malloc_usable_size(void* ptr) noexcept {
+    return ptr ? halloc::usable_size(ptr) : 0;
+}
+
+}  // extern "C"
+
+// ==================== GLOBAL OPERATOR NEW / DELETE ====================
+
+HALLOC_EXPORT void* operator new(std::size_t bytes) {
+    return halloc::allocate_or_throw(bytes, halloc::MIN_ALIGNMENT);
+}
+
+HALLOC_EXPORT void* operator new[](std::size_t bytes) {
+    return halloc::allocate_or_throw(bytes, halloc::MIN_ALIGNMENT);
+}
+
+HALLOC_EXPORT void* operator new(std::size_t bytes, std::align_val_t alignment) {
+    return halloc::allocate_or_throw(bytes, static_cast<std::size_t>(alignment));
+}
+
+HALLOC_EXPORT void* operator new[](std::size_t bytes, std::align_val_t alignment) {
+    return halloc::allocate_or_throw(bytes, static_cast<std::size_t>(alignment));
+}
+
+HALLOC_EXPORT void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept {
+    return halloc::allocate(bytes, halloc::MIN_ALIGNMENT);
+}
+
+HALLOC_EXPORT void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept {
+    return halloc::allocate(bytes, halloc::MIN_ALIGNMENT);
+}
+
+HALLOC_EXPORT void* operator new(std::size_t bytes, std::align_val_t alignment,
+                                 const std::nothrow_t&) noexcept {
+    return halloc::allocate(bytes, static_cast<std::size_t>(alignment));
+}
+
+HALLOC_EXPORT void* operator new[](std::size_t bytes, std::align_val_t alignment,
+                                   const std::nothrow_t&) noexcept {
+    return halloc::allocate(bytes, static_cast<std::size_t>(alignment));
+}
+
+HALLOC_EXPORT void operator delete(void* ptr) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete[](void* ptr) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete(void* ptr, std::size_t) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete[](void* ptr, std::size_t) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete(void* ptr, std::align_val_t) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete[](void* ptr, std::align_val_t) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    halloc::deallocate(ptr);
+}
+
+HALLOC_EXPORT void operator delete[](void* ptr, std::align_val_t,
+                                     const std::nothrow_t&) noexcept {
+    halloc::deallocate(ptr);
+}
@@ -24,24 +24,45 @@
 #include <cstddef>
 
 namespace hh::rb_tree {
+/**
+ * @brief Default node ordering: by value, excluding the color bit
+ *
+ * Any stateless functor with the same call signature can be passed to insert()
+ * instead; it is a template argument, so comparisons are inlined.
+ */
+struct ValueLess {
+    template <typename RbNode>
+    bool operator()(const RbNode* a, const RbNode* b) const;
+};
+
+/**
+ * @brief Default lower_bound predicate: a node of value `node_value` satisfies `key`
+ *        iff key <= node_value
+ */
+struct KeyLessEqual {
+    bool operator()(std::size_t key, std::size_t node_value) const { return key <= node_value; }
+};
+
 /**
  * @brief Inserts a new node into the Red-Black tree
  *
  * Inserts the given node into the tree and rebalances to maintain
- * Red-Black tree properties. The node is inserted based on its value
- * (excluding the color bit).
+ * Red-Black tree properties. The node is placed according to `less`, by default
+ * its value (excluding the color bit).
  *
  * @tparam RbNode Node type with left, right, parent pointers and value field
+ * @tparam Less Functor ordering two nodes: less(a, b) is true if a goes before b
  * @param root Reference to the root pointer of the tree
  * @param new_node Pointer to the node to be inserted (must be allocated)
+ * @param less Node ordering (must match the one the tree was built with)
  *
  * @pre new_node must be properly allocated and initialized
  * @pre new_node->value must have bit 63 available for coloring
  * @post Tree maintains Red-Black properties
  * @post root may be modified if tree structure changes
  */
-template <typename RbNode>
-void insert(RbNode*& root, RbNode* new_node);
+template <typename RbNode, typename Less = ValueLess>
+void insert(RbNode*& root, RbNode* new_node, Less less = Less{});
 
 /**
  * @brief Removes a node from the Red-Black tree
@@ -62,24 +83,102 @@ void insert(RbNode*& root, RbNode* new_node);
 template <typename RbNode>
 void remove(RbNode*& root, RbNode* node);
 
+/**
+ * @brief Puts a node that is not in the tree in the place of one that is
+ *
+ * The new node takes over the old node's parent, children and color, so the tree
+ * shape and its Red-Black properties are unchanged and no rebalancing is needed.
+ *
+ * @tparam RbNode Node type with left, right, parent pointers and value field
+ * @param root Reference to the root pointer of the tree
+ * @param old_node Node in the tree
+ * @param new_node Node not in the tree
+ *
+ * @pre new_node orders exactly where old_node does (e.g. an equal value), or its
+ *      value is set with update_key() right after
+ * @post old_node is no longer in the tree (its links are left unchanged)
+ */
+template <typename RbNode>
+void replace(RbNode*& root, RbNode* old_node, RbNode* new_node);
+
 /**
  * @brief Finds the smallest node with value >= key
  *
- * Performs a lower_bound search using a custom comparator function.
- * Returns the node with the smallest value that is not less than the key.
+ * Performs a lower_bound search using a comparator functor (or function pointer).
+ * Returns the leftmost node whose value satisfies cmp(key, value).
  *
  * @tparam RbNode Node type with left, right, parent pointers and value field
+ * @tparam Compare Callable as bool(std::size_t key, std::size_t node_value)
  * @param root Pointer to the root of the tree
  * @param key The search key value
- * @param cmp Comparator function returning true if first arg < second arg
+ * @param cmp Returns true if a node of the given value satisfies the key (key <= value
+ *            by default); must be monotonic in the value along the tree order
  *
  * @return Pointer to the found node, or nullptr if no such node exists
  *
- * @pre cmp must define a strict weak ordering
+ * @post Tree structure remains unchanged
+ */
+template <typename RbNode, typename Compare = KeyLessEqual>
+RbNode* lower_bound(RbNode* root, std::size_t key, Compare cmp = Compare{});
+
+/**
+ * @brief Finds the node with the largest value
+ *
+ * @tparam RbNode Node type with left, right, parent pointers and value field
+ * @param root Pointer to the root of the tree
+ *
+ * @return Pointer to the rightmost node, or nullptr if the tree is empty
+ *
  * @post Tree structure remains unchanged
  */
 template <typename RbNode>
-RbNode* lower_bound(RbNode* root, std::size_t key, bool (*cmp)(std::size_t, std::size_t));
+RbNode* maximum(RbNode* root);
+
+/**
+ * @brief Finds the in-order predecessor of a node
+ *
+ * @tparam RbNode Node type with left, right, parent pointers and value field
+ * @param node Node in the tree
+ *
+ * @return Pointer to the node just before node in tree order, or nullptr if node
+ *         is the leftmost node
+ *
+ * @post Tree structure remains unchanged
+ */
+template <typename RbNode>
+RbNode* predecessor(RbNode* node);
+
+/**
+ * @brief Finds the in-order successor of a node
+ *
+ * @tparam RbNode Node type with left, right, parent pointers and value field
+ * @param node Node in the tree
+ *
+ * @return Pointer to the node just after node in tree order, or nullptr if node
+ *         is the rightmost node
+ *
+ * @post Tree structure remains unchanged
+ */
+template <typename RbNode>
+RbNode* successor(RbNode* node);
+
+/**
+ * @brief Changes the value of a node in the tree, moving it only if its order changes
+ *
+ * @tparam RbNode Node type with left, right, parent pointers and value field
+ * @tparam Less Node ordering functor (the one the tree was built with)
+ * @param root Reference to the root pointer of the tree
+ * @param node Node in the tree
+ * @param new_value New value (bit 63 clear; the node keeps its color)
+ * @param less Node ordering
+ *
+ * @return true if the node kept its place, false if it was removed and re-inserted
+ *
+ * @post node->value holds new_value and the tree is ordered by less
+ * @post Red-Black properties are maintained
+ */
+template <typename RbNode, typename Less = ValueLess>
+bool update_key(RbNode*& root, RbNode* node, std::size_t new_value, Less less = Less{});
 }  // namespace hh::rb_tree
 
 namespace hh::rb_tree {
@@ -291,11 +390,16 @@ void fix_insert(RbNode*& root, RbNode* z) {
     set_color_black(root->value);
 }
 
+template <typename RbNode>
+bool ValueLess::operator()(const RbNode* a, const RbNode* b) const {
+    return get_value(a->value) < get_value(b->value);
+}
+
 /**
  * @brief Inserts a new node into the Red-Black tree
  *
- * Performs standard BST insertion based on node values (excluding color bit),
- * then calls fix_insert to restore Red-Black properties.
+ * Performs standard BST insertion ordered by `less` (node values excluding the
+ * color bit by default), then calls fix_insert to restore Red-Black properties.
  *
  * Algorithm:
  * 1. Find the correct position using BST search
@@ -303,8 +407,10 @@ void fix_insert(RbNode*& root, RbNode* z) {
  * 3. Fix any Red-Black violations
  *
  * @tparam RbNode Node type
+ * @tparam Less Node ordering functor
  * @param root Reference to the root pointer
  * @param new_node The node to insert (must be allocated)
+ * @param less Node ordering
  *
  * @pre new_node is properly allocated
  * @pre new_node->value has bit 63 available for coloring
@@ -314,27 +420,23 @@ void fix_insert(RbNode*& root, RbNode* z) {
  *
  * @note Duplicate values are inserted to the right
  */
-template <typename RbNode>
-void insert(RbNode*& root, RbNode* new_node) {
+template <typename RbNode, typename Less>
+void insert(RbNode*& root, RbNode* new_node, Less less) {
     RbNode* y = nullptr;
     RbNode* x = root;
-
-    std::size_t new_val = get_value(new_node->value);
+    bool go_left = false;
 
     while (x) {
         y = x;
-        std::size_t curr_val = get_value(x->value);
-        if (new_val < curr_val)
-            x = x->left;
-        else
-            x = x->right;
+        go_left = less(new_node, x);
+        x = go_left ? x->left : x->right;
     }
 
     new_node->parent = y;
 
     if (!y)
         root = new_node;
-    else if (new_val < get_value(y->value))
+    else if (go_left)
         y->left = new_node;
     else
         y->right = new_node;
@@ -560,6 +662,33 @@ void remove(RbNode*& root, RbNode* z) {
     }
 }
 
+/**
+ * @brief Puts new_node in old_node's place
+ *
+ * Algorithm:
+ * 1. Point old_node's parent (or the root) at new_node
+ * 2. Copy old_node's links to new_node and point its children back at new_node
+ * 3. Copy old_node's color
+ *
+ * @note Time complexity: O(1)
+ */
+template <typename RbNode>
+void replace(RbNode*& root, RbNode* old_node, RbNode* new_node) {
+    transplant(root, old_node, new_node);
+
+    new_node->left = old_node->left;
+    new_node->right = old_node->right;
+    if (new_node->left)
+        new_node->left->parent = new_node;
+    if (new_node->right)
+        new_node->right->parent = new_node;
+
+    if (is_red(old_node->value))
+        set_color_red(new_node->value);
+    else
+        set_color_black(new_node->value);
+}
+
 /**
  * @brief Finds the first node with value not less than the search key
  *
@@ -576,20 +705,20 @@ void remove(RbNode*& root, RbNode* z) {
  * 4. Return the smallest valid node found
  *
  * @tparam RbNode Node type
+ * @tparam Compare Callable as bool(std::size_t key, std::size_t node_value)
  * @param root Pointer to the root of the tree
  * @param value The search key
- * @param cmp Comparator function (returns true if first < second)
+ * @param cmp Returns true if a node of the given value satisfies the key
  *
  * @return Pointer to the first node >= value, or nullptr if none exists
  *
- * @pre cmp defines a strict weak ordering
  * @post Tree structure is unchanged
  *
  * @note Time complexity: O(log n) for balanced tree
  * @note Returns nullptr if all values are less than the search key
  */
-template <typename RbNode>
-RbNode* lower_bound(RbNode* root, std::size_t value, bool (*cmp)(std::size_t, std::size_t)) {
+template <typename RbNode, typename Compare>
+RbNode* lower_bound(RbNode* root, std::size_t value, Compare cmp) {
     auto current = root;
     RbNode* result = nullptr;
     while (current) {
@@ -603,4 +732,103 @@ RbNode* lower_bound(RbNode* root, std::size_t value, bool (*cmp)(std::size_t, st
     }
     return result;
 }
+
+/**
+ * @brief Finds the node with the largest value
+ *
+ * Duplicates are inserted to the right, so the rightmost node is the last of
+ * the largest values.
+ *
+ * @note Time complexity: O(log n) for balanced tree
+ */
+template <typename RbNode>
+RbNode* maximum(RbNode* root) {
+    if (!root)
+        return nullptr;
+    while (root->right)
+        root = root->right;
+    return root;
+}
+
+/**
+ * @brief Finds the in-order predecessor of a node
+ *
+ * Algorithm:
+ * 1. If the node has a left subtree, return its rightmost node
+ * 2. Otherwise climb until coming up from a right child; that parent is the answer
+ *
+ * @note Time complexity: O(log n) worst case, O(1) for the maximum of a Red-Black
+ *       tree, whose left subtree has at most one (red) node
+ */
+template <typename RbNode>
+RbNode* predecessor(RbNode* node) {
+    if (node->left)
+        return maximum(node->left);
+
+    RbNode* parent = node->parent;
+    while (parent && node == parent->left) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/**
+ * @brief Finds the in-order successor of a node
+ *
+ * Algorithm:
+ * 1. If the node has a right subtree, return its leftmost node
+ * 2. Otherwise climb until coming up from a left child; that parent is the answer
+ *
+ * @note Time complexity: O(log n) worst case, O(1) amortized over a tree walk
+ */
+template <typename RbNode>
+RbNode* successor(RbNode* node) {
+    if (node->right) {
+        node = node->right;
+        while (node->left)
+            node = node->left;
+        return node;
+    }
+
+    RbNode* parent = node->parent;
+    while (parent && node == parent->right) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/**
+ * @brief Changes the value of a node, moving it only if its order changes
+ *
+ * Algorithm:
+ * 1. Write the new value, keeping the color bit
+ * 2. If the node still orders between its in-order neighbours, the tree is
+ *    still a search tree of the same shape and colors: done
+ * 3. Otherwise remove the node and insert it again
+ *
+ * A chunk that shrinks or grows a little usually keeps its neighbours, so the
+ * common case costs two neighbour lookups instead of a removal and an insertion
+ * with their rebalancing.
+ *
+ * @note Time complexity: O(log n); no rotations when the node keeps its place
+ */
+template <typename RbNode, typename Less>
+bool update_key(RbNode*& root, RbNode* node, std::size_t new_value, Less less) {
+    RbNode* prev = predecessor(node);
+    RbNode* next = successor(node);
+
+    bool red = is_red(node->value);
+    node->value = new_value;
+    if (red)
+        set_color_red(node->value);
+
+    if ((!prev || !less(node, prev)) && (!next || !less(next, node)))
+        return true;
+
+    remove(root, node);
+    insert(root, node, less);
+    return false;
+}
 }  // namespace hh::rb_tree
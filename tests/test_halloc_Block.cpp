@@ -1,19 +1,41 @@
 /**
  * @file test_halloc_Block.cpp
- * @brief Unit tests for Block single-block memory allocator with RB-tree
+ * @brief Unit tests for Block single-block memory allocator and its free index policies
  *
  * Test Coverage:
  * - Basic Allocation : Full block, smaller sizes, arrays, structs, multiple allocations
- * - Memory Management: Block metadata verification, coalescing on deallocation
+ * - Construction : Nothrow constructor reporting mmap and size class failures
+ * - Memory Management: Block metadata verification, coalescing on deallocation,
+ *                      compact header overhead, free byte and largest chunk tracking,
+ *                      merged chunks taking over their neighbours' index entries
+ * - Alignment : MIN_ALIGNMENT for odd sizes, aligned allocation and padding reuse
+ * - Size Classes : Granule and geometric rounding, minimum split remainder
+ * - Purging : Large free chunks return their pages to the OS, at once or after the
+ *             purge decay
+ * - Page Backing : Transparent huge pages, hugetlbfs with fallback
+ * - Reservation : Reserve-then-commit blocks growing in place
+ * - In-place Resize : Growing into a free neighbour, shrinking by splitting
+ * - Batches : Chunks carved back to back, freed runs merged in one pass
+ * - Free Index Policies: RB-tree, address-ordered RB-tree, TLSF and segregated lists
+ *                        find fits and coalesce; equal sizes chained behind one tree
+ *                        node (LIFO) or handed out lowest address first
  * - Stress Tests : Random patterns (50K allocs), fragmentation, RB-tree depth
  *
  */
 
 #include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "../halloc/includes/Block.hpp"
@@ -24,6 +46,14 @@ namespace {
 std::size_t get_actual_value(std::size_t value) {
     return value & ~(3ull << 62);
 }
+
+/// Number of resident pages in [ptr, ptr + bytes), ptr page-aligned
+std::size_t resident_pages(void* ptr, std::size_t bytes) {
+    std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> pages((bytes + page_size - 1) / page_size);
+    mincore(ptr, bytes, pages.data());
+    return std::count_if(pages.begin(), pages.end(), [](unsigned char p) { return p & 1; });
+}
 }  // namespace
 
 class HallocBlockTest : public ::testing::Test {
@@ -50,21 +80,21 @@ void* allocate(Block& block, std::size_t size) {
 TEST(HallocBlockTest, SMALL_AllocateTheSameSizeAsBlock) {
     Block block(1024);
 
-    MemoryNode* node = block.best_fit(1024 - 48);
+    MemoryNode* node = block.best_fit(1024 - MEMORY_NODE_SIZE);
     EXPECT_NE(node, nullptr);
 
-    void* ptr = block.allocate(1024 - 48, node);
+    void* ptr = block.allocate(1024 - MEMORY_NODE_SIZE, node);
     EXPECT_NE(ptr, nullptr);
 
     MemoryNode* node_after_allocation = block.best_fit(128);
     EXPECT_EQ(node_after_allocation, nullptr);
 
-    block.deallocate(ptr, 1024 - 48);
+    block.deallocate(ptr, 1024 - MEMORY_NODE_SIZE);
 
     MemoryNode* node_after_deallocation = block.best_fit(512);
     EXPECT_NE(node_after_deallocation, nullptr);
 
-    void* ptr2 = block.allocate(512 - 48, node_after_deallocation);
+    void* ptr2 = block.allocate(512 - MEMORY_NODE_SIZE, node_after_deallocation);
     EXPECT_NE(ptr2, nullptr);
 
     MemoryNode* node_after_second_allocation = block.best_fit(512);
@@ -76,10 +106,11 @@ TEST(HallocBlockTest, SMALL_AllocateTheSameSizeAsBlock) {
  * @test Small allocations with splitting and coalescing verify block reuse efficiency
  */
 TEST(HallocBlockTest, SMALL_AllocateSmallerSizes) {
-    // first 48 is for MEMORY_NODE_SIZE
-    Block block(100);
+    // Room for exactly two minimum-sized chunks (header + MIN_CHUNK_PAYLOAD each)
+    const std::size_t BLOCK_SIZE = 2 * (MEMORY_NODE_SIZE + MIN_CHUNK_PAYLOAD);
+    Block block(BLOCK_SIZE);
 
-    void* ptr1 = allocate(block, 100 - 48);
+    void* ptr1 = allocate(block, BLOCK_SIZE - MEMORY_NODE_SIZE);
     EXPECT_NE(ptr1, nullptr);
 
     // No more space left
@@ -89,11 +120,11 @@ TEST(HallocBlockTest, SMALL_AllocateSmallerSizes) {
     // second param is unused
     block.deallocate(ptr1, std::numeric_limits<std::size_t>::max());
 
-    // Now we can allocate again (this actually takes 50 bytes)
+    // Now we can allocate again (this actually takes a whole minimum-sized chunk)
     void* ptr3 = allocate(block, 2);
     EXPECT_NE(ptr3, nullptr);
 
-    // Also we can allocate another 2 bytes (50 + 50 = 100)
+    // Also we can allocate another 2 bytes from the second minimum-sized chunk
     void* ptr4 = allocate(block, 2);
     EXPECT_NE(ptr4, nullptr);
 
@@ -101,7 +132,7 @@ TEST(HallocBlockTest, SMALL_AllocateSmallerSizes) {
     block.deallocate(ptr4, std::numeric_limits<std::size_t>::max());
 
     // Now we can allocate full block again
-    void* ptr5 = allocate(block, 100 - 48);
+    void* ptr5 = allocate(block, BLOCK_SIZE - MEMORY_NODE_SIZE);
     EXPECT_NE(ptr5, nullptr);
 }
 
@@ -136,8 +167,12 @@ TEST(HallocBlockTest, SMALL_AllocateAndUseCustomStruct) {
         long long value;
     };
 
-    Block block(11 + sizeof(CS) + MEMORY_NODE_SIZE + MEMORY_NODE_SIZE);
-    EXPECT_EQ(((MemoryNode*)block.get_head())->value, 11 + sizeof(CS) + MEMORY_NODE_SIZE);
+    // The struct's chunk is rounded up to MIN_ALIGNMENT before the split, and the
+    // 11-byte string still needs a whole minimum-sized chunk
+    const std::size_t CS_CHUNK = std::max(align_up(sizeof(CS), MIN_ALIGNMENT), MIN_CHUNK_PAYLOAD);
+    Block block(MIN_CHUNK_PAYLOAD + CS_CHUNK + MEMORY_NODE_SIZE + MEMORY_NODE_SIZE);
+    EXPECT_EQ(((MemoryNode*)block.get_head())->value,
+              MIN_CHUNK_PAYLOAD + CS_CHUNK + MEMORY_NODE_SIZE);
 
     auto best = block.best_fit(sizeof(CS));
     EXPECT_EQ(best, block.get_head());
@@ -160,8 +195,9 @@ TEST(HallocBlockTest, SMALL_AllocateAndUseCustomStruct) {
     EXPECT_EQ(cs_ptr->value, 1234567890LL);
 
     // block.print_tree_info();
-    block.deallocate(cs_ptr, sizeof(CS));
+    // Free the string first: a freed chunk's payload is reused for tree links
     block.deallocate(cs_ptr->data, 11);
+    block.deallocate(cs_ptr, sizeof(CS));
 }
 
 /**
@@ -180,7 +216,7 @@ TEST(HallocBlockTest, SMALL_MultipleAllocations) {
     for (int i = vals.size() - 1; i >= 0; i--) {
         EXPECT_EQ(
             get_actual_value(((MemoryNode*)((unsigned char*)mem[i] - MEMORY_NODE_SIZE))->value),
-            vals[i]);
+            std::max<std::size_t>(vals[i], MIN_CHUNK_PAYLOAD));
     }
 }
 
@@ -189,8 +225,9 @@ TEST(HallocBlockTest, SMALL_MultipleAllocations) {
  * verification)
  */
 TEST(HallocBlockTest, SMALL_MultipleAllocationsWithDeletionsMustMerge) {
-    Block block(1311);
-    std::vector<int> vals = {16, 32, 64, 128, 256, 512};
+    // 15 spare bytes at the end are too few to split off, so they stay with the last chunk
+    Block block(1024 + 6 * MEMORY_NODE_SIZE + 15);
+    std::vector<int> vals = {32, 32, 64, 128, 256, 512};
     std::vector<void*> mem;
     for (std::size_t i = 0; i < vals.size(); i++) {
         void* ptr = allocate(block, vals[i]);
@@ -200,13 +237,652 @@ TEST(HallocBlockTest, SMALL_MultipleAllocationsWithDeletionsMustMerge) {
     block.deallocate(mem[3], std::numeric_limits<std::size_t>::max());
     block.deallocate(mem[4], std::numeric_limits<std::size_t>::max());
 
-    int* ptr = (int*)allocate(block, 432);
+    int* ptr = (int*)allocate(block, 128 + 256 + MEMORY_NODE_SIZE);
     EXPECT_NE(ptr, nullptr);
 
     int* ptr2 = (int*)allocate(block, 4);
     EXPECT_EQ(ptr2, nullptr);
 }
 
+/**
+ * @test Live chunks only carry the compact header: consecutive small allocations are
+ * MEMORY_NODE_SIZE apart, and freeing the middle one lets both neighbours coalesce
+ */
+TEST(HallocBlockTest, SMALL_CompactHeaderOverhead) {
+    EXPECT_EQ(MEMORY_NODE_SIZE, 2 * sizeof(std::size_t));
+
+    Block block(4096);
+    auto* a = static_cast<unsigned char*>(allocate(block, MIN_CHUNK_PAYLOAD));
+    auto* b = static_cast<unsigned char*>(allocate(block, MIN_CHUNK_PAYLOAD));
+    auto* c = static_cast<unsigned char*>(allocate(block, MIN_CHUNK_PAYLOAD));
+    EXPECT_EQ(b - a, (std::ptrdiff_t)(MIN_CHUNK_PAYLOAD + MEMORY_NODE_SIZE));
+    EXPECT_EQ(c - b, (std::ptrdiff_t)(MIN_CHUNK_PAYLOAD + MEMORY_NODE_SIZE));
+
+    // The whole payload belongs to the user while the chunk is live
+    std::memset(b, 0xFF, MIN_CHUNK_PAYLOAD);
+
+    block.deallocate(a, MIN_CHUNK_PAYLOAD);
+    block.deallocate(c, MIN_CHUNK_PAYLOAD);
+    block.deallocate(b, MIN_CHUNK_PAYLOAD);
+
+    void* whole = allocate(block, 4096 - MEMORY_NODE_SIZE);
+    EXPECT_EQ(whole, a);
+}
+
+/**
+ * @test Odd-sized requests keep every following payload aligned to MIN_ALIGNMENT
+ */
+TEST(HallocBlockTest, SMALL_OddSizesKeepMinAlignment) {
+    Block block(4096);
+    std::vector<void*> mem;
+    for (std::size_t size : {1, 3, 7, 13, 29, 61, 125}) {
+        void* ptr = allocate(block, size);
+        EXPECT_NE(ptr, nullptr);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % MIN_ALIGNMENT, 0u);
+        mem.push_back(ptr);
+    }
+
+    for (void* ptr : mem) {
+        block.deallocate(ptr, std::numeric_limits<std::size_t>::max());
+    }
+}
+
+/**
+ * @test Aligned allocations honour the alignment and their padding merges back on free
+ */
+TEST(HallocBlockTest, SMALL_AllocateAligned_PaddingIsReclaimed) {
+    const std::size_t BLOCK_SIZE = 64 * 1024;
+    Block block(BLOCK_SIZE);
+
+    std::vector<void*> mem;
+    for (std::size_t alignment : {32, 64, 256, 4096}) {
+        MemoryNode* node = block.best_fit_aligned(100, alignment);
+        ASSERT_NE(node, nullptr);
+
+        void* ptr = block.allocate_aligned(100, alignment, node);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % alignment, 0u);
+        std::memset(ptr, 0x5A, 100);
+        mem.push_back(ptr);
+    }
+
+    for (void* ptr : mem) {
+        block.deallocate(ptr, std::numeric_limits<std::size_t>::max());
+    }
+
+    // Every leading padding chunk was coalesced: the whole block is one node again
+    void* whole = allocate(block, BLOCK_SIZE - MEMORY_NODE_SIZE);
+    EXPECT_EQ(whole, (char*)block.get_head() + MEMORY_NODE_SIZE);
+}
+
+/**
+ * @test With a purge decay of 0, freeing a large chunk returns its pages to the OS;
+ * only the pages holding chunk headers stay resident
+ */
+TEST(HallocBlockTest, SMALL_LargeFreeChunksArePurged) {
+    const std::size_t BLOCK_SIZE = 1024 * 1024;
+    Block block(BLOCK_SIZE, DEFAULT_PURGE_THRESHOLD, PageBacking::Regular, 0, SizeClasses{},
+                std::chrono::milliseconds(0));
+
+    void* small = allocate(block, 100);
+    void* large = allocate(block, 512 * 1024);
+    std::memset(small, 0x11, 100);
+    std::memset(large, 0x22, 512 * 1024);
+    EXPECT_GE(resident_pages(block.get_head(), BLOCK_SIZE), 128u);
+
+    block.deallocate(large, 512 * 1024);
+    EXPECT_LE(resident_pages(block.get_head(), BLOCK_SIZE), 2u);
+
+    // The purged range is reused like any other free memory
+    void* again = allocate(block, 256 * 1024);
+    EXPECT_EQ(again, large);
+    std::memset(again, 0x33, 256 * 1024);
+    block.deallocate(again, 256 * 1024);
+    block.deallocate(small, 100);
+    EXPECT_LE(resident_pages(block.get_head(), BLOCK_SIZE), 1u);
+}
+
+/**
+ * @test Chunks below the purge threshold (or with purging disabled) stay resident
+ */
+TEST(HallocBlockTest, SMALL_PurgeThresholdKeepsSmallChunksResident) {
+    const std::size_t BLOCK_SIZE = 1024 * 1024;
+    Block block(BLOCK_SIZE, 0, PageBacking::Regular, 0, SizeClasses{},
+                std::chrono::milliseconds(0));
+
+    void* large = allocate(block, 512 * 1024);
+    void* guard = allocate(block, 100);
+    std::memset(large, 0x22, 512 * 1024);
+    block.deallocate(large, 512 * 1024);
+    EXPECT_GE(resident_pages(block.get_head(), BLOCK_SIZE), 128u);
+    block.purge();
+    EXPECT_GE(resident_pages(block.get_head(), BLOCK_SIZE), 128u);
+    block.deallocate(guard, 100);
+}
+
+/**
+ * @test By default a large freed chunk stays resident until the purge decay has
+ * passed, and the first free after it purges the block; purge() does not wait
+ */
+TEST(HallocBlockTest, SMALL_PurgeWaitsForDecay) {
+    const std::size_t BLOCK_SIZE = 1024 * 1024;
+    Block decaying(BLOCK_SIZE, DEFAULT_PURGE_THRESHOLD, PageBacking::Regular, 0, SizeClasses{},
+                   std::chrono::milliseconds(20));
+    Block by_default(BLOCK_SIZE);
+
+    for (Block* block : {&decaying, &by_default}) {
+        void* large = allocate(*block, 512 * 1024);
+        void* small = allocate(*block, 100);
+        void* guard = allocate(*block, 100);
+        std::memset(large, 0x22, 512 * 1024);
+        block->deallocate(large, 512 * 1024);
+        EXPECT_GE(resident_pages(block->get_head(), BLOCK_SIZE), 128u);
+        block->deallocate(small, 100);
+        EXPECT_GE(resident_pages(block->get_head(), BLOCK_SIZE), 128u);
+        block->deallocate(guard, 100);
+    }
+
+    // The decay has passed: the next free purges every large dirty chunk
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    void* ptr = allocate(decaying, 100);
+    decaying.deallocate(ptr, 100);
+    EXPECT_LE(resident_pages(decaying.get_head(), BLOCK_SIZE), 1u);
+
+    // The default decay has not: only an explicit purge releases the pages
+    EXPECT_GE(resident_pages(by_default.get_head(), BLOCK_SIZE), 128u);
+    by_default.purge();
+    EXPECT_LE(resident_pages(by_default.get_head(), BLOCK_SIZE), 1u);
+}
+
+/**
+ * @test Huge-page-backed blocks are aligned to and sized in whole huge pages; HugeTlb
+ * falls back to transparent huge pages when no huge pages are reserved
+ */
+TEST(HallocBlockTest, SMALL_HugePageBacking) {
+    for (PageBacking backing : {PageBacking::TransparentHuge, PageBacking::HugeTlb}) {
+        Block block(3 * 1024 * 1024, DEFAULT_PURGE_THRESHOLD, backing);
+        EXPECT_EQ(block.get_size(), 2 * HUGE_PAGE_SIZE);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(block.get_head()) % HUGE_PAGE_SIZE, 0u);
+
+        void* a = allocate(block, HUGE_PAGE_SIZE);
+        void* b = allocate(block, HUGE_PAGE_SIZE / 2);
+        ASSERT_NE(a, nullptr);
+        ASSERT_NE(b, nullptr);
+        std::memset(a, 0x44, HUGE_PAGE_SIZE);
+        std::memset(b, 0x55, HUGE_PAGE_SIZE / 2);
+
+        block.deallocate(a, HUGE_PAGE_SIZE);
+        block.deallocate(b, HUGE_PAGE_SIZE / 2);
+        void* whole = allocate(block, block.get_size() - MEMORY_NODE_SIZE);
+        EXPECT_EQ(whole, (char*)block.get_head() + MEMORY_NODE_SIZE);
+    }
+}
+
+/**
+ * @test A reserved block commits only its initial size and grows in place, extending
+ * a free last chunk or appending a new one after a used last chunk
+ */
+TEST(HallocBlockTest, SMALL_ReserveThenCommit_GrowsInPlace) {
+    const std::size_t COMMIT = 64 * 1024;
+    Block block(COMMIT, DEFAULT_PURGE_THRESHOLD, PageBacking::Regular, 1024 * 1024);
+    EXPECT_EQ(block.get_size(), COMMIT);
+    EXPECT_EQ(block.get_reserved_size(), 1024 * 1024u);
+
+    // Used last chunk: the new pages become a chunk of their own
+    void* a = allocate(block, COMMIT - MEMORY_NODE_SIZE);
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(allocate(block, 1000), nullptr);
+    ASSERT_TRUE(block.grow(COMMIT));
+    EXPECT_EQ(block.get_size(), 2 * COMMIT);
+    void* b = allocate(block, 1000);
+    EXPECT_EQ(b, (char*)block.get_head() + COMMIT + MEMORY_NODE_SIZE);
+    std::memset(b, 0x77, 1000);
+
+    // Free last chunk: it is extended, and everything coalesces back into one chunk
+    ASSERT_TRUE(block.grow(1));
+    EXPECT_EQ(block.get_size(), 2 * COMMIT + 4096);
+    block.deallocate(a, COMMIT - MEMORY_NODE_SIZE);
+    block.deallocate(b, 1000);
+    void* whole = allocate(block, block.get_size() - MEMORY_NODE_SIZE);
+    EXPECT_EQ(whole, a);
+    std::memset(whole, 0x88, block.get_size() - MEMORY_NODE_SIZE);
+    block.deallocate(whole, block.get_size() - MEMORY_NODE_SIZE);
+
+    // The reservation is a hard limit
+    EXPECT_FALSE(block.grow(1024 * 1024));
+}
+
+/**
+ * @test try_expand grows a chunk into its free next chunk and fails when the next
+ * chunk is used or too small, leaving everything unchanged
+ */
+TEST(HallocBlockTest, SMALL_TryExpand_GrowsIntoFreeNeighbour) {
+    Block block(4096);
+
+    void* a = allocate(block, 100);
+    void* b = allocate(block, 200);
+    void* c = allocate(block, 100);
+    std::memset(a, 0x11, 100);
+
+    // b is used: a cannot grow
+    EXPECT_FALSE(block.try_expand(a, 200));
+
+    // b freed: a grows over it, keeping its content, and the rest of b stays free
+    block.deallocate(b, 200);
+    ASSERT_TRUE(block.try_expand(a, 250));
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(static_cast<unsigned char*>(a)[i], 0x11);
+    }
+    std::memset(a, 0x22, 250);
+    void* rest = allocate(block, 32);
+    EXPECT_GT(rest, a);
+    EXPECT_LT(rest, c);
+
+    // Not enough room before c
+    EXPECT_FALSE(block.try_expand(a, 400));
+
+    block.deallocate(rest, 32);
+    block.deallocate(c, 100);
+    ASSERT_TRUE(block.try_expand(a, 3000));
+    std::memset(a, 0x33, 3000);
+
+    block.deallocate(a, 3000);
+    void* whole = allocate(block, block.get_size() - MEMORY_NODE_SIZE);
+    EXPECT_EQ(whole, a);
+}
+
+/**
+ * @test try_expand shrinks by splitting the tail off as a free chunk that coalesces
+ * with a free neighbour
+ */
+TEST(HallocBlockTest, SMALL_TryExpand_ShrinksBySplitting) {
+    Block block(4096);
+
+    void* a = allocate(block, 1000);
+    void* b = allocate(block, 1000);
+    std::memset(a, 0x44, 1000);
+
+    ASSERT_TRUE(block.try_expand(a, 200));
+    for (int i = 0; i < 200; i++) {
+        EXPECT_EQ(static_cast<unsigned char*>(a)[i], 0x44);
+    }
+    MemoryNode* node = (MemoryNode*)((char*)a - MEMORY_NODE_SIZE);
+    EXPECT_EQ(get_actual_value(node->value), 208u);
+
+    // The 800 bytes given back can serve a new allocation between a and b
+    void* c = allocate(block, 700);
+    EXPECT_GT(c, a);
+    EXPECT_LT(c, b);
+
+    // A tail too small to split is kept, and the shrink still succeeds
+    ASSERT_TRUE(block.try_expand(c, 690));
+    node = (MemoryNode*)((char*)c - MEMORY_NODE_SIZE);
+    EXPECT_EQ(get_actual_value(node->value), 704u);
+
+    // A shrink next to a free chunk merges into it
+    block.deallocate(c, 690);
+    ASSERT_TRUE(block.try_expand(b, 100));
+    block.deallocate(a, 200);
+    block.deallocate(b, 100);
+    void* whole = allocate(block, block.get_size() - MEMORY_NODE_SIZE);
+    EXPECT_EQ(whole, a);
+}
+
+/**
+ * @test A batch is carved back to back from one node when one is large enough, and
+ * from several nodes otherwise; freeing it restores a single free chunk
+ */
+TEST(HallocBlockTest, SMALL_Batch_CarvesAndMergesChunks) {
+    Block block(64 * 1024);
+
+    void* chunks[100];
+    ASSERT_EQ(block.allocate_batch(40, 100, chunks), 100u);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(static_cast<char*>(chunks[i]),
+                  static_cast<char*>(chunks[0]) + i * (48 + MEMORY_NODE_SIZE));
+        std::memset(chunks[i], i, 40);
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(static_cast<unsigned char*>(chunks[i])[39], i);
+    }
+
+    // Free every other chunk, then fill the holes and the rest of the block in one batch
+    void* odd[50];
+    for (int i = 0; i < 50; i++) {
+        odd[i] = chunks[2 * i + 1];
+    }
+    block.deallocate_batch(odd, 50);
+    std::size_t capacity = (64 * 1024 - 100 * (48 + MEMORY_NODE_SIZE)) / (48 + MEMORY_NODE_SIZE);
+    std::vector<void*> refill(2000);
+    std::size_t got = block.allocate_batch(48, refill.size(), refill.data());
+    EXPECT_EQ(got, 50 + capacity);
+    EXPECT_EQ(block.best_fit(48), nullptr);
+
+    // Everything freed in address order merges back into one chunk
+    std::vector<void*> all(chunks, chunks + 100);
+    for (int i = 0; i < 50; i++) {
+        all[2 * i + 1] = nullptr;
+    }
+    std::erase(all, nullptr);
+    all.insert(all.end(), refill.begin(), refill.begin() + got);
+    std::sort(all.begin(), all.end());
+    block.deallocate_batch(all.data(), all.size());
+    void* whole = allocate(block, block.get_size() - MEMORY_NODE_SIZE);
+    EXPECT_EQ(whole, (char*)block.get_head() + MEMORY_NODE_SIZE);
+}
+
+/**
+ * @test Equal-sized free chunks are handed out last-freed first and still coalesce
+ */
+TEST(HallocBlockTest, SMALL_EqualSizesChainLastFreedFirst) {
+    Block block(64 * 1024, 0);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 16; i++) {
+        ptrs.push_back(allocate(block, 64));
+    }
+    std::size_t rest = block.largest_free_size();
+    void* tail = allocate(block, rest);
+
+    // Free every other chunk: eight holes of the same size
+    for (int i = 0; i < 16; i += 2) {
+        block.deallocate(ptrs[i], 64);
+    }
+    for (int i = 14; i >= 0; i -= 2) {
+        void* ptr = allocate(block, 64);
+        EXPECT_EQ(ptr, ptrs[i]);
+    }
+
+    // Free the holes again, then the chunks between them, which merges chained chunks
+    for (int i = 0; i < 16; i += 2) {
+        block.deallocate(ptrs[i], 64);
+    }
+    for (int i = 1; i < 16; i += 2) {
+        block.deallocate(ptrs[i], 64);
+    }
+    block.deallocate(tail, rest);
+    EXPECT_EQ(block.largest_free_size(), block.get_size() - MEMORY_NODE_SIZE);
+}
+
+/**
+ * @test Size classes round requests geometrically and keep small tails with the allocation
+ */
+TEST(HallocBlockTest, SMALL_SizeClassesRoundAndLimitSplits) {
+    SizeClasses classes{MIN_ALIGNMENT, 1024, 4, 128};
+    EXPECT_EQ(classes.round(1), MIN_CHUNK_PAYLOAD);
+    EXPECT_EQ(classes.round(100), 112u);
+    EXPECT_EQ(classes.round(1024), 1024u);
+    EXPECT_EQ(classes.round(1025), 1280u);
+    EXPECT_EQ(classes.round(1800), 2048u);
+    EXPECT_EQ(classes.round(5000), 5120u);
+
+    Block block(64 * 1024, 0, PageBacking::Regular, 0, classes);
+    std::size_t whole = block.get_size() - MEMORY_NODE_SIZE;
+
+    // Both requests fall in the 1280-byte class
+    auto* first = static_cast<char*>(block.allocate(1025, block.best_fit(1025)));
+    auto* second = static_cast<char*>(block.allocate(1200, block.best_fit(1200)));
+    EXPECT_EQ(second - first, static_cast<std::ptrdiff_t>(1280 + MEMORY_NODE_SIZE));
+    block.deallocate(first, 1025);
+    EXPECT_EQ(block.allocate(1100, block.best_fit(1100)), first);
+
+    // A 256-byte hole splits for 112 bytes (128 left) but not for 144 (96 left)
+    void* hole = block.allocate(256, block.best_fit(256));
+    void* guard = block.allocate(64, block.best_fit(64));
+    block.deallocate(hole, 256);
+    std::size_t free_with_hole = block.get_free_size();
+
+    void* small = block.allocate(100, block.best_fit(100));
+    EXPECT_EQ(small, hole);
+    EXPECT_EQ(block.get_free_size(), free_with_hole - 112 - MEMORY_NODE_SIZE);
+    block.deallocate(small, 100);
+
+    void* larger = block.allocate(140, block.best_fit(140));
+    EXPECT_EQ(larger, hole);
+    EXPECT_EQ(block.get_free_size(), free_with_hole - 256);
+
+    for (void* ptr : {larger, guard, static_cast<void*>(first), static_cast<void*>(second)}) {
+        block.deallocate(ptr, 0);
+    }
+    EXPECT_EQ(block.get_free_size(), whole);
+
+    EXPECT_THROW(Block(64 * 1024, 0, PageBacking::Regular, 0, SizeClasses{24}),
+                 std::invalid_argument);
+    EXPECT_THROW(Block(64 * 1024, 0, PageBacking::Regular, 0, SizeClasses{16, 0, 3}),
+                 std::invalid_argument);
+}
+
+/**
+ * @test The nothrow constructor leaves an invalid block where the throwing one throws
+ */
+TEST(HallocBlockTest, SMALL_NothrowConstructorReportsFailure) {
+    Block unmappable(std::nothrow, SIZE_MAX / 2);
+    Block invalid_classes(std::nothrow, 64 * 1024, 0, PageBacking::Regular, 0, SizeClasses{24});
+    EXPECT_EQ(unmappable.get_head(), nullptr);
+    EXPECT_EQ(unmappable.get_size(), 0u);
+    EXPECT_EQ(invalid_classes.get_head(), nullptr);
+    EXPECT_THROW(Block(SIZE_MAX / 2), std::bad_alloc);
+
+    Block block(std::nothrow, 64 * 1024);
+    ASSERT_NE(block.get_head(), nullptr);
+    EXPECT_EQ(block.get_size(), 64u * 1024);
+    void* ptr = block.allocate(1000, block.best_fit(1000));
+    ASSERT_NE(ptr, nullptr);
+    block.deallocate(ptr, 1000);
+    EXPECT_EQ(block.get_free_size(), 64u * 1024 - MEMORY_NODE_SIZE);
+}
+
+/**
+ * @test Address-ordered best fit hands out equal-sized holes lowest address first
+ */
+TEST(HallocBlockTest, SMALL_AddressOrderedBestFit) {
+    BasicBlock<AddressOrderedIndex<MemoryNode>> block(64 * 1024, 0);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 16; i++) {
+        ptrs.push_back(block.allocate(64, block.best_fit(64)));
+    }
+    std::size_t rest = block.largest_free_size();
+    void* tail = block.allocate(rest, block.best_fit(rest));
+
+    // Free every other chunk in a scrambled order
+    for (int i : {6, 2, 14, 0, 10, 4, 12, 8}) {
+        block.deallocate(ptrs[i], 64);
+    }
+    for (int i = 0; i < 16; i += 2) {
+        EXPECT_EQ(block.allocate(48, block.best_fit(48)), ptrs[i]);
+    }
+
+    for (void* ptr : ptrs) {
+        block.deallocate(ptr, 64);
+    }
+    block.deallocate(tail, rest);
+    EXPECT_EQ(block.largest_free_size(), block.get_size() - MEMORY_NODE_SIZE);
+}
+
+template <typename BlockType>
+class HallocBlockPolicyTest : public ::testing::Test {};
+
+using FreeIndexPolicies = ::testing::Types<BasicBlock<RBTreeIndex<MemoryNode>>,
+                                           BasicBlock<AddressOrderedIndex<MemoryNode>>,
+                                           BasicBlock<TlsfIndex<MemoryNode>>,
+                                           BasicBlock<SegregatedFitIndex<MemoryNode>>>;
+TYPED_TEST_SUITE(HallocBlockPolicyTest, FreeIndexPolicies);
+
+/**
+ * @test Every policy hands out the whole block and gets it back in one piece
+ */
+TYPED_TEST(HallocBlockPolicyTest, SMALL_WholeBlockRoundTrip) {
+    TypeParam block(64 * 1024, 0);
+    std::size_t whole = block.largest_free_size();
+
+    EXPECT_EQ(block.best_fit(whole + 1), nullptr);
+    MemoryNode* node = block.best_fit(whole);
+    ASSERT_NE(node, nullptr);
+
+    void* ptr = block.allocate(whole, node);
+    EXPECT_EQ(block.largest_free_size(), 0u);
+    EXPECT_EQ(block.best_fit(1), nullptr);
+
+    block.deallocate(ptr, whole);
+    EXPECT_EQ(block.largest_free_size(), whole);
+}
+
+/**
+ * @test Every policy finds a hole that fits whenever one exists; the RB-tree finds the tightest
+ */
+TYPED_TEST(HallocBlockPolicyTest, SMALL_FindsFitWheneverOneExists) {
+    TypeParam block(1024 * 1024, 0);
+
+    // Holes of 48, 80, 112, ... bytes separated by used chunks, and no free tail
+    std::vector<void*> ptrs;
+    std::vector<std::size_t> sizes;
+    for (std::size_t size = 48; size <= 4096; size += 32) {
+        ptrs.push_back(block.allocate(size, block.best_fit(size)));
+        sizes.push_back(size);
+        ptrs.push_back(block.allocate(32, block.best_fit(32)));
+        sizes.push_back(32);
+    }
+    std::size_t rest = block.largest_free_size();
+    void* tail = block.allocate(rest, block.best_fit(rest));
+    for (std::size_t i = 0; i < ptrs.size(); i += 2) {
+        block.deallocate(ptrs[i], sizes[i]);
+    }
+
+    std::size_t largest_hole = sizes[sizes.size() - 2];
+    EXPECT_EQ(block.largest_free_size(), largest_hole);
+    EXPECT_EQ(block.best_fit(largest_hole + 1), nullptr);
+
+    for (std::size_t i = 0; i < ptrs.size(); i += 2) {
+        for (std::size_t request : {sizes[i] - 15, sizes[i]}) {
+            MemoryNode* node = block.best_fit(request);
+            ASSERT_NE(node, nullptr) << "request " << request;
+            EXPECT_GE(get_actual_value(node->value), request);
+            if constexpr (std::is_same_v<TypeParam, Block> ||
+                          std::is_same_v<TypeParam, BasicBlock<AddressOrderedIndex<MemoryNode>>>) {
+                EXPECT_EQ(get_actual_value(node->value), sizes[i]);
+            }
+        }
+    }
+
+    for (std::size_t i = 1; i < ptrs.size(); i += 2) {
+        block.deallocate(ptrs[i], sizes[i]);
+    }
+    block.deallocate(tail, rest);
+    EXPECT_EQ(block.largest_free_size(), block.get_size() - MEMORY_NODE_SIZE);
+}
+
+/**
+ * @test Free byte count and largest free size follow every allocation and free
+ */
+TYPED_TEST(HallocBlockPolicyTest, SMALL_FreeSizeAndLargestAreTracked) {
+    TypeParam block(64 * 1024, 0);
+    std::size_t whole = block.get_size() - MEMORY_NODE_SIZE;
+    EXPECT_EQ(block.get_free_size(), whole);
+    EXPECT_EQ(block.largest_free_size(), whole);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 8; i++) {
+        ptrs.push_back(block.allocate(64, block.best_fit(64)));
+    }
+    std::size_t rest = whole - 8 * (64 + MEMORY_NODE_SIZE);
+    EXPECT_EQ(block.get_free_size(), rest);
+    EXPECT_EQ(block.largest_free_size(), rest);
+
+    block.deallocate(ptrs[1], 64);
+    block.deallocate(ptrs[5], 64);
+    EXPECT_EQ(block.get_free_size(), rest + 2 * 64);
+
+    // Taking the tail leaves only the two holes
+    void* tail = block.allocate(rest, block.best_fit(rest));
+    EXPECT_EQ(block.get_free_size(), 2 * 64u);
+    EXPECT_EQ(block.largest_free_size(), 64u);
+    EXPECT_EQ(block.best_fit(65), nullptr);
+
+    block.deallocate(tail, rest);
+    for (int i : {0, 2, 3, 4, 6, 7}) {
+        block.deallocate(ptrs[i], 64);
+    }
+    EXPECT_EQ(block.get_free_size(), whole);
+    EXPECT_EQ(block.largest_free_size(), whole);
+}
+
+/**
+ * @test Forward, backward and two-sided merges hand the merged chunk the right entry
+ */
+TYPED_TEST(HallocBlockPolicyTest, SMALL_MergesReuseNeighbourEntries) {
+    TypeParam block(64 * 1024, 0);
+
+    std::vector<void*> ptrs;
+    for (std::size_t bytes : {64, 128, 64, 256, 64, 512, 64}) {
+        ptrs.push_back(block.allocate(bytes, block.best_fit(bytes)));
+    }
+    std::size_t rest = block.largest_free_size();
+    void* tail = block.allocate(rest, block.best_fit(rest));
+
+    auto expect_largest = [&](void* ptr, std::size_t largest, std::size_t free_size) {
+        EXPECT_EQ(block.largest_free_size(), largest);
+        EXPECT_EQ(block.get_free_size(), free_size);
+        EXPECT_EQ(static_cast<void*>(block.best_fit(largest)),
+                  static_cast<char*>(ptr) - MEMORY_NODE_SIZE);
+    };
+
+    block.deallocate(ptrs[1], 128);
+    expect_largest(ptrs[1], 128, 128);
+    block.deallocate(ptrs[2], 64);  // backward merge
+    expect_largest(ptrs[1], 208, 208);
+    block.deallocate(ptrs[5], 512);
+    expect_largest(ptrs[5], 512, 208 + 512);
+    block.deallocate(ptrs[3], 256);  // backward merge
+    expect_largest(ptrs[5], 512, 480 + 512);
+    block.deallocate(ptrs[4], 64);  // both sides, next one larger
+    expect_largest(ptrs[1], 1088, 1088);
+    block.deallocate(ptrs[6], 64);  // backward merge, next chunk used
+    expect_largest(ptrs[1], 1168, 1168);
+    block.deallocate(ptrs[0], 64);  // forward merge
+    expect_largest(ptrs[0], 1248, 1248);
+
+    block.deallocate(tail, rest);
+    EXPECT_EQ(block.largest_free_size(), block.get_size() - MEMORY_NODE_SIZE);
+    EXPECT_EQ(block.get_free_size(), block.get_size() - MEMORY_NODE_SIZE);
+}
+
+/**
+ * @test Random allocations and frees keep data intact and coalesce back to one chunk
+ */
+TYPED_TEST(HallocBlockPolicyTest, STRESS_RandomizedRoundTrip) {
+    TypeParam block(16 * 1024 * 1024, 0);
+    std::mt19937 rng(7);
+
+    std::vector<std::pair<unsigned char*, std::size_t>> live;
+    for (int round = 0; round < 20000; round++) {
+        if (live.empty() || rng() % 5 < 3) {
+            std::size_t size = 16 + rng() % 2048;
+            MemoryNode* node = block.best_fit(size);
+            if (!node) {
+                continue;
+            }
+            auto* ptr = static_cast<unsigned char*>(block.allocate(size, node));
+            std::memset(ptr, static_cast<int>(size & 0xFF), size);
+            live.emplace_back(ptr, size);
+        } else {
+            std::size_t index = rng() % live.size();
+            auto [ptr, size] = live[index];
+            ASSERT_EQ(ptr[0], static_cast<unsigned char>(size & 0xFF));
+            ASSERT_EQ(ptr[size - 1], static_cast<unsigned char>(size & 0xFF));
+            block.deallocate(ptr, size);
+            live[index] = live.back();
+            live.pop_back();
+        }
+        ASSERT_GE(block.get_free_size(), block.largest_free_size());
+    }
+
+    for (auto [ptr, size] : live) {
+        block.deallocate(ptr, size);
+    }
+    EXPECT_EQ(block.largest_free_size(), block.get_size() - MEMORY_NODE_SIZE);
+    EXPECT_EQ(block.get_free_size(), block.get_size() - MEMORY_NODE_SIZE);
+}
+
 /**
  * @test 50K random allocations with 60% deallocation followed by 10K reallocations tests memory
  * reuse
@@ -5,8 +5,13 @@
  * Test Coverage:
  * - Basic Functionality: Constructor, single/multiple allocations, deallocation/reallocation
  * - Multiple Blocks : Block creation, max blocks limit, failure handling
- * - Best-Fit Algorithm : Smallest node selection, cross-block search
- * - Edge Cases : Zero bytes, oversized allocation, exact block size, single block limit
+ * - Best-Fit Algorithm : Smallest node selection, cross-block search, free index
+ * - Dynamic Growth : Geometric block sizes, unlimited block count, large requests,
+ *                    huge page backing, in-place growth of reserved blocks, size classes
+ * - Resize : try_expand and reallocate in place, by copy and by mremap
+ * - Batches : Batch allocation across blocks, batch deallocation in any order
+ * - Edge Cases : Zero bytes, oversized allocation, exact block size, single block limit,
+ *                aligned allocation
  * - Data Integrity : Integer arrays, structs, independent allocations
  * - Fragmentation : Coalescing after deallocation, many small allocations
  * - Stress Tests : Random allocations, fill all blocks, alternating sizes, varying sizes
@@ -16,6 +21,7 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <random>
@@ -205,6 +211,320 @@ TEST(BlocksContainerTest, SMALL_BestFit_SearchesAcrossMultipleBlocks) {
     container.deallocate(new_ptr, 600);
 }
 
+/**
+ * @test The free index tracks each block's largest free node and finds the first fit
+ */
+TEST(BlocksContainerTest, SMALL_FreeIndex_FindsFirstBlockThatFits) {
+    BlockFreeIndex index;
+    EXPECT_EQ(index.find_first(1), index.NOT_FOUND);
+
+    index.reserve(5);
+    EXPECT_EQ(index.find_first(1), index.NOT_FOUND);
+
+    index.update(0, 100);
+    index.update(3, 500);
+    index.update(4, 300);
+    EXPECT_EQ(index.largest(), 500u);
+    EXPECT_EQ(index.find_first(50), 0u);
+    EXPECT_EQ(index.find_first(200), 3u);
+    EXPECT_EQ(index.find_first(501), index.NOT_FOUND);
+
+    index.update(3, 0);
+    EXPECT_EQ(index.find_first(200), 4u);
+    EXPECT_EQ(index.largest(), 300u);
+
+    // Growing the index keeps every entry
+    index.reserve(100);
+    index.update(99, 700);
+    EXPECT_EQ(index.find_first(200), 4u);
+    EXPECT_EQ(index.find_first(600), 99u);
+}
+
+/**
+ * @test Full blocks are skipped: a request lands in the only block with room for it
+ */
+TEST(BlocksContainerTest, SMALL_BestFit_SkipsBlocksWithoutRoom) {
+    BlocksContainer<1024, 64> container;
+    const std::size_t whole = 1024 - MEMORY_NODE_SIZE;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 64; i++) {
+        ptrs.push_back(container.allocate(whole));
+    }
+    EXPECT_EQ(container.get_num_blocks(), 64u);
+
+    container.deallocate(ptrs[41], whole);
+    void* again = container.allocate(512);
+    EXPECT_EQ(again, ptrs[41]);
+
+    container.deallocate(again, 512);
+    for (int i = 0; i < 64; i++) {
+        if (i != 41) {
+            container.deallocate(ptrs[i], whole);
+        }
+    }
+}
+
+// ==================== DYNAMIC GROWTH ====================
+
+/**
+ * @test Block sizes grow geometrically from the initial size up to the cap
+ */
+TEST(BlocksContainerTest, SMALL_Dynamic_BlocksGrowGeometrically) {
+    DynamicBlocksContainer container(ContainerConfig{4096, 16 * 1024, 2, 0});
+    EXPECT_EQ(container.get_num_blocks(), 1u);
+    EXPECT_EQ(container.get_block_size(0), 4096u);
+
+    std::vector<void*> ptrs;
+    // Blocks of 4, 8 and 16 KiB hold 1, 2 and 5 of these; the ninth needs a fourth block
+    for (int i = 0; i < 9; i++) {
+        ptrs.push_back(container.allocate(3000));
+    }
+
+    ASSERT_EQ(container.get_num_blocks(), 4u);
+    EXPECT_EQ(container.get_block_size(1), 8 * 1024u);
+    EXPECT_EQ(container.get_block_size(2), 16 * 1024u);
+    EXPECT_EQ(container.get_block_size(3), 16 * 1024u);
+
+    for (void* ptr : ptrs) {
+        container.deallocate(ptr, 3000);
+    }
+}
+
+/**
+ * @test Without max_blocks there is no block limit, and the block table grows
+ */
+TEST(BlocksContainerTest, SMALL_Dynamic_NoHardBlockLimit) {
+    DynamicBlocksContainer container(ContainerConfig{4096, 4096, 1, 0});
+    const std::size_t whole = 4096 - MEMORY_NODE_SIZE;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 100; i++) {
+        ptrs.push_back(container.allocate(whole));
+        std::memset(ptrs.back(), i, whole);
+    }
+    EXPECT_EQ(container.get_num_blocks(), 100u);
+
+    // Blocks moved into a larger table are still found on deallocation
+    container.deallocate(ptrs[7], whole);
+    EXPECT_EQ(container.allocate(whole), ptrs[7]);
+    for (void* ptr : ptrs) {
+        container.deallocate(ptr, whole);
+    }
+    EXPECT_EQ(container.get_num_blocks(), 100u);
+}
+
+/**
+ * @test A request above the next block size gets a page-rounded block of its own;
+ *       one above the cap is served by mmap
+ */
+TEST(BlocksContainerTest, SMALL_Dynamic_LargeRequests) {
+    DynamicBlocksContainer container(ContainerConfig{4096, 64 * 1024, 2, 0});
+
+    void* medium = container.allocate(20 * 1024);
+    ASSERT_EQ(container.get_num_blocks(), 2u);
+    EXPECT_EQ(container.get_block_size(1), 24 * 1024u);
+
+    void* huge = container.allocate(128 * 1024);
+    ASSERT_NE(huge, nullptr);
+    std::memset(huge, 0xCD, 128 * 1024);
+    EXPECT_EQ(container.get_num_blocks(), 2u);
+
+    container.deallocate(huge, 128 * 1024);
+    container.deallocate(medium, 20 * 1024);
+}
+
+/**
+ * @test Huge page backing rounds blocks up to whole huge pages and keeps them owned
+ */
+TEST(BlocksContainerTest, SMALL_Dynamic_HugePageBacking) {
+    ContainerConfig config;
+    config.initial_block_size = 1024 * 1024;
+    config.max_block_size = 4 * HUGE_PAGE_SIZE;
+    config.backing = PageBacking::TransparentHuge;
+    DynamicBlocksContainer container(config);
+    EXPECT_EQ(container.get_block_size(0), HUGE_PAGE_SIZE);
+
+    void* a = container.allocate(HUGE_PAGE_SIZE);
+    ASSERT_EQ(container.get_num_blocks(), 2u);
+    EXPECT_EQ(container.get_block_size(1), 2 * HUGE_PAGE_SIZE);
+    std::memset(a, 0x66, HUGE_PAGE_SIZE);
+
+    // The rounded-up tail of the block is still attributed to it
+    void* b = container.allocate(HUGE_PAGE_SIZE - 4096);
+    EXPECT_EQ(container.get_num_blocks(), 2u);
+    container.deallocate(b, HUGE_PAGE_SIZE - 4096);
+    container.deallocate(a, HUGE_PAGE_SIZE);
+}
+
+/**
+ * @test With a reservation the container grows its block in place instead of creating
+ * new ones, until the reservation is exhausted
+ */
+TEST(BlocksContainerTest, SMALL_Dynamic_ReservedBlockGrowsInPlace) {
+    ContainerConfig config;
+    config.initial_block_size = 64 * 1024;
+    config.max_block_size = 256 * 1024;
+    config.reserve_block_size = 1024 * 1024;
+    DynamicBlocksContainer container(config);
+    EXPECT_EQ(container.get_block_size(0), 64 * 1024u);
+    EXPECT_EQ(container.get_block_reserved_size(0), 1024 * 1024u);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 30; i++) {
+        ptrs.push_back(container.allocate(30 * 1024));
+        std::memset(ptrs.back(), i, 30 * 1024);
+    }
+    EXPECT_EQ(container.get_num_blocks(), 1u);
+    EXPECT_GT(container.get_block_size(0), 30 * 30 * 1024u);
+
+    // The reservation is full: the next block is created as usual
+    for (int i = 0; i < 5; i++) {
+        ptrs.push_back(container.allocate(30 * 1024));
+    }
+    EXPECT_EQ(container.get_num_blocks(), 2u);
+
+    for (void* ptr : ptrs) {
+        container.deallocate(ptr, 30 * 1024);
+    }
+}
+
+/**
+ * @test Requests rounded to the same size class reuse each other's chunks
+ */
+TEST(BlocksContainerTest, SMALL_Dynamic_SizeClassesReuseChunks) {
+    ContainerConfig config;
+    config.initial_block_size = 64 * 1024;
+    config.size_classes.geometric_threshold = 512;
+    DynamicBlocksContainer container(config);
+
+    void* first = container.allocate(600);
+    void* guard = container.allocate(32);
+    container.deallocate(first, 600);
+    void* second = container.allocate(630);
+    EXPECT_EQ(second, first);
+
+    std::vector<void*> batch(4);
+    container.allocate_batch(600, batch.size(), batch.data());
+    for (std::size_t i = 1; i < batch.size(); i++) {
+        EXPECT_EQ(static_cast<char*>(batch[i]) - static_cast<char*>(batch[i - 1]),
+                  static_cast<std::ptrdiff_t>(640 + MEMORY_NODE_SIZE));
+    }
+
+    container.deallocate_batch(batch.data(), batch.size(), 600);
+    container.deallocate(second, 630);
+    container.deallocate(guard, 32);
+}
+
+/**
+ * @test Invalid configurations are rejected
+ */
+TEST(BlocksContainerTest, SMALL_Dynamic_RejectsInvalidConfig) {
+    EXPECT_THROW(DynamicBlocksContainer(ContainerConfig{8, 4096, 2, 0}), std::invalid_argument);
+    EXPECT_THROW(DynamicBlocksContainer(ContainerConfig{8192, 4096, 2, 0}),
+                 std::invalid_argument);
+    EXPECT_THROW(DynamicBlocksContainer(ContainerConfig{4096, 8192, 0, 0}),
+                 std::invalid_argument);
+
+    ContainerConfig config;
+    config.size_classes.granule = 48;
+    EXPECT_THROW(DynamicBlocksContainer{config}, std::invalid_argument);
+}
+
+// ==================== RESIZE ====================
+
+/**
+ * @test reallocate grows in place when the next chunk is free, copies otherwise,
+ * and leaves the free index consistent for later allocations
+ */
+TEST(BlocksContainerTest, SMALL_Resize_ReallocateInPlaceThenByCopy) {
+    BlocksContainer<4096, 2> container;
+
+    auto* a = static_cast<unsigned char*>(container.allocate(100));
+    for (int i = 0; i < 100; i++) {
+        a[i] = static_cast<unsigned char>(i);
+    }
+
+    // The rest of the block is free: grows in place
+    EXPECT_TRUE(container.try_expand(a, 100, 1000));
+    EXPECT_EQ(container.reallocate(a, 1000, 2000), a);
+
+    // A used neighbour forces a copy
+    void* b = container.allocate(100);
+    auto* moved = static_cast<unsigned char*>(container.reallocate(a, 2000, 3000));
+    EXPECT_NE(moved, a);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(moved[i], i);
+    }
+
+    // Shrinking never moves
+    EXPECT_TRUE(container.try_expand(moved, 3000, 50));
+    EXPECT_EQ(container.reallocate(moved, 50, 10), moved);
+
+    EXPECT_THROW(container.try_expand(b, 100, 0), std::invalid_argument);
+    container.deallocate(moved, 10);
+    container.deallocate(b, 100);
+    EXPECT_NE(container.allocate(4096 - MEMORY_NODE_SIZE), nullptr);
+}
+
+/**
+ * @test Large mappings are resized with mremap and keep their content when moved
+ */
+TEST(BlocksContainerTest, SMALL_Resize_LargeMappingsUseMremap) {
+    const std::size_t MiB = 1024 * 1024;
+    BlocksContainer<64 * 1024, 1> container;
+
+    auto* ptr = static_cast<unsigned char*>(container.allocate(4 * MiB));
+    ptr[0] = 0x5A;
+    ptr[4 * MiB - 1] = 0xA5;
+
+    auto* grown = static_cast<unsigned char*>(container.reallocate(ptr, 4 * MiB, 40 * MiB));
+    ASSERT_NE(grown, nullptr);
+    EXPECT_EQ(grown[0], 0x5A);
+    EXPECT_EQ(grown[4 * MiB - 1], 0xA5);
+    EXPECT_EQ(LargeMappingCache::instance().mapping_size(grown), 40 * MiB);
+    std::memset(grown, 0x3C, 40 * MiB);
+
+    EXPECT_TRUE(container.try_expand(grown, 40 * MiB, 3 * MiB));
+    EXPECT_EQ(LargeMappingCache::instance().mapping_size(grown), 3 * MiB);
+    EXPECT_EQ(grown[3 * MiB - 1], 0x3C);
+
+    container.deallocate(grown, 3 * MiB);
+}
+
+// ==================== BATCHES ====================
+
+/**
+ * @test A batch larger than a block spills into new blocks; freeing it shuffled,
+ * along with a large mapping, empties every block again
+ */
+TEST(BlocksContainerTest, SMALL_Batch_AllocateAcrossBlocksAndFreeShuffled) {
+    DynamicBlocksContainer container(ContainerConfig{16 * 1024, 64 * 1024, 2, 0});
+
+    std::vector<void*> ptrs(1000);
+    container.allocate_batch(100, ptrs.size(), ptrs.data());
+    EXPECT_GT(container.get_num_blocks(), 1u);
+    for (std::size_t i = 0; i < ptrs.size(); i++) {
+        std::memset(ptrs[i], static_cast<int>(i & 0xFF), 100);
+    }
+    for (std::size_t i = 0; i < ptrs.size(); i++) {
+        EXPECT_EQ(static_cast<unsigned char*>(ptrs[i])[99], i & 0xFF);
+    }
+    std::vector<void*> sorted = ptrs;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(std::adjacent_find(sorted.begin(), sorted.end()), sorted.end());
+
+    std::mt19937 rng(7);
+    std::shuffle(ptrs.begin(), ptrs.end(), rng);
+    ptrs.push_back(container.allocate(1024 * 1024));
+    container.deallocate_batch(ptrs.data(), ptrs.size(), 100);
+
+    for (std::size_t i = 0; i < container.get_num_blocks(); i++) {
+        void* whole = container.allocate(container.get_block_size(i) - MEMORY_NODE_SIZE);
+        EXPECT_EQ(whole, (char*)container.get_block_head(i) + MEMORY_NODE_SIZE);
+    }
+}
+
 // ==================== EDGE CASES ====================
 
 /**
@@ -217,13 +537,17 @@ TEST(BlocksContainerTest, SMALL_EdgeCase_AllocateZeroBytes) {
 }
 
 /**
- * @test Allocation request larger than BlockSize handles without crash
+ * @test Allocation request larger than BlockSize is served by the large mapping cache
  */
 TEST(BlocksContainerTest, SMALL_EdgeCase_AllocateLargerThanBlockSize) {
     BlocksContainer<400, 10> container;
 
     void* ptr = container.allocate(400);
-    EXPECT_EQ(ptr, nullptr);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_TRUE(LargeMappingCache::instance().owns(ptr));
+    std::memset(ptr, 0xAB, 400);
+
+    container.deallocate(ptr, 400);
 }
 
 // /**
@@ -255,6 +579,30 @@ TEST(BlocksContainerTest, SMALL_EdgeCase_AllocateBiggerThanBlockSize_DeallocateP
     container.deallocate(ptr, large_size);
 }
 
+/**
+ * @test Aligned allocations are aligned both from blocks and from the mmap fallback
+ */
+TEST(BlocksContainerTest, SMALL_EdgeCase_AllocateAligned) {
+    BlocksContainer<16 * 1024, 2> container;
+
+    void* small = container.allocate(24);
+    void* line = container.allocate_aligned(200, 64);
+    void* page = container.allocate_aligned(512, 4096);
+    void* huge = container.allocate_aligned(100000, 64 * 1024);
+
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(line) % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(page) % 4096, 0u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(huge) % (64 * 1024), 0u);
+    std::memset(huge, 0xCD, 100000);
+
+    container.deallocate(huge, 100000);
+    container.deallocate(page, 512);
+    container.deallocate(line, 200);
+    container.deallocate(small, 24);
+
+    EXPECT_THROW({ container.allocate_aligned(64, 48); }, std::invalid_argument);
+}
+
 // ==================== DATA INTEGRITY TESTS ====================
 
 /**
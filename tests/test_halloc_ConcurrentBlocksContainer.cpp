@@ -0,0 +1,214 @@
+/**
+ * @file test_halloc_ConcurrentBlocksContainer.cpp
+ * @brief Unit tests for ConcurrentBlocksContainer (per-block locking)
+ *
+ * Test Coverage:
+ * - Basic Functionality: Single allocation, reuse after free, zero bytes
+ * - Multiple Blocks : Block creation on demand, mmap fallback past the limit
+ * - Multi-threading : Concurrent allocations with data checks, concurrent growth,
+ *                     cross-thread frees, ConcurrentHalloc with STL containers
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../halloc/includes/ConcurrentBlocksContainer.hpp"
+#include "../halloc/includes/Halloc.hpp"
+
+using namespace hh::halloc;
+
+class ConcurrentBlocksContainerTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+
+    void TearDown() override {}
+};
+
+// ==================== BASIC FUNCTIONALITY TESTS ====================
+
+/**
+ * @test Single allocation returns writable memory that can be reused after free
+ */
+TEST(ConcurrentBlocksContainerTest, SMALL_Allocate_DeallocateAndReuse) {
+    ConcurrentBlocksContainer<1024, 2> container;
+
+    void* ptr1 = container.allocate(1024 - MEMORY_NODE_SIZE);
+    EXPECT_NE(ptr1, nullptr);
+    std::memset(ptr1, 0xAA, 1024 - MEMORY_NODE_SIZE);
+    container.deallocate(ptr1, 1024 - MEMORY_NODE_SIZE);
+
+    void* ptr2 = container.allocate(1024 - MEMORY_NODE_SIZE);
+    EXPECT_EQ(ptr2, ptr1);
+    container.deallocate(ptr2, 1024 - MEMORY_NODE_SIZE);
+}
+
+/**
+ * @test Zero-byte allocation is rejected
+ */
+TEST(ConcurrentBlocksContainerTest, SMALL_EdgeCase_AllocateZeroBytes) {
+    ConcurrentBlocksContainer<1024, 2> container;
+
+    EXPECT_THROW({ container.allocate(0); }, std::invalid_argument);
+}
+
+// ==================== MULTIPLE BLOCKS TESTS ====================
+
+/**
+ * @test New blocks are created when existing ones are full, then mmap takes over
+ */
+TEST(ConcurrentBlocksContainerTest, SMALL_MultipleBlocks_GrowThenFallBackToMmap) {
+    ConcurrentBlocksContainer<512, 3> container;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 6; i++) {
+        void* ptr = container.allocate(512 - MEMORY_NODE_SIZE);
+        EXPECT_NE(ptr, nullptr);
+        std::memset(ptr, i, 512 - MEMORY_NODE_SIZE);
+        ptrs.push_back(ptr);
+    }
+
+    for (void* ptr : ptrs) {
+        container.deallocate(ptr, 512 - MEMORY_NODE_SIZE);
+    }
+}
+
+/**
+ * @test Requests larger than a block are served by mmap and released properly
+ */
+TEST(ConcurrentBlocksContainerTest, SMALL_EdgeCase_AllocateBiggerThanBlockSize) {
+    ConcurrentBlocksContainer<1024, 4> container;
+
+    void* ptr = container.allocate(8192);
+    EXPECT_NE(ptr, nullptr);
+    std::memset(ptr, 0xAB, 8192);
+    container.deallocate(ptr, 8192);
+}
+
+// ==================== MULTI-THREADING TESTS ====================
+
+/**
+ * @test Threads allocate, verify and free concurrently without corrupting data
+ */
+TEST(ConcurrentBlocksContainerTest, STRESS_ConcurrentAllocations) {
+    ConcurrentBlocksContainer<1024 * 1024, 16> container;
+
+    auto worker = [&container](int id) {
+        std::vector<std::pair<unsigned char*, std::size_t>> live;
+        for (int i = 0; i < 20000; i++) {
+            std::size_t size = 16 + ((i * 53 + id * 7) % 4000);
+            auto* ptr = static_cast<unsigned char*>(container.allocate(size));
+            std::memset(ptr, id, size);
+            live.push_back({ptr, size});
+
+            if (live.size() > 128) {
+                auto [old_ptr, old_size] = live[i % live.size()];
+                for (std::size_t j = 0; j < old_size; j++) {
+                    ASSERT_EQ(old_ptr[j], (unsigned char)id);
+                }
+                container.deallocate(old_ptr, old_size);
+                live[i % live.size()] = live.back();
+                live.pop_back();
+            }
+        }
+        for (auto [ptr, size] : live) {
+            container.deallocate(ptr, size);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back(worker, t + 1);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @test Many threads growing the container at once never exceed the block limit
+ */
+TEST(ConcurrentBlocksContainerTest, STRESS_ConcurrentGrowth) {
+    ConcurrentBlocksContainer<64 * 1024, 8> container;
+
+    std::vector<std::vector<void*>> per_thread(8);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&container, &per_thread, t]() {
+            for (int i = 0; i < 200; i++) {
+                void* ptr = container.allocate(1024);
+                std::memset(ptr, t, 1024);
+                per_thread[t].push_back(ptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 0; t < 8; t++) {
+        for (void* ptr : per_thread[t]) {
+            EXPECT_EQ(*static_cast<unsigned char*>(ptr), (unsigned char)t);
+            container.deallocate(ptr, 1024);
+        }
+    }
+}
+
+/**
+ * @test Chunks allocated by one thread can be freed by another concurrently
+ */
+TEST(ConcurrentBlocksContainerTest, STRESS_CrossThreadDeallocation) {
+    ConcurrentBlocksContainer<256 * 1024, 4> container;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 2000; i++) {
+        ptrs.push_back(container.allocate(64 + i % 256));
+    }
+
+    std::thread even([&]() {
+        for (std::size_t i = 0; i < ptrs.size(); i += 2) {
+            container.deallocate(ptrs[i], 64 + i % 256);
+        }
+    });
+    std::thread odd([&]() {
+        for (std::size_t i = 1; i < ptrs.size(); i += 2) {
+            container.deallocate(ptrs[i], 64 + i % 256);
+        }
+    });
+    even.join();
+    odd.join();
+
+    void* whole = container.allocate(256 * 1024 - MEMORY_NODE_SIZE);
+    EXPECT_NE(whole, nullptr);
+    container.deallocate(whole, 256 * 1024 - MEMORY_NODE_SIZE);
+}
+
+/**
+ * @test ConcurrentHalloc works with STL containers used from several threads
+ */
+TEST(ConcurrentBlocksContainerTest, STRESS_ConcurrentHallocWithVectors) {
+    ConcurrentHalloc<int, 1024 * 1024, 8> alloc;
+
+    auto worker = [alloc](int id) {
+        for (int round = 0; round < 50; round++) {
+            std::vector<int, ConcurrentHalloc<int, 1024 * 1024, 8>> v(alloc);
+            for (int i = 0; i < 1000; i++) {
+                v.push_back(i * id);
+            }
+            for (int i = 0; i < 1000; i++) {
+                ASSERT_EQ(v[i], i * id);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back(worker, t + 1);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <random>
@@ -24,6 +25,140 @@ protected:
     void TearDown() override {}
 };
 
+TEST(HallocTest, SMALL_OverAlignedTypeIsAligned) {
+    struct alignas(64) CacheLine {
+        int value;
+    };
+
+    std::vector<CacheLine, Halloc<CacheLine, 1024 * 1024>> v;
+    for (int i = 0; i < 1000; i++) {
+        v.push_back(CacheLine{i});
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(v.data()) % 64, 0u);
+    }
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(v[i].value, i);
+    }
+
+    Halloc<float, 1024 * 1024> floats;
+    float* simd = floats.allocate_aligned(64, 32);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(simd) % 32, 0u);
+    floats.deallocate(simd, 64);
+}
+
+TEST(HallocTest, SMALL_DynamicHallocGrowsFromConfig) {
+    DynamicHalloc<int> alloc(ContainerConfig{64 * 1024, 1024 * 1024, 2, 0});
+    std::vector<int, DynamicHalloc<int>> v(alloc);
+    for (int i = 0; i < 100000; i++) {
+        v.push_back(i);
+    }
+    for (int i = 0; i < 100000; i++) {
+        EXPECT_EQ(v[i], i);
+    }
+
+    // Block sizes above the 2 GiB limit of the old int template parameter
+    DynamicHalloc<char> big(ContainerConfig{std::size_t{3} << 30, std::size_t{3} << 30, 1, 1});
+    char* p = big.allocate(std::size_t{5} << 29);
+    p[(std::size_t{5} << 29) - 1] = 'x';
+    big.deallocate(p, std::size_t{5} << 29);
+}
+
+namespace {
+/// Grows a buffer one element at a time through reallocate, checking its content
+template <typename Alloc>
+void grow_buffer_with_reallocate(Alloc alloc) {
+    using T = typename Alloc::value_type;
+    std::size_t capacity = 1;
+    T* data = alloc.allocate(capacity);
+    for (std::size_t i = 0; i < 5000; i++) {
+        if (i == capacity) {
+            data = alloc.reallocate(data, capacity, capacity * 3 / 2 + 1);
+            capacity = capacity * 3 / 2 + 1;
+        }
+        data[i] = static_cast<T>(i);
+    }
+    for (std::size_t i = 0; i < 5000; i++) {
+        ASSERT_EQ(data[i], static_cast<T>(i));
+    }
+
+    // Shrinking keeps the pointer and the leading elements
+    ASSERT_TRUE(alloc.try_expand(data, capacity, 100));
+    for (std::size_t i = 0; i < 100; i++) {
+        ASSERT_EQ(data[i], static_cast<T>(i));
+    }
+    alloc.deallocate(data, 100);
+}
+}  // namespace
+
+/**
+ * @test reallocate keeps the content of a growing buffer with every container
+ */
+TEST(HallocTest, SMALL_ReallocateKeepsContent) {
+    grow_buffer_with_reallocate(Halloc<int, 1024 * 1024>());
+    grow_buffer_with_reallocate(DynamicHalloc<double>(ContainerConfig{4096, 65536, 2, 0}));
+    grow_buffer_with_reallocate(CachedHalloc<int, 1024 * 1024>());
+    grow_buffer_with_reallocate(ConcurrentHalloc<int, 1024 * 1024, 2>());
+    grow_buffer_with_reallocate(PerCpuHalloc<int, 1024 * 1024, 2>());
+
+    struct alignas(64) CacheLine {
+        std::size_t value;
+        CacheLine() = default;
+        explicit CacheLine(std::size_t v) : value(v) {}
+        bool operator==(const CacheLine& other) const { return value == other.value; }
+    };
+    Halloc<CacheLine, 1024 * 1024> lines;
+    CacheLine* p = lines.allocate(10);
+    p[0] = CacheLine(7);
+    lines.allocate(1);  // Keeps p from growing in place
+    p = lines.reallocate(p, 10, 1000);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % 64, 0u);
+    EXPECT_EQ(p[0].value, 7u);
+    lines.deallocate(p, 1000);
+}
+
+/**
+ * @test A buffer that grows by reallocate mostly stays in place
+ */
+TEST(HallocTest, SMALL_ReallocateGrowsInPlace) {
+    Halloc<char, 1024 * 1024> alloc;
+    char* data = alloc.allocate(64);
+    char* first = data;
+    for (std::size_t size = 64; size < 512 * 1024; size *= 2) {
+        data = alloc.reallocate(data, size, size * 2);
+    }
+    EXPECT_EQ(data, first);
+    alloc.deallocate(data, 512 * 1024);
+}
+
+namespace {
+/// Allocates, fills, checks and frees a few batches of small arrays
+template <typename Alloc>
+void round_trip_batches(Alloc alloc) {
+    std::vector<int*> arrays(300);
+    for (int round = 0; round < 3; round++) {
+        alloc.allocate_batch(8, arrays.size(), arrays.data());
+        for (std::size_t i = 0; i < arrays.size(); i++) {
+            std::fill(arrays[i], arrays[i] + 8, static_cast<int>(i));
+        }
+        for (std::size_t i = 0; i < arrays.size(); i++) {
+            ASSERT_EQ(arrays[i][0], static_cast<int>(i));
+            ASSERT_EQ(arrays[i][7], static_cast<int>(i));
+        }
+        alloc.deallocate_batch(arrays.data(), arrays.size(), 8);
+    }
+}
+}  // namespace
+
+/**
+ * @test Batch allocation and deallocation work with every container
+ */
+TEST(HallocTest, SMALL_BatchRoundTrip) {
+    round_trip_batches(Halloc<int, 1024 * 1024>());
+    round_trip_batches(DynamicHalloc<int>(ContainerConfig{4096, 65536, 2, 0}));
+    round_trip_batches(CachedHalloc<int, 1024 * 1024>());
+    round_trip_batches(ConcurrentHalloc<int, 1024 * 1024, 2>());
+    round_trip_batches(PerCpuHalloc<int, 1024 * 1024, 2>());
+}
+
 TEST(HallocTest, STRESS_TestWithVector) {
     // Test that Halloc works with std::vector
 
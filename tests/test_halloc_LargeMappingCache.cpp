@@ -0,0 +1,282 @@
+/**
+ * @file test_halloc_LargeMappingCache.cpp
+ * @brief Unit tests for LargeMappingCache (large-allocation registry and reuse cache)
+ *
+ * Test Coverage:
+ * - Size Classes : Page rounding, four classes per power of two, impossible sizes
+ * - Registry : Mapped sizes recorded and cleared
+ * - Reuse : Same-class reuse, alignment, byte limit, decay
+ * - Resize : In-place growth and shrinking, moving with mremap
+ * - Containers : Requests larger than a block go through the shared cache,
+ *                 unknown pointers are ignored
+ * - Multi-threading : Concurrent allocate/deallocate of large mappings
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../halloc/includes/BlocksContainer.hpp"
+#include "../halloc/includes/LargeMappingCache.hpp"
+
+using namespace hh::halloc;
+
+class LargeMappingCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+
+    void TearDown() override {}
+};
+
+namespace {
+constexpr std::size_t MiB = 1024 * 1024;
+}  // namespace
+
+// ==================== SIZE CLASSES ====================
+
+/**
+ * @test Sizes are rounded to whole pages, then to a quarter of their power of two
+ */
+TEST(LargeMappingCacheTest, SMALL_SizeClass_RoundsToQuarterSteps) {
+    EXPECT_EQ(LargeMappingCache::size_class(1), 4096u);
+    EXPECT_EQ(LargeMappingCache::size_class(4096), 4096u);
+    EXPECT_EQ(LargeMappingCache::size_class(5000), 8192u);
+    EXPECT_EQ(LargeMappingCache::size_class(4 * MiB), 4 * MiB);
+    EXPECT_EQ(LargeMappingCache::size_class(4 * MiB + 1), 5 * MiB);
+    EXPECT_EQ(LargeMappingCache::size_class(7 * MiB + 1), 8 * MiB);
+    EXPECT_EQ(LargeMappingCache::size_class(40 * MiB), 40 * MiB);
+}
+
+/**
+ * @test Requests beyond the address space are refused instead of overflowing the classes
+ */
+TEST(LargeMappingCacheTest, SMALL_SizeClass_RejectsImpossibleSizes) {
+    LargeMappingCache cache;
+    EXPECT_THROW(cache.allocate(SIZE_MAX / 2, 16), std::bad_alloc);
+    EXPECT_THROW(cache.allocate((std::size_t{1} << PageMap::ADDRESS_BITS) + 1, 16),
+                 std::bad_alloc);
+    EXPECT_EQ(cache.allocate(SIZE_MAX / 2, 16, std::nothrow), nullptr);
+}
+
+// ==================== REGISTRY AND REUSE ====================
+
+/**
+ * @test A freed mapping is cached and served again to the next request of its class
+ */
+TEST(LargeMappingCacheTest, SMALL_Reuse_SameClassGetsCachedMapping) {
+    LargeMappingCache cache;
+
+    void* ptr = cache.allocate(4 * MiB + 100, MIN_ALIGNMENT);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_TRUE(cache.owns(ptr));
+    EXPECT_EQ(cache.mapping_size(ptr), 5 * MiB);
+    std::memset(ptr, 0xAB, 4 * MiB + 100);
+
+    cache.deallocate(ptr);
+    EXPECT_EQ(cache.get_cached_bytes(), 5 * MiB);
+
+    void* again = cache.allocate(5 * MiB, MIN_ALIGNMENT);
+    EXPECT_EQ(again, ptr);
+    EXPECT_EQ(cache.get_cached_bytes(), 0u);
+
+    // A different class maps anew
+    void* other = cache.allocate(8 * MiB, MIN_ALIGNMENT);
+    EXPECT_NE(other, ptr);
+
+    cache.deallocate(again);
+    cache.deallocate(other);
+    cache.purge();
+    EXPECT_EQ(cache.get_cached_bytes(), 0u);
+    EXPECT_FALSE(cache.owns(ptr));
+}
+
+/**
+ * @test Over-aligned requests get aligned mappings, and are only reused when aligned
+ */
+TEST(LargeMappingCacheTest, SMALL_Reuse_HonoursAlignment) {
+    LargeMappingCache cache;
+
+    void* ptr = cache.allocate(MiB, 2 * MiB);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % (2 * MiB), 0u);
+    cache.deallocate(ptr);
+
+    void* again = cache.allocate(MiB, 2 * MiB);
+    EXPECT_EQ(again, ptr);
+    cache.deallocate(again);
+}
+
+/**
+ * @test The cache never holds more than its byte limit; larger mappings are unmapped
+ */
+TEST(LargeMappingCacheTest, SMALL_Limit_EvictsOldestMappings) {
+    LargeMappingCache cache(8 * MiB);
+
+    void* a = cache.allocate(4 * MiB, MIN_ALIGNMENT);
+    void* b = cache.allocate(3 * MiB, MIN_ALIGNMENT);
+    void* c = cache.allocate(2 * MiB, MIN_ALIGNMENT);
+    void* huge = cache.allocate(16 * MiB, MIN_ALIGNMENT);
+
+    cache.deallocate(a);
+    cache.deallocate(b);
+    EXPECT_EQ(cache.get_cached_bytes(), 7 * MiB);
+
+    // a is the oldest entry and makes room for c
+    cache.deallocate(c);
+    EXPECT_EQ(cache.get_cached_bytes(), 5 * MiB);
+    EXPECT_FALSE(cache.owns(a));
+    EXPECT_TRUE(cache.owns(b));
+
+    cache.deallocate(huge);
+    EXPECT_EQ(cache.get_cached_bytes(), 5 * MiB);
+    EXPECT_FALSE(cache.owns(huge));
+}
+
+/**
+ * @test Mappings idle for longer than the decay period are unmapped
+ */
+TEST(LargeMappingCacheTest, SMALL_Decay_UnmapsIdleMappings) {
+    LargeMappingCache cache(64 * MiB, std::chrono::milliseconds(20));
+
+    void* a = cache.allocate(4 * MiB, MIN_ALIGNMENT);
+    void* b = cache.allocate(6 * MiB, MIN_ALIGNMENT);
+    cache.deallocate(a);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    cache.deallocate(b);
+    EXPECT_EQ(cache.get_cached_bytes(), 6 * MiB);
+    EXPECT_FALSE(cache.owns(a));
+    cache.purge();
+}
+
+// ==================== RESIZE ====================
+
+/**
+ * @test Mappings shrink in place, and grow in place when the address space after
+ * them is free; reallocate moves them otherwise, keeping their content
+ */
+TEST(LargeMappingCacheTest, SMALL_Resize_TryExpandAndReallocate) {
+    LargeMappingCache cache(0);
+
+    auto* ptr = static_cast<unsigned char*>(cache.allocate(4 * MiB, MIN_ALIGNMENT));
+    ptr[0] = 1;
+
+    EXPECT_TRUE(cache.try_expand(ptr, 4 * MiB - 100));
+    EXPECT_TRUE(cache.try_expand(ptr, 2 * MiB));
+    EXPECT_EQ(cache.mapping_size(ptr), 2 * MiB);
+
+    // Growing in place depends on what the kernel mapped after the mapping
+    if (cache.try_expand(ptr, 6 * MiB)) {
+        EXPECT_EQ(cache.mapping_size(ptr), 6 * MiB);
+        ptr[6 * MiB - 1] = 2;
+    }
+
+    // Block the address space right after the mapping: growth must move it
+    std::size_t mapped = cache.mapping_size(ptr);
+    void* wall = mmap(ptr + mapped, 4096, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (wall != MAP_FAILED) {
+        EXPECT_FALSE(cache.try_expand(ptr, mapped + 1));
+    }
+    auto* moved = static_cast<unsigned char*>(cache.reallocate(ptr, 32 * MiB));
+    EXPECT_EQ(moved[0], 1);
+    EXPECT_EQ(cache.mapping_size(moved), 32 * MiB);
+    if (moved != ptr) {
+        EXPECT_FALSE(cache.owns(ptr));
+    }
+    moved[32 * MiB - 1] = 3;
+
+    if (wall != MAP_FAILED) {
+        RELEASE_MEMORY_VIA_MUNMAP(wall, 4096);
+    }
+    cache.deallocate(moved);
+    EXPECT_FALSE(cache.owns(moved));
+}
+
+// ==================== CONTAINERS ====================
+
+/**
+ * @test A request larger than a block is served by the shared cache and reused after free
+ */
+TEST(LargeMappingCacheTest, SMALL_Container_LargeRequestsAreCached) {
+    BlocksContainer<64 * 1024, 2> container;
+
+    void* ptr = container.allocate(6 * MiB);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(container.get_num_blocks(), 1u);
+    EXPECT_TRUE(LargeMappingCache::instance().owns(ptr));
+    std::memset(ptr, 0x5C, 6 * MiB);
+
+    // The byte count is no longer needed to release the mapping
+    container.deallocate(ptr, 0);
+    void* again = container.allocate(6 * MiB);
+    EXPECT_EQ(again, ptr);
+    container.deallocate(again, 6 * MiB);
+}
+
+/**
+ * @test Freeing a pointer that no block or mapping owns is ignored instead of crashing
+ */
+TEST(LargeMappingCacheTest, SMALL_Container_UnknownPointerIsIgnored) {
+    LargeMappingCache cache;
+    BlocksContainer<64 * 1024, 2> container;
+    DynamicBlocksContainer dynamic(ContainerConfig{64 * 1024, 64 * 1024, 2, 0});
+    long local = 42;
+
+    EXPECT_FALSE(cache.owns(&local));
+    cache.deallocate(&local);
+    container.deallocate(&local, sizeof(local));
+    dynamic.deallocate(&local, sizeof(local));
+    EXPECT_EQ(cache.get_cached_bytes(), 0u);
+    EXPECT_FALSE(cache.try_expand(&local, 2 * MiB));
+    EXPECT_THROW(cache.reallocate(&local, 2 * MiB), std::invalid_argument);
+    EXPECT_EQ(local, 42);
+
+    void* ptr = container.allocate(100);
+    ASSERT_NE(ptr, nullptr);
+    container.deallocate(ptr, 100);
+}
+
+// ==================== MULTI-THREADING ====================
+
+/**
+ * @test Threads allocating and freeing large mappings concurrently never share one
+ */
+TEST(LargeMappingCacheTest, STRESS_ConcurrentAllocateDeallocate) {
+    LargeMappingCache cache(32 * MiB);
+    constexpr int NUM_THREADS = 4;
+    constexpr int ITERATIONS = 500;
+
+    std::vector<std::thread> threads;
+    std::vector<int> failures(NUM_THREADS, 0);
+    for (int t = 0; t < NUM_THREADS; t++) {
+        threads.emplace_back([&cache, &failures, t] {
+            for (int i = 0; i < ITERATIONS; i++) {
+                std::size_t bytes = (1 + (i + t) % 6) * MiB;
+                auto* ptr = static_cast<unsigned char*>(cache.allocate(bytes, MIN_ALIGNMENT));
+                ptr[0] = static_cast<unsigned char>(t);
+                ptr[bytes - 1] = static_cast<unsigned char>(t);
+                std::this_thread::yield();
+                if (ptr[0] != t || ptr[bytes - 1] != t) {
+                    failures[t]++;
+                }
+                cache.deallocate(ptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 0; t < NUM_THREADS; t++) {
+        EXPECT_EQ(failures[t], 0);
+    }
+    EXPECT_LE(cache.get_cached_bytes(), 32 * MiB);
+}
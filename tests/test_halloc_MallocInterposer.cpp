@@ -0,0 +1,295 @@
+/**
+ * @file test_halloc_MallocInterposer.cpp
+ * @brief Unit tests for the LD_PRELOAD malloc replacement (libhalloc_malloc.so)
+ *
+ * Built as a separate executable that ctest runs with LD_PRELOAD set, so every
+ * allocation in the process, GoogleTest's included, goes through the interposer.
+ *
+ * Test Coverage:
+ * - Interposition : malloc, free and operator new resolve to libhalloc_malloc.so
+ * - C Functions : malloc/free, usable size, calloc, realloc, reallocarray,
+ *                 posix_memalign, aligned_alloc, memalign, valloc, pvalloc
+ * - C++ Operators : Plain, array, aligned and nothrow new/delete
+ * - Stress Tests : Cross-thread frees of mixed sizes
+ *
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <gtest/gtest.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Returns the path of the shared object that defines a function.
+ */
+std::string defining_object(const void* function) {
+    Dl_info info{};
+    if (dladdr(function, &info) == 0 || info.dli_fname == nullptr) {
+        return "";
+    }
+    return info.dli_fname;
+}
+
+bool is_aligned(const void* ptr, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+}  // namespace
+
+// ==================== INTERPOSITION TESTS ====================
+
+/**
+ * @test The process's allocation functions are the interposer's, not libc's
+ */
+TEST(MallocInterposerTest, SMALL_SymbolsResolveToInterposer) {
+    void* (*new_function)(std::size_t) = &::operator new;
+    EXPECT_NE(defining_object(reinterpret_cast<void*>(&malloc)).find("libhalloc_malloc"),
+              std::string::npos);
+    EXPECT_NE(defining_object(reinterpret_cast<void*>(&free)).find("libhalloc_malloc"),
+              std::string::npos);
+    EXPECT_NE(defining_object(reinterpret_cast<void*>(new_function)).find("libhalloc_malloc"),
+              std::string::npos);
+}
+
+// ==================== C FUNCTION TESTS ====================
+
+/**
+ * @test malloc returns aligned, distinct memory whose usable size covers the request
+ */
+TEST(MallocInterposerTest, SMALL_MallocFreeAndUsableSize) {
+    std::vector<char*> ptrs;
+    for (std::size_t bytes : {0u, 1u, 24u, 100u, 4096u, 100000u, 80u * 1024 * 1024}) {
+        auto* ptr = static_cast<char*>(malloc(bytes));
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_TRUE(is_aligned(ptr, alignof(std::max_align_t)));
+        EXPECT_GE(malloc_usable_size(ptr), bytes);
+        std::memset(ptr, 0x5A, malloc_usable_size(ptr));
+        ptrs.push_back(ptr);
+    }
+    EXPECT_NE(ptrs[0], ptrs[1]);
+    EXPECT_EQ(malloc_usable_size(nullptr), 0u);
+
+    for (char* ptr : ptrs) {
+        free(ptr);
+    }
+    free(nullptr);
+}
+
+/**
+ * @test calloc zeroes reused memory and rejects overflowing sizes
+ */
+TEST(MallocInterposerTest, SMALL_CallocZeroesAndChecksOverflow) {
+    for (int round = 0; round < 4; round++) {
+        auto* dirty = static_cast<unsigned char*>(malloc(4096));
+        std::memset(dirty, 0xFF, 4096);
+        free(dirty);
+
+        auto* clean = static_cast<unsigned char*>(calloc(512, 8));
+        ASSERT_NE(clean, nullptr);
+        for (std::size_t i = 0; i < 4096; i++) {
+            ASSERT_EQ(clean[i], 0);
+        }
+        free(clean);
+    }
+
+    errno = 0;
+    EXPECT_EQ(calloc(std::numeric_limits<std::size_t>::max() / 2, 3), nullptr);
+    EXPECT_EQ(errno, ENOMEM);
+}
+
+/**
+ * @test realloc keeps the content while growing into a large mapping and shrinking back
+ */
+TEST(MallocInterposerTest, SMALL_ReallocPreservesContent) {
+    auto* ptr = static_cast<unsigned char*>(realloc(nullptr, 64));
+    ASSERT_NE(ptr, nullptr);
+    for (int i = 0; i < 64; i++) {
+        ptr[i] = static_cast<unsigned char>(i);
+    }
+
+    for (std::size_t bytes : {200u, 5000u, 1u << 20, 100u << 20, 3000u, 64u}) {
+        ptr = static_cast<unsigned char*>(realloc(ptr, bytes));
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_GE(malloc_usable_size(ptr), bytes);
+        for (int i = 0; i < 64; i++) {
+            ASSERT_EQ(ptr[i], static_cast<unsigned char>(i));
+        }
+    }
+
+    ptr = static_cast<unsigned char*>(reallocarray(ptr, 16, 32));
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(ptr[63], 63);
+    errno = 0;
+    EXPECT_EQ(reallocarray(ptr, std::numeric_limits<std::size_t>::max(), 2), nullptr);
+    EXPECT_EQ(errno, ENOMEM);
+
+    EXPECT_EQ(realloc(ptr, 0), nullptr);
+}
+
+/**
+ * @test The aligned allocation functions honour their alignment and validate it;
+ * memalign rounds an alignment that is not a power of two up, like glibc
+ */
+TEST(MallocInterposerTest, SMALL_AlignedFunctions) {
+    auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+    for (std::size_t alignment = sizeof(void*); alignment <= (1u << 22); alignment <<= 1) {
+        void* ptr = nullptr;
+        ASSERT_EQ(posix_memalign(&ptr, alignment, 100), 0);
+        EXPECT_TRUE(is_aligned(ptr, alignment));
+        std::memset(ptr, 1, 100);
+        free(ptr);
+
+        void* other = aligned_alloc(alignment, 3 * alignment);
+        ASSERT_NE(other, nullptr);
+        EXPECT_TRUE(is_aligned(other, alignment));
+        EXPECT_GE(malloc_usable_size(other), 3 * alignment);
+        free(other);
+    }
+
+    void* untouched = &page;
+    EXPECT_EQ(posix_memalign(&untouched, 24, 100), EINVAL);
+    EXPECT_EQ(posix_memalign(&untouched, 4, 100), EINVAL);
+    EXPECT_EQ(untouched, &page);
+    errno = 0;
+    EXPECT_EQ(aligned_alloc(48, 96), nullptr);
+    EXPECT_EQ(errno, EINVAL);
+
+    void* by_memalign = memalign(256, 1000);
+    void* by_valloc = valloc(10);
+    void* by_pvalloc = pvalloc(page + 1);
+    EXPECT_TRUE(is_aligned(by_memalign, 256));
+    EXPECT_TRUE(is_aligned(by_valloc, page));
+    EXPECT_TRUE(is_aligned(by_pvalloc, page));
+    EXPECT_GE(malloc_usable_size(by_pvalloc), 2 * page);
+    free(by_memalign);
+    free(by_valloc);
+    free(by_pvalloc);
+
+    // memalign rounds other alignments up to a power of two instead of failing
+    void* rounded = memalign(24, 100);
+    ASSERT_NE(rounded, nullptr);
+    EXPECT_TRUE(is_aligned(rounded, 32));
+    void* rounded_large = memalign(3000, 100);
+    ASSERT_NE(rounded_large, nullptr);
+    EXPECT_TRUE(is_aligned(rounded_large, 4096));
+    void* unaligned = memalign(0, 100);
+    EXPECT_NE(unaligned, nullptr);
+    free(rounded);
+    free(rounded_large);
+    free(unaligned);
+}
+
+// ==================== C++ OPERATOR TESTS ====================
+
+/**
+ * @test Every form of operator new returns suitable memory that operator delete accepts
+ */
+TEST(MallocInterposerTest, SMALL_OperatorNewDelete) {
+    struct alignas(256) Overaligned {
+        char bytes[300];
+    };
+
+    auto* value = new long(7);
+    auto* array = new int[1000]();
+    auto* aligned = new Overaligned();
+    auto* aligned_array = new Overaligned[5];
+    auto* nothrow = new (std::nothrow) double[10];
+
+    EXPECT_EQ(*value, 7);
+    EXPECT_EQ(array[999], 0);
+    EXPECT_TRUE(is_aligned(aligned, 256));
+    EXPECT_TRUE(is_aligned(aligned_array, 256));
+    EXPECT_NE(nothrow, nullptr);
+
+    delete value;
+    delete[] array;
+    delete aligned;
+    delete[] aligned_array;
+    delete[] nothrow;
+
+    EXPECT_EQ(::operator new(std::numeric_limits<std::size_t>::max() / 2, std::nothrow), nullptr);
+    EXPECT_THROW(static_cast<void>(::operator new(std::numeric_limits<std::size_t>::max() / 2)),
+                 std::bad_alloc);
+    errno = 0;
+    EXPECT_EQ(malloc(std::numeric_limits<std::size_t>::max() - 8), nullptr);
+    EXPECT_EQ(errno, ENOMEM);
+
+    std::vector<std::string> strings;
+    for (int i = 0; i < 10000; i++) {
+        strings.push_back(std::to_string(i) + std::string(static_cast<std::size_t>(i % 100), 'x'));
+    }
+    EXPECT_EQ(strings[9999].size(), 4u + 99u);
+}
+
+// ==================== STRESS TESTS ====================
+
+/**
+ * @test Threads allocate mixed sizes and free each other's allocations
+ */
+TEST(MallocInterposerTest, STRESS_CrossThreadFrees) {
+    constexpr int THREADS = 4;
+    constexpr int ROUNDS = 20000;
+
+    std::mutex handoff_lock;
+    std::vector<std::pair<unsigned char*, std::size_t>> handoff;
+    std::atomic<int> corrupted{0};
+
+    auto worker = [&](unsigned seed) {
+        std::mt19937 rng(seed);
+        std::vector<std::pair<unsigned char*, std::size_t>> local;
+        for (int round = 0; round < ROUNDS; round++) {
+            std::size_t bytes = 1 + (rng() % 4 == 0 ? rng() % 65536 : rng() % 512);
+            auto* ptr = static_cast<unsigned char*>(malloc(bytes));
+            std::memset(ptr, static_cast<int>(bytes & 0xFF), bytes);
+            local.emplace_back(ptr, bytes);
+
+            if (local.size() > 64) {
+                std::lock_guard<std::mutex> guard(handoff_lock);
+                handoff.push_back(local.front());
+                local.erase(local.begin());
+                if (handoff.size() > 128) {
+                    for (std::size_t i = 0; i < 64; i++) {
+                        auto [victim, size] = handoff[i];
+                        if (victim[0] != static_cast<unsigned char>(size & 0xFF) ||
+                            victim[size - 1] != static_cast<unsigned char>(size & 0xFF)) {
+                            corrupted++;
+                        }
+                        free(victim);
+                    }
+                    handoff.erase(handoff.begin(), handoff.begin() + 64);
+                }
+            }
+        }
+        for (auto [ptr, bytes] : local) {
+            free(ptr);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; i++) {
+        threads.emplace_back(worker, static_cast<unsigned>(i + 1));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (auto [ptr, bytes] : handoff) {
+        free(ptr);
+    }
+    EXPECT_EQ(corrupted.load(), 0);
+}
@@ -0,0 +1,200 @@
+/**
+ * @file test_halloc_MemoryResource.cpp
+ * @brief Unit tests for the std::pmr memory resource adapter
+ *
+ * Test Coverage:
+ * - Basic Functionality: Allocation, zero bytes, alignment, identity comparison
+ * - Integration : pmr::vector and pmr::unordered_map sharing one resource,
+ *                 caller-owned containers, other containers, randomized stress
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../halloc/includes/ConcurrentBlocksContainer.hpp"
+#include "../halloc/includes/MemoryResource.hpp"
+
+using namespace hh::halloc;
+
+// ==================== BASIC FUNCTIONALITY TESTS ====================
+
+/**
+ * @test Allocations come from the resource's container and return to it
+ */
+TEST(MemoryResourceTest, SMALL_AllocateFromContainer) {
+    MemoryResource resource(ContainerConfig{64 * 1024, 1024 * 1024, 2, 0});
+
+    void* ptr = resource.allocate(100);
+    std::memset(ptr, 0xAB, 100);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % MIN_ALIGNMENT, 0u);
+    EXPECT_EQ(resource.get_container().get_num_blocks(), 1u);
+    resource.deallocate(ptr, 100);
+
+    // The freed chunk is the best fit for the next request of the same size
+    EXPECT_EQ(resource.allocate(100), ptr);
+    resource.deallocate(ptr, 100);
+
+    void* empty = resource.allocate(0);
+    EXPECT_NE(empty, nullptr);
+    resource.deallocate(empty, 0);
+}
+
+/**
+ * @test Over-aligned requests are honoured, from blocks and from large mappings
+ */
+TEST(MemoryResourceTest, SMALL_AllocateHonoursAlignment) {
+    MemoryResource resource(ContainerConfig{64 * 1024, 256 * 1024, 2, 0});
+
+    for (std::size_t alignment : {8u, 16u, 64u, 256u, 4096u}) {
+        void* small = resource.allocate(40, alignment);
+        void* large = resource.allocate(512 * 1024, alignment);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(small) % alignment, 0u);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large) % alignment, 0u);
+        resource.deallocate(large, 512 * 1024, alignment);
+        resource.deallocate(small, 40, alignment);
+    }
+}
+
+/**
+ * @test Resources compare equal only to themselves
+ */
+TEST(MemoryResourceTest, SMALL_IsEqualOnlyToItself) {
+    MemoryResource first;
+    MemoryResource second;
+
+    EXPECT_TRUE(first.is_equal(first));
+    EXPECT_FALSE(first.is_equal(second));
+    EXPECT_FALSE(first.is_equal(*std::pmr::new_delete_resource()));
+    EXPECT_TRUE(std::pmr::polymorphic_allocator<int>(&first) ==
+                std::pmr::polymorphic_allocator<long>(&first));
+}
+
+// ==================== INTEGRATION TESTS ====================
+
+/**
+ * @test pmr containers of different types draw from one resource
+ */
+TEST(MemoryResourceTest, SMALL_PmrContainersShareResource) {
+    MemoryResource resource;
+    {
+        std::pmr::vector<int> vec(&resource);
+        std::pmr::unordered_map<int, std::pmr::string> map(&resource);
+
+        for (int i = 0; i < 10000; i++) {
+            vec.push_back(i);
+            map.emplace(i, std::pmr::string(std::to_string(i) + " is a long enough string"));
+        }
+        for (int i = 0; i < 10000; i += 2) {
+            map.erase(i);
+        }
+
+        EXPECT_EQ(vec.size(), 10000u);
+        EXPECT_EQ(vec[9999], 9999);
+        EXPECT_EQ(map.size(), 5000u);
+        EXPECT_EQ(map.at(9999), "9999 is a long enough string");
+        EXPECT_EQ(map.get_allocator().resource(), &resource);
+        EXPECT_EQ(map.at(1).get_allocator().resource(), &resource);
+    }
+    EXPECT_EQ(resource.get_container().get_num_blocks(), 1u);
+}
+
+/**
+ * @test A resource over a caller-owned container shares it with direct users and
+ * leaves it intact when destroyed
+ */
+TEST(MemoryResourceTest, SMALL_SharesCallerOwnedContainer) {
+    DynamicBlocksContainer blocks(ContainerConfig{64 * 1024, 1024 * 1024, 2, 0});
+    void* direct = blocks.allocate(100);
+    {
+        MemoryResource resource(blocks);
+        EXPECT_EQ(&resource.get_container(), &blocks);
+
+        std::pmr::vector<int> vec(&resource);
+        for (int i = 0; i < 1000; i++) {
+            vec.push_back(i);
+        }
+        auto* head = static_cast<char*>(blocks.get_block_head(0));
+        auto* data = reinterpret_cast<char*>(vec.data());
+        EXPECT_TRUE(data > head && data < head + blocks.get_block_size(0));
+        EXPECT_EQ(vec[999], 999);
+    }
+
+    // The container outlives the resource and keeps serving its own users
+    std::memset(direct, 0x42, 100);
+    void* again = blocks.allocate(100);
+    EXPECT_NE(again, nullptr);
+    blocks.deallocate(again, 100);
+    blocks.deallocate(direct, 100);
+
+    ConcurrentBlocksContainer<1024 * 1024, 2> concurrent;
+    BasicMemoryResource<ConcurrentBlocksContainer<1024 * 1024, 2>> shared(concurrent);
+    std::pmr::vector<double> doubles(&shared);
+    doubles.assign(1000, 1.5);
+    EXPECT_EQ(doubles[999], 1.5);
+}
+
+/**
+ * @test The adapter works over the other containers
+ */
+TEST(MemoryResourceTest, SMALL_OtherContainers) {
+    BasicMemoryResource<BlocksContainer<1024 * 1024, 2>> fixed;
+    BasicMemoryResource<ConcurrentBlocksContainer<1024 * 1024, 2>> concurrent;
+
+    std::pmr::vector<double> a(&fixed);
+    std::pmr::vector<double> b(&concurrent);
+    for (int i = 0; i < 1000; i++) {
+        a.push_back(i);
+        b.push_back(-i);
+    }
+    EXPECT_EQ(a[999], 999.0);
+    EXPECT_EQ(b[999], -999.0);
+}
+
+/**
+ * @test Randomized allocate/free of mixed sizes and alignments keeps every object intact
+ */
+TEST(MemoryResourceTest, STRESS_RandomizedSizesAndAlignments) {
+    MemoryResource resource(ContainerConfig{256 * 1024, 4 * 1024 * 1024, 2, 0});
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::size_t> size_dist(0, 8192);
+
+    struct Allocation {
+        unsigned char* ptr;
+        std::size_t bytes;
+        std::size_t alignment;
+    };
+    std::vector<Allocation> live;
+    for (int round = 0; round < 20000; round++) {
+        if (live.empty() || rng() % 3 != 0) {
+            std::size_t bytes = size_dist(rng);
+            std::size_t alignment = std::size_t{1} << (rng() % 10);
+            auto* ptr = static_cast<unsigned char*>(resource.allocate(bytes, alignment));
+            ASSERT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % alignment, 0u);
+            std::memset(ptr, static_cast<int>(bytes & 0xFF), bytes);
+            live.push_back({ptr, bytes, alignment});
+        } else {
+            std::size_t index = rng() % live.size();
+            Allocation entry = live[index];
+            if (entry.bytes > 0) {
+                ASSERT_EQ(entry.ptr[0], static_cast<unsigned char>(entry.bytes & 0xFF));
+                ASSERT_EQ(entry.ptr[entry.bytes - 1],
+                          static_cast<unsigned char>(entry.bytes & 0xFF));
+            }
+            resource.deallocate(entry.ptr, entry.bytes, entry.alignment);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for (const Allocation& entry : live) {
+        resource.deallocate(entry.ptr, entry.bytes, entry.alignment);
+    }
+}
@@ -0,0 +1,159 @@
+/**
+ * @file test_halloc_PageMap.cpp
+ * @brief Unit tests for PageMap (page -> owner radix tree)
+ *
+ * Test Coverage:
+ * - Basic Functionality: Untagged pages, range tagging, page boundaries, clearing
+ * - Address Space : Far-apart ranges, ranges crossing leaf boundaries, ranges beyond
+ *                   the map refused without tagging
+ * - Containers : Owner lookup across many blocks and the mmap fallback
+ * - Multi-threading : Concurrent tagging of disjoint ranges with lock-free readers
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../halloc/includes/BlocksContainer.hpp"
+#include "../halloc/includes/PageMap.hpp"
+
+using namespace hh::halloc;
+
+class PageMapTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+
+    void TearDown() override {}
+};
+
+namespace {
+const void* address(std::uintptr_t value) {
+    return reinterpret_cast<const void*>(value);
+}
+}  // namespace
+
+// ==================== BASIC FUNCTIONALITY TESTS ====================
+
+/**
+ * @test An empty map reports every address as untagged
+ */
+TEST(PageMapTest, SMALL_Get_UntaggedIsZero) {
+    PageMap map;
+
+    int local = 0;
+    EXPECT_EQ(map.get(&local), 0u);
+    EXPECT_EQ(map.get(nullptr), 0u);
+    EXPECT_EQ(map.get(address(~std::uintptr_t{0})), 0u);
+}
+
+/**
+ * @test Tagging covers exactly the pages overlapping the range
+ */
+TEST(PageMapTest, SMALL_SetRange_CoversOverlappingPagesOnly) {
+    PageMap map;
+    const std::uintptr_t base = 0x7f0000000000;
+
+    map.set_range(address(base + 100), 3 * 4096, 7);
+
+    EXPECT_EQ(map.get(address(base - 1)), 0u);
+    EXPECT_EQ(map.get(address(base)), 7u);
+    EXPECT_EQ(map.get(address(base + 3 * 4096 + 99)), 7u);
+    EXPECT_EQ(map.get(address(base + 4 * 4096)), 0u);
+
+    map.set_range(address(base), 4 * 4096, 0);
+    EXPECT_EQ(map.get(address(base + 4096)), 0u);
+}
+
+// ==================== ADDRESS SPACE TESTS ====================
+
+/**
+ * @test Ranges in different tree branches and across leaf boundaries keep their own tags
+ */
+TEST(PageMapTest, SMALL_SetRange_FarApartAndCrossingLeaves) {
+    PageMap map;
+    const std::uintptr_t leaf_span = std::uintptr_t{4096} << PageMap::LEVEL_BITS;  // 16 MiB
+
+    map.set_range(address(0x10000), 4096, 1);
+    map.set_range(address(0x7ffff0000000), 4096, 2);
+    map.set_range(address(5 * leaf_span - 8192), 4 * 4096, 3);
+
+    EXPECT_EQ(map.get(address(0x10000)), 1u);
+    EXPECT_EQ(map.get(address(0x7ffff0000fff)), 2u);
+    EXPECT_EQ(map.get(address(5 * leaf_span - 1)), 3u);
+    EXPECT_EQ(map.get(address(5 * leaf_span + 8191)), 3u);
+    EXPECT_EQ(map.get(address(5 * leaf_span + 8192)), 0u);
+
+    EXPECT_THROW(map.set_range(address(std::uintptr_t{1} << PageMap::ADDRESS_BITS), 4096, 1),
+                 std::bad_alloc);
+    const std::size_t beyond = std::size_t{1} << PageMap::ADDRESS_BITS;
+    EXPECT_FALSE(map.try_set_range(address(0x10000), beyond, 9));
+    EXPECT_EQ(map.get(address(0x10000)), 1u);
+    EXPECT_TRUE(map.try_set_range(address(0x10000), 4096, 4));
+    EXPECT_EQ(map.get(address(0x10000)), 4u);
+}
+
+// ==================== CONTAINER TESTS ====================
+
+/**
+ * @test With many blocks, every free reaches its block and fallbacks are unmapped
+ */
+TEST(PageMapTest, SMALL_BlocksContainer_FindsOwnerAmongManyBlocks) {
+    BlocksContainer<4096, 256> container;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 256; i++) {
+        void* ptr = container.allocate(4096 - MEMORY_NODE_SIZE);
+        std::memset(ptr, i, 4096 - MEMORY_NODE_SIZE);
+        ptrs.push_back(ptr);
+    }
+    EXPECT_EQ(container.get_num_blocks(), 256u);
+
+    void* fallback = container.allocate(4096 - MEMORY_NODE_SIZE);
+    std::memset(fallback, 0xFF, 4096 - MEMORY_NODE_SIZE);
+    container.deallocate(fallback, 4096 - MEMORY_NODE_SIZE);
+
+    for (int i = 255; i >= 0; i--) {
+        container.deallocate(ptrs[i], 4096 - MEMORY_NODE_SIZE);
+    }
+
+    // Every block is whole again, so refilling them creates no fallback mappings
+    for (int i = 0; i < 256; i++) {
+        void* ptr = container.allocate(4096 - MEMORY_NODE_SIZE);
+        EXPECT_EQ(ptr, ptrs[i]);
+    }
+}
+
+// ==================== MULTI-THREADING TESTS ====================
+
+/**
+ * @test Threads tag disjoint ranges while readers look up already-tagged pages
+ */
+TEST(PageMapTest, STRESS_ConcurrentSetAndGet) {
+    PageMap map;
+    const std::uintptr_t base = 0x600000000000;
+    const int THREADS = 4;
+    const int PAGES = 20000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < PAGES; i++) {
+                std::uintptr_t page = base + (std::uintptr_t(i) * THREADS + t) * 4096;
+                map.set_range(address(page), 4096, t + 1);
+                ASSERT_EQ(map.get(address(page + 123)), std::uintptr_t(t + 1));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int i = 0; i < PAGES * THREADS; i++) {
+        std::uintptr_t page = base + std::uintptr_t(i) * 4096;
+        ASSERT_EQ(map.get(address(page)), std::uintptr_t(i % THREADS + 1));
+    }
+}
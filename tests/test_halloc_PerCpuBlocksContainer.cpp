@@ -0,0 +1,269 @@
+/**
+ * @file test_halloc_PerCpuBlocksContainer.cpp
+ * @brief Unit tests for PerCpuBlocksContainer (one arena per CPU)
+ *
+ * Test Coverage:
+ * - CPU Selection : current_cpu agrees with sched_getcpu, arena index in range
+ * - Basic Functionality: Allocation/reuse, zero bytes, mmap fallback, block growth
+ * - Multi-threading : Concurrent allocations, cross-thread frees, PerCpuHalloc
+ * - Remote Frees : RemoteFreeQueue ordering, concurrent producers with a draining consumer
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "../halloc/includes/Halloc.hpp"
+#include "../halloc/includes/PerCpuBlocksContainer.hpp"
+#include "../halloc/includes/RemoteFreeQueue.hpp"
+
+using namespace hh::halloc;
+
+class PerCpuBlocksContainerTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+
+    void TearDown() override {}
+};
+
+// ==================== CPU SELECTION TESTS ====================
+
+/**
+ * @test current_cpu reports a valid CPU and the arena index stays in range
+ */
+TEST(PerCpuBlocksContainerTest, SMALL_CurrentCpu_WithinArenaRange) {
+    PerCpuBlocksContainer<4096, 2> container;
+
+    EXPECT_GE(current_cpu(), 0);
+    EXPECT_GE(container.get_num_arenas(), 1);
+    EXPECT_LT(container.current_arena(), container.get_num_arenas());
+}
+
+/**
+ * @test A thread pinned to one CPU sees that CPU through current_cpu
+ */
+TEST(PerCpuBlocksContainerTest, SMALL_CurrentCpu_MatchesPinnedCpu) {
+    std::thread pinned([]() {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(0, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            return;  // pinning not permitted here
+        }
+        EXPECT_EQ(current_cpu(), 0);
+    });
+    pinned.join();
+}
+
+// ==================== BASIC FUNCTIONALITY TESTS ====================
+
+/**
+ * @test Memory freed on the same CPU is reused by the next allocation
+ */
+TEST(PerCpuBlocksContainerTest, SMALL_Allocate_DeallocateAndReuse) {
+    PerCpuBlocksContainer<4096, 2> container;
+
+    void* ptr = container.allocate(256);
+    EXPECT_NE(ptr, nullptr);
+    std::memset(ptr, 0xAA, 256);
+    container.deallocate(ptr, 256);
+
+    void* again = container.allocate(256);
+    EXPECT_NE(again, nullptr);
+    container.deallocate(again, 256);
+}
+
+/**
+ * @test Zero-byte allocation is rejected
+ */
+TEST(PerCpuBlocksContainerTest, SMALL_EdgeCase_AllocateZeroBytes) {
+    PerCpuBlocksContainer<4096, 2> container;
+
+    EXPECT_THROW({ container.allocate(0); }, std::invalid_argument);
+}
+
+/**
+ * @test Arenas grow new blocks, and oversized requests fall back to mmap
+ */
+TEST(PerCpuBlocksContainerTest, SMALL_MultipleBlocks_GrowAndFallBack) {
+    PerCpuBlocksContainer<1024, 3> container;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 5; i++) {
+        void* ptr = container.allocate(1024 - MEMORY_NODE_SIZE);
+        std::memset(ptr, i, 1024 - MEMORY_NODE_SIZE);
+        ptrs.push_back(ptr);
+    }
+    void* large = container.allocate(8192);
+    std::memset(large, 0xEE, 8192);
+
+    container.deallocate(large, 8192);
+    for (void* ptr : ptrs) {
+        container.deallocate(ptr, 1024 - MEMORY_NODE_SIZE);
+    }
+}
+
+// ==================== MULTI-THREADING TESTS ====================
+
+/**
+ * @test Threads allocate, verify and free concurrently without corrupting data
+ */
+TEST(PerCpuBlocksContainerTest, STRESS_ConcurrentAllocations) {
+    PerCpuBlocksContainer<1024 * 1024, 8> container;
+
+    auto worker = [&container](int id) {
+        std::vector<std::pair<unsigned char*, std::size_t>> live;
+        for (int i = 0; i < 20000; i++) {
+            std::size_t size = 16 + ((i * 31 + id * 13) % 3000);
+            auto* ptr = static_cast<unsigned char*>(container.allocate(size));
+            std::memset(ptr, id, size);
+            live.push_back({ptr, size});
+
+            if (live.size() > 128) {
+                auto [old_ptr, old_size] = live[i % live.size()];
+                for (std::size_t j = 0; j < old_size; j++) {
+                    ASSERT_EQ(old_ptr[j], (unsigned char)id);
+                }
+                container.deallocate(old_ptr, old_size);
+                live[i % live.size()] = live.back();
+                live.pop_back();
+            }
+        }
+        for (auto [ptr, size] : live) {
+            container.deallocate(ptr, size);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back(worker, t + 1);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @test Memory allocated on one thread is freed by another concurrently allocating thread
+ */
+TEST(PerCpuBlocksContainerTest, STRESS_CrossThreadDeallocation) {
+    PerCpuBlocksContainer<256 * 1024, 8> container;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 5000; i++) {
+        void* ptr = container.allocate(128);
+        std::memset(ptr, 0x3C, 128);
+        ptrs.push_back(ptr);
+    }
+
+    std::thread consumer([&]() {
+        for (void* ptr : ptrs) {
+            EXPECT_EQ(*static_cast<unsigned char*>(ptr), 0x3C);
+            container.deallocate(ptr, 128);
+        }
+    });
+    std::thread producer([&]() {
+        for (int i = 0; i < 5000; i++) {
+            void* ptr = container.allocate(64);
+            container.deallocate(ptr, 64);
+        }
+    });
+    consumer.join();
+    producer.join();
+}
+
+/**
+ * @test PerCpuHalloc works with STL containers used from several threads
+ */
+TEST(PerCpuBlocksContainerTest, STRESS_PerCpuHallocWithVectors) {
+    PerCpuHalloc<int, 1024 * 1024, 8> alloc;
+
+    auto worker = [alloc](int id) {
+        for (int round = 0; round < 50; round++) {
+            std::vector<int, PerCpuHalloc<int, 1024 * 1024, 8>> v(alloc);
+            for (int i = 0; i < 1000; i++) {
+                v.push_back(i * id);
+            }
+            for (int i = 0; i < 1000; i++) {
+                ASSERT_EQ(v[i], i * id);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back(worker, t + 1);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// ==================== REMOTE FREE QUEUE TESTS ====================
+
+/**
+ * @test take_all returns every pushed chunk (most recent first) and empties the queue
+ */
+TEST(PerCpuBlocksContainerTest, SMALL_RemoteFreeQueue_TakeAllReturnsPushedChunks) {
+    RemoteFreeQueue queue;
+    void* chunks[3][2];
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.take_all(), nullptr);
+
+    for (auto& chunk : chunks) {
+        queue.push(chunk);
+    }
+    EXPECT_FALSE(queue.empty());
+
+    void* list = queue.take_all();
+    EXPECT_EQ(list, chunks[2]);
+    EXPECT_EQ(RemoteFreeQueue::next(list), chunks[1]);
+    EXPECT_EQ(RemoteFreeQueue::next(RemoteFreeQueue::next(list)), chunks[0]);
+    EXPECT_EQ(RemoteFreeQueue::next(chunks[0]), nullptr);
+
+    EXPECT_TRUE(queue.empty());
+}
+
+/**
+ * @test Concurrent producers never lose or duplicate a chunk while a consumer drains
+ */
+TEST(PerCpuBlocksContainerTest, STRESS_RemoteFreeQueue_ConcurrentProducers) {
+    const int PRODUCERS = 4;
+    const int PER_PRODUCER = 20000;
+
+    RemoteFreeQueue queue;
+    std::vector<std::vector<void*>> storage(PRODUCERS, std::vector<void*>(PER_PRODUCER));
+    std::atomic<int> done{0};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < PER_PRODUCER; i++) {
+                queue.push(&storage[p][i]);
+            }
+            done++;
+        });
+    }
+
+    std::set<void*> seen;
+    auto drain = [&]() {
+        for (void* chunk = queue.take_all(); chunk; chunk = RemoteFreeQueue::next(chunk)) {
+            EXPECT_TRUE(seen.insert(chunk).second);
+        }
+    };
+    while (done.load() < PRODUCERS) {
+        drain();
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    drain();
+
+    EXPECT_EQ(seen.size(), (std::size_t)(PRODUCERS * PER_PRODUCER));
+}
@@ -0,0 +1,234 @@
+/**
+ * @file test_halloc_SlabContainer.cpp
+ * @brief Unit tests for SlabContainer and SlabHalloc
+ *
+ * Test Coverage:
+ * - Basic Functionality: Dense packing, bitmap reuse, every size class, large bypass
+ * - Page Management : Span release, empty page hysteresis, resizing slab objects
+ * - Integration : STL containers over SlabHalloc, randomized stress
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../halloc/includes/Halloc.hpp"
+#include "../halloc/includes/SlabContainer.hpp"
+
+using namespace hh::halloc;
+
+using SlabBlocks = SlabContainer<BlocksContainer<1024 * 1024, 4>>;
+
+class SlabContainerTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+
+    void TearDown() override {}
+};
+
+// ==================== BASIC FUNCTIONALITY TESTS ====================
+
+/**
+ * @test Consecutive small objects sit back to back with no per-object header
+ */
+TEST(SlabContainerTest, SMALL_Allocate_PacksObjectsWithoutHeaders) {
+    SlabBlocks container;
+
+    std::vector<char*> ptrs;
+    for (int i = 0; i < 32; i++) {
+        ptrs.push_back(static_cast<char*>(container.allocate(32)));
+    }
+
+    for (std::size_t i = 1; i < ptrs.size(); i++) {
+        EXPECT_EQ(ptrs[i] - ptrs[i - 1], 32);
+    }
+    for (char* ptr : ptrs) {
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % MIN_ALIGNMENT, 0u);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) / SLAB_PAGE_SIZE,
+                  reinterpret_cast<std::uintptr_t>(ptrs[0]) / SLAB_PAGE_SIZE);
+    }
+    EXPECT_EQ(container.get_num_spans(), 1u);
+
+    for (char* ptr : ptrs) {
+        container.deallocate(ptr, 32);
+    }
+}
+
+/**
+ * @test A freed object is handed back by the next allocation of its size class
+ */
+TEST(SlabContainerTest, SMALL_Allocate_ReusesFreedSlot) {
+    SlabBlocks container;
+
+    void* ptr1 = container.allocate(40);
+    void* ptr2 = container.allocate(48);
+    void* ptr3 = container.allocate(33);
+    container.deallocate(ptr2, 48);
+
+    EXPECT_EQ(container.allocate(41), ptr2);
+
+    container.deallocate(ptr1, 40);
+    container.deallocate(ptr2, 41);
+    container.deallocate(ptr3, 33);
+}
+
+/**
+ * @test Every size class up to SLAB_MAX_SIZE keeps its objects intact
+ */
+TEST(SlabContainerTest, SMALL_Allocate_AllSizeClasses) {
+    SlabBlocks container;
+
+    std::vector<std::pair<unsigned char*, std::size_t>> ptrs;
+    for (std::size_t bytes = 1; bytes <= SLAB_MAX_SIZE; bytes++) {
+        auto* ptr = static_cast<unsigned char*>(container.allocate(bytes));
+        ASSERT_NE(ptr, nullptr);
+        std::memset(ptr, static_cast<int>(bytes), bytes);
+        ptrs.emplace_back(ptr, bytes);
+    }
+
+    for (auto [ptr, bytes] : ptrs) {
+        for (std::size_t i = 0; i < bytes; i++) {
+            ASSERT_EQ(ptr[i], static_cast<unsigned char>(bytes));
+        }
+        container.deallocate(ptr, bytes);
+    }
+    EXPECT_THROW(container.allocate(0), std::invalid_argument);
+}
+
+/**
+ * @test Large and over-aligned requests bypass the slab pages
+ */
+TEST(SlabContainerTest, SMALL_Allocate_LargeAndAlignedBypassSlabs) {
+    SlabBlocks container;
+
+    void* small = container.allocate(64);
+    void* large = container.allocate(SLAB_MAX_SIZE + 1);
+    void* aligned = container.allocate_aligned(64, 256);
+
+    EXPECT_NE(reinterpret_cast<std::uintptr_t>(large) / SLAB_PAGE_SIZE,
+              reinterpret_cast<std::uintptr_t>(small) / SLAB_PAGE_SIZE);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 256, 0u);
+    EXPECT_EQ(container.get_num_spans(), 1u);
+
+    container.deallocate(aligned, 64);
+    container.deallocate(large, SLAB_MAX_SIZE + 1);
+    container.deallocate(small, 64);
+}
+
+// ==================== PAGE MANAGEMENT TESTS ====================
+
+/**
+ * @test The last page of a size class is kept when it empties
+ */
+TEST(SlabContainerTest, SMALL_Pages_KeepLastPageOfClass) {
+    SlabBlocks container;
+
+    void* ptr1 = container.allocate(16);
+    container.deallocate(ptr1, 16);
+    EXPECT_EQ(container.get_num_spans(), 1u);
+
+    void* ptr2 = container.allocate(16);
+    EXPECT_EQ(ptr2, ptr1);
+    container.deallocate(ptr2, 16);
+}
+
+/**
+ * @test Filling more than one span allocates another, and an emptied span is released
+ */
+TEST(SlabContainerTest, SMALL_Pages_GrowAndShrinkSpans) {
+    SlabBlocks container;
+
+    std::vector<void*> ptrs;
+    for (std::size_t i = 0; i < SLAB_SPAN_PAGES * SLAB_PAGE_SIZE / 128 + 64; i++) {
+        ptrs.push_back(container.allocate(128));
+    }
+    EXPECT_EQ(container.get_num_spans(), 2u);
+
+    for (void* ptr : ptrs) {
+        container.deallocate(ptr, 128);
+    }
+    EXPECT_EQ(container.get_num_spans(), 1u);
+}
+
+/**
+ * @test Slab objects resize in place within their class and move beyond it
+ */
+TEST(SlabContainerTest, SMALL_Pages_ResizeSlabObject) {
+    SlabBlocks container;
+
+    auto* ptr = static_cast<char*>(container.allocate(20));
+    std::memset(ptr, 'x', 20);
+
+    EXPECT_TRUE(container.try_expand(ptr, 20, 32));
+    EXPECT_FALSE(container.try_expand(ptr, 32, 33));
+    EXPECT_EQ(container.reallocate(ptr, 32, 30), ptr);
+
+    auto* moved = static_cast<char*>(container.reallocate(ptr, 30, 1000));
+    EXPECT_NE(moved, ptr);
+    for (int i = 0; i < 20; i++) {
+        EXPECT_EQ(moved[i], 'x');
+    }
+    container.deallocate(moved, 1000);
+}
+
+// ==================== INTEGRATION TESTS ====================
+
+/**
+ * @test Node-based STL containers run over SlabHalloc
+ */
+TEST(SlabContainerTest, SMALL_Halloc_STLContainers) {
+    std::map<int, int, std::less<int>, SlabHalloc<std::pair<const int, int>>> map;
+    std::list<long, SlabHalloc<long>> list;
+
+    for (int i = 0; i < 10000; i++) {
+        map[i] = 2 * i;
+        list.push_back(i);
+    }
+    for (int i = 0; i < 10000; i += 2) {
+        map.erase(i);
+        list.pop_front();
+    }
+
+    EXPECT_EQ(map.size(), 5000u);
+    EXPECT_EQ(list.size(), 5000u);
+    EXPECT_EQ(map[9999], 19998);
+    EXPECT_EQ(list.front(), 5000);
+}
+
+/**
+ * @test Randomized allocate/free of mixed sizes keeps every object intact
+ */
+TEST(SlabContainerTest, STRESS_RandomizedMixedSizes) {
+    SlabBlocks container;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<std::size_t> size_dist(1, 2 * SLAB_MAX_SIZE);
+
+    std::vector<std::pair<unsigned char*, std::size_t>> live;
+    for (int round = 0; round < 20000; round++) {
+        if (live.empty() || rng() % 3 != 0) {
+            std::size_t bytes = size_dist(rng);
+            auto* ptr = static_cast<unsigned char*>(container.allocate(bytes));
+            std::memset(ptr, static_cast<int>(bytes & 0xFF), bytes);
+            live.emplace_back(ptr, bytes);
+        } else {
+            std::size_t index = rng() % live.size();
+            auto [ptr, bytes] = live[index];
+            ASSERT_EQ(ptr[0], static_cast<unsigned char>(bytes & 0xFF));
+            ASSERT_EQ(ptr[bytes - 1], static_cast<unsigned char>(bytes & 0xFF));
+            container.deallocate(ptr, bytes);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for (auto [ptr, bytes] : live) {
+        container.deallocate(ptr, bytes);
+    }
+}
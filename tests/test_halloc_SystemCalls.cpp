@@ -0,0 +1,208 @@
+/**
+ * @file test_halloc_SystemCalls.cpp
+ * @brief Tests that observe or fail the allocator's mmap and madvise calls
+ *
+ * These tests build into their own executable, system_call_tests, which links with
+ * --wrap=mmap and --wrap=madvise so the wrappers below stand in for the system
+ * calls made by the allocator. No other test binary is affected.
+ *
+ * Test Coverage:
+ * - Purging : No madvise calls in tight alloc/free loops within the purge decay,
+ *             purging after the decay or at once with a decay of 0
+ * - Out of Memory : nullptr without an exception when no memory can be mapped,
+ *                   normal growth once mmap succeeds again, no leaked block when
+ *                   its page map nodes cannot be mapped
+ *
+ */
+
+#include <errno.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "../halloc/includes/BlocksContainer.hpp"
+#include "../halloc/includes/ConcurrentBlocksContainer.hpp"
+#include "../halloc/includes/LargeMappingCache.hpp"
+
+using namespace hh::halloc;
+
+namespace {
+/// madvise calls made by the allocator; tests compare before/after values
+std::atomic<std::size_t> madvise_calls{0};
+/// Makes every mmap call fail while set
+std::atomic<bool> fail_mmap{false};
+/// When non-negative, the number of mmap calls that succeed before the rest fail
+std::atomic<int> mmap_calls_allowed{-1};
+/// Address returned by the last successful mmap call
+std::atomic<void*> last_mmap{nullptr};
+}  // namespace
+
+extern "C" int __real_madvise(void* addr, std::size_t length, int advice);
+
+extern "C" int __wrap_madvise(void* addr, std::size_t length, int advice) {
+    madvise_calls++;
+    return __real_madvise(addr, length, advice);
+}
+
+extern "C" void* __real_mmap(void* addr, std::size_t length, int prot, int flags, int fd,
+                             off_t offset);
+
+extern "C" void* __wrap_mmap(void* addr, std::size_t length, int prot, int flags, int fd,
+                             off_t offset) {
+    if (fail_mmap.load() || mmap_calls_allowed.load() == 0) {
+        errno = ENOMEM;
+        return MAP_FAILED;
+    }
+    if (mmap_calls_allowed.load() > 0) {
+        mmap_calls_allowed--;
+    }
+    void* memory = __real_mmap(addr, length, prot, flags, fd, offset);
+    last_mmap = memory;
+    return memory;
+}
+
+/**
+ * Resets the injected state around every test: mmap succeeds again and the shared
+ * LargeMappingCache holds no mappings left over from an earlier test, so a test
+ * that fails mmap sees only its own allocations
+ */
+class SystemCallTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fail_mmap = false;
+        mmap_calls_allowed = -1;
+        LargeMappingCache::instance().purge();
+    }
+
+    void TearDown() override {
+        fail_mmap = false;
+        mmap_calls_allowed = -1;
+    }
+};
+
+// ==================== PURGING TESTS ====================
+
+/**
+ * @test A tight alloc/free loop next to the free tail of a block makes no madvise
+ * calls within the purge decay; the first free after the decay purges, and a decay
+ * of 0 purges at once
+ */
+TEST_F(SystemCallTest, SMALL_BlocksContainer_TightLoopDefersPurge) {
+    BlocksContainer<1024 * 1024, 1> container;
+    DynamicBlocksContainer dynamic(ContainerConfig{1024 * 1024, 1024 * 1024, 2, 0});
+    void* guard = container.allocate(64);
+    void* dynamic_guard = dynamic.allocate(64);
+
+    std::size_t before = madvise_calls.load();
+    for (int i = 0; i < 10000; i++) {
+        void* ptr = container.allocate(8192);
+        std::memset(ptr, i & 0xFF, 8192);
+        container.deallocate(ptr, 8192);
+
+        void* other = dynamic.allocate(8192);
+        std::memset(other, i & 0xFF, 8192);
+        dynamic.deallocate(other, 8192);
+    }
+    EXPECT_EQ(madvise_calls.load(), before);
+
+    // Once the decay has passed, the next free purges the dirty tail
+    ContainerConfig short_decay{1024 * 1024, 1024 * 1024, 2, 0};
+    short_decay.purge_decay = std::chrono::milliseconds(20);
+    DynamicBlocksContainer decaying(short_decay);
+    void* decaying_guard = decaying.allocate(64);
+    before = madvise_calls.load();
+    for (int i = 0; i < 1000; i++) {
+        void* ptr = decaying.allocate(8192);
+        std::memset(ptr, i & 0xFF, 8192);
+        decaying.deallocate(ptr, 8192);
+    }
+    EXPECT_EQ(madvise_calls.load(), before);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    void* ptr = decaying.allocate(8192);
+    decaying.deallocate(ptr, 8192);
+    EXPECT_GT(madvise_calls.load(), before);
+
+    ContainerConfig immediate{1024 * 1024, 1024 * 1024, 2, 0};
+    immediate.purge_decay = std::chrono::milliseconds(0);
+    DynamicBlocksContainer synchronous(immediate);
+    void* large = synchronous.allocate(512 * 1024);
+    void* synchronous_guard = synchronous.allocate(64);
+    std::memset(large, 0x22, 512 * 1024);
+    before = madvise_calls.load();
+    synchronous.deallocate(large, 512 * 1024);
+    EXPECT_GT(madvise_calls.load(), before);
+
+    synchronous.deallocate(synchronous_guard, 64);
+    decaying.deallocate(decaying_guard, 64);
+    dynamic.deallocate(dynamic_guard, 64);
+    container.deallocate(guard, 64);
+}
+
+// ==================== OUT OF MEMORY TESTS ====================
+
+/**
+ * @test When neither a new block nor a large mapping can be mapped, allocation
+ * returns nullptr without throwing (nothing is thrown under the growth lock), and
+ * the container grows normally once memory is available again
+ */
+TEST_F(SystemCallTest, SMALL_ConcurrentBlocksContainer_OutOfMemoryReturnsNull) {
+    constexpr std::size_t BLOCK = 64 * 1024;
+    ConcurrentBlocksContainer<BLOCK, 4> container;
+    void* full = container.allocate(BLOCK - MEMORY_NODE_SIZE);
+    ASSERT_NE(full, nullptr);
+    ASSERT_EQ(LargeMappingCache::instance().get_cached_bytes(), 0u);
+
+    fail_mmap = true;
+    void* small = nullptr;
+    void* large = nullptr;
+    void* moved = full;
+    EXPECT_NO_THROW(small = container.allocate(1024));
+    EXPECT_NO_THROW(large = container.allocate_aligned(4 * BLOCK, 4096));
+    EXPECT_NO_THROW(moved = container.reallocate(full, BLOCK - MEMORY_NODE_SIZE, 2 * BLOCK));
+    // A second failure would hang if the first had left the growth lock held
+    EXPECT_NO_THROW(small = container.allocate(2048));
+    fail_mmap = false;
+
+    EXPECT_EQ(small, nullptr);
+    EXPECT_EQ(large, nullptr);
+    EXPECT_EQ(moved, nullptr);
+
+    small = container.allocate(1024);
+    ASSERT_NE(small, nullptr);
+    std::memset(small, 0x3C, 1024);
+    container.deallocate(small, 1024);
+    container.deallocate(full, BLOCK - MEMORY_NODE_SIZE);
+}
+
+/**
+ * @test When a new block is mapped but its page map leaf cannot be, allocation
+ * throws std::bad_alloc and the block is unmapped rather than leaked; the container
+ * creates the block normally once mmap succeeds again
+ */
+TEST_F(SystemCallTest, SMALL_DynamicBlocksContainer_UntaggedBlockIsReleased) {
+    constexpr std::size_t MiB = 1024 * 1024;
+    DynamicBlocksContainer container(ContainerConfig{MiB, 64 * MiB, 2, 0});
+
+    // A 40 MiB block spans more 16 MiB leaves than the first block can share
+    mmap_calls_allowed = 1;
+    EXPECT_THROW(container.allocate(40 * MiB), std::bad_alloc);
+    mmap_calls_allowed = -1;
+
+    // mincore fails with ENOMEM on unmapped memory
+    unsigned char resident = 0;
+    void* block = last_mmap.load();
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(mincore(block, 4096, &resident), -1);
+    EXPECT_EQ(errno, ENOMEM);
+
+    void* ptr = container.allocate(40 * MiB);
+    ASSERT_NE(ptr, nullptr);
+    std::memset(ptr, 0x5A, 4096);
+    EXPECT_EQ(container.get_num_blocks(), 2u);
+    container.deallocate(ptr, 40 * MiB);
+}
@@ -0,0 +1,214 @@
+/**
+ * @file test_halloc_ThreadCache.cpp
+ * @brief Unit tests for ThreadCachedContainer and CachedHalloc
+ *
+ * Test Coverage:
+ * - Basic Functionality: Cached reuse, size-class sharing, large bypass, zero bytes
+ * - Cache Management : Explicit flush, bounded cache growth
+ * - Multi-threading : Concurrent allocations, cross-thread frees, STL containers
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../halloc/includes/Halloc.hpp"
+#include "../halloc/includes/ThreadCache.hpp"
+
+using namespace hh::halloc;
+
+using CachedContainer = ThreadCachedContainer<BlocksContainer<64 * 1024, 4>>;
+
+class ThreadCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+
+    void TearDown() override {}
+};
+
+// ==================== BASIC FUNCTIONALITY TESTS ====================
+
+/**
+ * @test A freed chunk is handed back by the next allocation of the same size
+ */
+TEST(ThreadCacheTest, SMALL_Allocate_ReusesCachedChunk) {
+    CachedContainer container;
+
+    void* ptr1 = container.allocate(64);
+    EXPECT_NE(ptr1, nullptr);
+    container.deallocate(ptr1, 64);
+
+    void* ptr2 = container.allocate(64);
+    EXPECT_EQ(ptr2, ptr1);
+
+    container.deallocate(ptr2, 64);
+}
+
+/**
+ * @test Requests rounding to the same size class share cached chunks
+ */
+TEST(ThreadCacheTest, SMALL_Allocate_SameSizeClassSharesChunks) {
+    CachedContainer container;
+
+    void* ptr1 = container.allocate(50);
+    std::memset(ptr1, 0xAA, 50);
+    container.deallocate(ptr1, 50);
+
+    void* ptr2 = container.allocate(64);
+    EXPECT_EQ(ptr2, ptr1);
+    std::memset(ptr2, 0xBB, 64);
+
+    container.deallocate(ptr2, 64);
+}
+
+/**
+ * @test Requests above the cache limit bypass the cache
+ */
+TEST(ThreadCacheTest, SMALL_Allocate_LargeRequestsBypassCache) {
+    CachedContainer container;
+
+    void* ptr = container.allocate(THREAD_CACHE_MAX_SIZE * 4);
+    EXPECT_NE(ptr, nullptr);
+    std::memset(ptr, 0xCC, THREAD_CACHE_MAX_SIZE * 4);
+
+    EXPECT_EQ(container.thread_cached_count(), 0);
+    container.deallocate(ptr, THREAD_CACHE_MAX_SIZE * 4);
+    EXPECT_EQ(container.thread_cached_count(), 0);
+}
+
+/**
+ * @test Zero-byte allocation is rejected like BlocksContainer does
+ */
+TEST(ThreadCacheTest, SMALL_EdgeCase_AllocateZeroBytes) {
+    CachedContainer container;
+
+    EXPECT_THROW({ container.allocate(0); }, std::invalid_argument);
+}
+
+// ==================== CACHE MANAGEMENT TESTS ====================
+
+/**
+ * @test flush_thread_cache returns every cached chunk to the container
+ */
+TEST(ThreadCacheTest, SMALL_Flush_EmptiesThreadCache) {
+    CachedContainer container;
+
+    void* ptr = container.allocate(128);
+    container.deallocate(ptr, 128);
+    EXPECT_GT(container.thread_cached_count(), 0);
+
+    container.flush_thread_cache();
+    EXPECT_EQ(container.thread_cached_count(), 0);
+}
+
+/**
+ * @test Freeing many chunks keeps the cache bounded (overflow is flushed in batches)
+ */
+TEST(ThreadCacheTest, SMALL_Deallocate_CacheStaysBounded) {
+    CachedContainer container;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 200; i++) {
+        ptrs.push_back(container.allocate(32));
+    }
+    for (void* ptr : ptrs) {
+        container.deallocate(ptr, 32);
+    }
+
+    EXPECT_LE(container.thread_cached_count(), 2 * 32);
+}
+
+// ==================== MULTI-THREADING TESTS ====================
+
+/**
+ * @test Several threads allocate, write and free concurrently without corrupting data
+ */
+TEST(ThreadCacheTest, STRESS_ConcurrentAllocations) {
+    CachedContainer container;
+
+    auto worker = [&container](int id) {
+        std::vector<std::pair<unsigned char*, std::size_t>> live;
+        for (int i = 0; i < 20000; i++) {
+            std::size_t size = 16 + ((i * 37 + id * 11) % 1500);
+            auto* ptr = static_cast<unsigned char*>(container.allocate(size));
+            std::memset(ptr, id, size);
+            live.push_back({ptr, size});
+
+            if (live.size() > 64) {
+                auto [old_ptr, old_size] = live[i % live.size()];
+                for (std::size_t j = 0; j < old_size; j++) {
+                    ASSERT_EQ(old_ptr[j], (unsigned char)id);
+                }
+                container.deallocate(old_ptr, old_size);
+                live[i % live.size()] = live.back();
+                live.pop_back();
+            }
+        }
+        for (auto [ptr, size] : live) {
+            container.deallocate(ptr, size);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back(worker, t + 1);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @test Chunks allocated by one thread can be freed by another
+ */
+TEST(ThreadCacheTest, STRESS_CrossThreadDeallocation) {
+    CachedContainer container;
+
+    std::vector<void*> ptrs;
+    std::thread producer([&]() {
+        for (int i = 0; i < 10000; i++) {
+            void* ptr = container.allocate(96);
+            std::memset(ptr, 0x5A, 96);
+            ptrs.push_back(ptr);
+        }
+    });
+    producer.join();
+
+    std::thread consumer([&]() {
+        for (void* ptr : ptrs) {
+            EXPECT_EQ(*static_cast<unsigned char*>(ptr), 0x5A);
+            container.deallocate(ptr, 96);
+        }
+    });
+    consumer.join();
+}
+
+/**
+ * @test CachedHalloc works with STL containers used from several threads
+ */
+TEST(ThreadCacheTest, STRESS_CachedHallocWithVectors) {
+    CachedHalloc<int, 1024 * 1024, 8> alloc;
+
+    auto worker = [alloc](int id) {
+        for (int round = 0; round < 50; round++) {
+            std::vector<int, CachedHalloc<int, 1024 * 1024, 8>> v(alloc);
+            for (int i = 0; i < 1000; i++) {
+                v.push_back(i * id);
+            }
+            for (int i = 0; i < 1000; i++) {
+                ASSERT_EQ(v[i], i * id);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back(worker, t + 1);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
@@ -6,6 +6,10 @@
  * - Insertion Tests: Single node, ascending, rotations, random order, large scale (10K nodes)
  * - Removal Tests : Leaf, one child, two children, root, cycles, sequential removal
  * - Lower Bound Tests: Empty tree, exact match, no match, boundary cases, with duplicates
+ * - Maximum Tests: Empty tree, largest value after removal, predecessor walk
+ * - Functor Tests: Custom node ordering for insert, lambda predicate for lower_bound
+ * - Replace Tests: Equal-valued node takes another's place, colors kept; update_key
+ *                  in place or by re-insertion
  * - Stress Tests: 5K cycles, duplicates handling, 100K random insert/remove/search
  *
  * Verifies RB-Tree Properties:
@@ -581,6 +585,155 @@ TEST(RBTreeTest, SMALL_LowerBoundLargerThanAll) {
     cleanup_tree(root);
 }
 
+/**
+ * @test Maximum returns the largest value, and nullptr on an empty tree
+ */
+TEST(RBTreeTest, SMALL_MaximumTracksLargestValue) {
+    TestNode* root = nullptr;
+    EXPECT_EQ(hh::rb_tree::maximum(root), nullptr);
+
+    std::vector<int> values = {30, 10, 50, 20, 40};
+    for (int val : values) {
+        TestNode* node = new TestNode(val);
+        hh::rb_tree::insert(root, node);
+    }
+
+    TestNode* result = hh::rb_tree::maximum(root);
+    EXPECT_NE(result, nullptr);
+    EXPECT_EQ(get_actual_value(result), 50);
+
+    hh::rb_tree::remove(root, result);
+    delete result;
+    EXPECT_EQ(get_actual_value(hh::rb_tree::maximum(root)), 40);
+
+    cleanup_tree(root);
+}
+
+/**
+ * @test predecessor walks the tree from the maximum down to the minimum
+ */
+TEST(RBTreeTest, SMALL_PredecessorWalksTreeOrder) {
+    TestNode* root = nullptr;
+    std::vector<std::size_t> values;
+    std::mt19937 rng(11);
+    for (int i = 0; i < 200; i++) {
+        values.push_back(rng() % 1000);
+        hh::rb_tree::insert(root, new TestNode(values.back()));
+    }
+    std::sort(values.rbegin(), values.rend());
+
+    std::vector<std::size_t> walked;
+    for (TestNode* node = hh::rb_tree::maximum(root); node;
+         node = hh::rb_tree::predecessor(node)) {
+        walked.push_back(get_actual_value(node));
+    }
+    EXPECT_EQ(walked, values);
+
+    cleanup_tree(root);
+}
+
+/**
+ * @test update_key keeps a node in place while its order holds and moves it otherwise
+ */
+TEST(RBTreeTest, SMALL_UpdateKeyMovesOnlyWhenOrderChanges) {
+    TestNode* root = nullptr;
+    std::vector<TestNode*> nodes;
+    for (std::size_t i = 1; i <= 100; i++) {
+        nodes.push_back(new TestNode(10 * i));
+        hh::rb_tree::insert(root, nodes.back());
+    }
+
+    // 500 -> 505 stays between 490 and 510
+    TestNode* node = nodes[49];
+    TestNode* parent = node->parent;
+    TestNode* left = node->left;
+    EXPECT_TRUE(hh::rb_tree::update_key(root, node, 505));
+    EXPECT_EQ(node->parent, parent);
+    EXPECT_EQ(node->left, left);
+    EXPECT_EQ(get_actual_value(node), 505u);
+    EXPECT_TRUE(verify_rb_tree_properties(root));
+
+    // 505 -> 5 crosses every smaller value
+    EXPECT_FALSE(hh::rb_tree::update_key(root, node, 5));
+    EXPECT_EQ(get_actual_value(node), 5u);
+    EXPECT_TRUE(verify_rb_tree_properties(root));
+    EXPECT_EQ(hh::rb_tree::lower_bound(root, 1), node);
+    EXPECT_EQ(hh::rb_tree::successor(node), nodes[0]);
+    EXPECT_EQ(count_nodes(root), 100);
+
+    cleanup_tree(root);
+}
+
+/**
+ * @test insert and lower_bound take functors: ties ordered by address, default key search
+ */
+TEST(RBTreeTest, SMALL_FunctorOrderingAndSearch) {
+    struct ValueThenAddress {
+        bool operator()(const TestNode* a, const TestNode* b) const {
+            std::size_t va = a->value & ~(1ull << 63);
+            std::size_t vb = b->value & ~(1ull << 63);
+            return va != vb ? va < vb : a < b;
+        }
+    };
+
+    std::vector<TestNode> nodes;
+    for (std::size_t i = 0; i < 64; i++) {
+        nodes.emplace_back(10 * (i % 8));
+    }
+    std::vector<TestNode*> order;
+    for (TestNode& node : nodes) {
+        order.push_back(&node);
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(3));
+
+    TestNode* root = nullptr;
+    for (TestNode* node : order) {
+        hh::rb_tree::insert(root, node, ValueThenAddress{});
+    }
+    EXPECT_TRUE(verify_rb_tree_properties(root));
+
+    // The leftmost node of each value is the one with the lowest address
+    for (std::size_t value = 0; value < 80; value += 10) {
+        TestNode* result = hh::rb_tree::lower_bound(root, value);
+        ASSERT_NE(result, nullptr);
+        EXPECT_EQ(result, &nodes[value / 10]);
+    }
+    EXPECT_EQ(hh::rb_tree::lower_bound(root, std::size_t{71}), nullptr);
+    EXPECT_EQ(hh::rb_tree::lower_bound(root, std::size_t{71},
+                                       [](std::size_t key, std::size_t value) {
+                                           return key <= value + 1;
+                                       }),
+              &nodes[7]);
+}
+
+/**
+ * @test replace puts an equal-valued node in another's place without breaking the tree
+ */
+TEST(RBTreeTest, SMALL_ReplaceKeepsShapeAndColors) {
+    TestNode* root = nullptr;
+    std::vector<TestNode*> nodes;
+    for (int val : {50, 30, 70, 20, 40, 60, 80}) {
+        nodes.push_back(new TestNode(val));
+        hh::rb_tree::insert(root, nodes.back());
+    }
+
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        TestNode* twin = new TestNode(get_actual_value(nodes[i]));
+        bool was_red = is_node_red(nodes[i]);
+        hh::rb_tree::replace(root, nodes[i], twin);
+        delete nodes[i];
+        nodes[i] = twin;
+
+        EXPECT_EQ(is_node_red(twin), was_red);
+        EXPECT_TRUE(verify_rb_tree_properties(root));
+        EXPECT_TRUE(verify_parent_pointers(root, nullptr));
+        EXPECT_EQ(find_node(root, get_actual_value(twin)), twin);
+    }
+    EXPECT_EQ(count_nodes(root), 7);
+
+    cleanup_tree(root);
+}
+
 /**
  * @test Duplicate value insertions are handled correctly with proper tree properties
  */